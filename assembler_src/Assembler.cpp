@@ -0,0 +1,103 @@
+
+#include <bitset>
+#include <iostream>
+#include <string>
+#include <variant>
+#include <vector>
+
+#include "Assembler.hpp"
+
+#include "DirectiveAssembler.hpp"
+#include "DirectiveResolver.hpp"
+#include "InstructionAssembler.hpp"
+#include "LabelResolver.hpp"
+#include "LineParser.hpp"
+#include "TapeWriter.hpp"
+
+std::vector<std::string> readSource(std::istream &is) {
+    std::vector<std::string> lines;
+    std::string line;
+    while (getline(is, line)) {
+#ifdef DEBUG
+        std::cout << "Read line: " << line << std::endl;
+#endif
+        if (line == "") break;
+        lines.emplace_back(line);
+    }
+    return lines;
+}
+
+AssembledProgram assembleSource(const std::vector<std::string> &source, bool relocatable) {
+    AssembledProgram program;
+
+    // 1st pass: note down macros
+
+    auto macros = searchMacros(source);
+
+    // 2nd pass: resolve macros
+
+    program.lines = resolveDirectives(source, macros);
+
+#ifdef DEBUG
+    for (auto prep : program.lines) {
+        std::cout << "Preprocessed line: " << prep << std::endl;
+    }
+#endif
+
+    // 3rd pass: note down labels and addresses
+
+    std::vector<LineType> parsedLines;
+    parsedLines.reserve(size(program.lines));
+
+    program.lengths.reserve(size(program.lines));
+    unsigned int address = 0;
+
+    for (const std::string &line : program.lines) {
+        const LineType &parsed = parsedLines.emplace_back(parseLine(line, address));
+        unsigned int length = 1;
+
+        if (std::holds_alternative<InstructionLine>(parsed)) {
+            const InstructionLine &il = std::get<InstructionLine>(parsed);
+
+            if (il.label) {
+                program.labels.addLabel({il.label.value(), address});
+            }
+        } else if (std::holds_alternative<DirectiveLine>(parsed)) {
+            const DirectiveLine &dl = std::get<DirectiveLine>(parsed);
+            if (dl.label) {
+                program.labels.addLabel({dl.label.value(), address});
+            }
+            length = directiveLength(dl);
+        } else {
+            std::cerr << "Something went wrong :(" << std::endl;
+        }
+
+        // there should be no macro invocations at this stage
+
+        program.lengths.push_back(length);
+        address += length;
+    }
+    program.words = address;
+
+    // 4th pass: resolve hanging labels and assemble to MC
+
+    program.machineCode.reserve(size(parsedLines));
+    std::vector<Relocation> *relocations = relocatable ? &program.relocations : nullptr;
+
+    for (const LineType &parsed : parsedLines) {
+        if (std::holds_alternative<InstructionLine>(parsed)) {
+            program.machineCode.emplace_back(assembleInstruction(std::get<InstructionLine>(parsed), program.labels, relocations));
+        } else {
+            program.machineCode.emplace_back(assembleDirective(std::get<DirectiveLine>(parsed), program.labels, relocations));
+        }
+    }
+
+    return program;
+}
+
+void writeProgram(const AssembledProgram &program, TapeWriter &writer) {
+    for (unsigned int i = 0; i < size(program.machineCode); ++i) {
+        if (program.lengths[i] == 1) writer.writeWord(program.machineCode[i], program.lines[i]);
+        else writer.writeZeros(program.lengths[i], program.lines[i]);
+    }
+}
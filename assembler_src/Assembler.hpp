@@ -0,0 +1,50 @@
+//
+// PDP-1 Assembler
+// Assembly passes
+//
+
+#pragma once
+
+#include <bitset>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "LabelResolver.hpp"
+#include "TapeWriter.hpp"
+
+struct AssembledProgram {
+    std::vector<std::string>     lines;         // the source after macro expansion, one per word or .space block
+    std::vector<std::bitset<18>> machineCode;   // each line's word (0 for a .space block)
+    std::vector<unsigned int>    lengths;       // how many words each line takes: 1, or N for .space N
+    size_t                       words = 0;     // the program's length in words
+    LabelResolver                labels;
+    std::vector<Relocation>      relocations;   // label references left for the linker, by address
+};
+
+/**
+ * Reads assembly source, which ends at the first empty line (or the end of the stream).
+ * @param is: the stream to read
+ * @return the source lines
+ */
+std::vector<std::string> readSource(std::istream &is);
+
+/**
+ * Assembles the provided source: notes down macros and expands them, notes down labels and
+ * addresses, then assembles every line into a word (or, for .space, a block of zero words).
+ * A relocatable program is one file of a larger one, to be placed by the linker: its label
+ * references go to relocations rather than into its words, and it may refer to symbolic labels
+ * that another file defines.
+ * @param source: the source lines
+ * @param relocatable: whether to assemble a relocatable program
+ * @return the expanded lines, their machine code and the labels
+ * @throws any of the assembler's errors (LineParseError, UndefinedMacro, LabelResolver's, ...)
+ */
+AssembledProgram assembleSource(const std::vector<std::string> &source, bool relocatable = false);
+
+/**
+ * Punches an assembled program's words and .space blocks, in order.
+ * @param program: the program, with every label reference resolved
+ * @param writer: the tape to punch
+ */
+void writeProgram(const AssembledProgram &program, TapeWriter &writer);
@@ -1,7 +1,7 @@
 
 #include <optional>
-#include <regex>
 #include <string>
+#include <string_view>
 
 #include "AssemblerCommon.hpp"
 
@@ -15,10 +15,19 @@ unsigned int onesComplement(int num, unsigned int bits) {
 }
 
 std::optional<int> parseImmediate(const std::optional<std::string>& ivalue, bool requiresPrefix) {
-    std::regex ivalueRegex(requiresPrefix ? "#(\\-?[0-9]+)" : "(\\-?[0-9]+)");
-    std::smatch ivalueMatch;
     if (!ivalue) return {};
-    if (!std::regex_match(ivalue.value(), ivalueMatch, ivalueRegex)) return {};
-    return stoi(ivalueMatch[1].str());
+
+    // ('#' if required) an optional '-', then digits
+    std::string_view number = ivalue.value();
+    if (requiresPrefix) {
+        if (number.empty() || number[0] != '#') return {};
+        number.remove_prefix(1);
+    }
+    size_t digits = !number.empty() && number[0] == '-' ? 1 : 0;
+    if (digits == number.size()) return {};
+    for (; digits < number.size(); ++digits) {
+        if (!isDigit(number[digits])) return {};
+    }
+    return stoi(std::string(number));
 }
 
@@ -7,9 +7,15 @@
 #pragma once
 
 #include <optional>
-#include <regex>
 #include <string>
 
+// character classes of the assembly syntax, ASCII whatever the locale
+inline bool isBlank(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+inline bool isDigit(char c) { return c >= '0' && c <= '9'; }
+inline bool isLower(char c) { return c >= 'a' && c <= 'z'; }
+inline bool isLetter(char c) { return isLower(c) || (c >= 'A' && c <= 'Z'); }
+inline bool isAlnum(char c) { return isLetter(c) || isDigit(c); }
+
 unsigned int onesComplement(int num, unsigned int bits);
 
 std::optional<int> parseImmediate(const std::optional<std::string>& ivalue, bool requiresPrefix = true);
@@ -3,6 +3,7 @@
 #include <iostream>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "DirectiveAssembler.hpp"
 
@@ -10,9 +11,10 @@
 #include "LabelResolver.hpp"
 #include "AssemblerCommon.hpp"
 
-// DirectiveResolver takes care of everything but .fill
+// DirectiveResolver takes care of everything but .fill and .space
 
-std::bitset<18> assembleDirective(const DirectiveLine& dl, const LabelResolver& lr) {
+std::bitset<18> assembleDirective(const DirectiveLine& dl, const LabelResolver& lr,
+                                  std::vector<Relocation>* relocations) {
     unsigned int mc = 0;
     if (dl.directive == ".fill") {
         if (size(dl.operands) != 1) throw InvalidDirectiveOperands{dl.directive, dl.operands};
@@ -21,11 +23,20 @@ std::bitset<18> assembleDirective(const DirectiveLine& dl, const LabelResolver&
         if ((imm = parseImmediate(dl.operands[0], false))) {
             mc = onesComplement(imm.value(), 18);
         } else {
-            mc = onesComplement(lr.resolveLabel(dl.operands[0], dl.line), 18);
+            mc = lr.resolveOperand(dl.operands[0], dl.line, RelocationField::WORD, relocations);
         }
-    } else {
+    } else if (dl.directive != ".space") {
         throw InvalidDirective{dl.directive};
     }
     return {mc};
 }
 
+unsigned int directiveLength(const DirectiveLine& dl) {
+    if (dl.directive != ".space") return 1;
+
+    if (size(dl.operands) == 0) throw InvalidDirective{"Operand is required for .space"};
+    int numZeroes = stoi(dl.operands[0]);
+    if (numZeroes < 0) throw InvalidDirective{".space cannot take negative values"};
+    return numZeroes;
+}
+
@@ -9,6 +9,7 @@
 #include <bitset>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "LineParser.hpp"
 #include "LabelResolver.hpp"
@@ -17,9 +18,19 @@
  * Assembles the given directive into machine code
  * @param dl: the directive to assemble
  * @param lr: a LabelResolver used to resolve any labels
+ * @param relocations: if given, a label operand is left for the linker and noted here instead
  * @return a std::bitset<18> containing the machine code for the provided instruction
  */
-std::bitset<18> assembleDirective(const DirectiveLine& dl, const LabelResolver& lr);
+std::bitset<18> assembleDirective(const DirectiveLine& dl, const LabelResolver& lr,
+                                  std::vector<Relocation>* relocations = nullptr);
+
+/**
+ * The number of words the given directive takes up: N for .space N (a block of zeros), 1 otherwise.
+ * @param dl: the directive
+ * @return the directive's length in words
+ * @throws InvalidDirective if .space's operand is missing or negative
+ */
+unsigned int directiveLength(const DirectiveLine& dl);
 
 struct InvalidDirectiveOperands {
     std::string directive;
@@ -1,134 +1,190 @@
 
 #include <iostream>
 #include <optional>
-#include <regex>
-#include <sstream>
 #include <string>
+#include <string_view>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "DirectiveResolver.hpp"
 #include "LineParser.hpp"
 
-std::unordered_map<std::string, PDPMacro> searchMacros(const std::vector<std::string> &lines) {
-    std::regex beginMacroRegex("(([A-Za-z0-9]+): )?[ \t\r]*\\.macro[ \t\r]+([A-Za-z0-9]+)(([ \t\r]+[A-Za-z0-9]+)*)");
-    std::smatch beginMacroMatch;
-    std::regex endMacroRegex("[ \t\r]*\\.endmacro");
+#include "AssemblerCommon.hpp"
+
+/**
+ * Recognizes "(<label>: ) .macro <name> <parameter>...", with alphanumeric name and parameters.
+ * @param tokens: filled in with the line's fields, the operands being the name then the parameters
+ */
+static bool isMacroBegin(std::string_view line, LineTokens &tokens) {
+    if (!lexLine(line, tokens) || tokens.head != ".macro") return false;
+    std::string_view operands = tokens.operands;
+    std::string_view operand = nextOperand(operands);
+    if (operand.empty()) return false;
+    for (; !operand.empty(); operand = nextOperand(operands)) {
+        for (char c : operand) if (!isAlnum(c)) return false;
+    }
+    return true;
+}
+
+// blanks, then exactly ".endmacro"
+static bool isMacroEnd(std::string_view line) {
+    size_t pos = 0;
+    while (pos < line.size() && isBlank(line[pos])) ++pos;
+    return line.substr(pos) == ".endmacro";
+}
 
+/**
+ * Compiles a macro body line into segments, splitting it at every whole name (a run of letters and
+ * digits) that is one of the parameters, outside the line's opcode, directive or macro name.
+ */
+static std::vector<MacroSegment> compileLine(std::string_view line, const std::vector<std::string> &parameters) {
+    // find the head, which keeps its name: after "<label>: " and blanks, a directive or a name
+    size_t headStart = 0;
+    while (headStart < line.size() && isAlnum(line[headStart])) ++headStart;
+    if (headStart > 0 && headStart + 1 < line.size() && line[headStart] == ':' && line[headStart + 1] == ' ') headStart += 2;
+    else headStart = 0;
+    while (headStart < line.size() && isBlank(line[headStart])) ++headStart;
+    size_t headEnd = headStart;
+    if (headEnd < line.size() && line[headEnd] == '.') {
+        ++headEnd;
+        while (headEnd < line.size() && isLower(line[headEnd])) ++headEnd;
+    } else {
+        while (headEnd < line.size() && isAlnum(line[headEnd])) ++headEnd;
+    }
+
+    std::vector<MacroSegment> segments;
+    std::string text;
+    size_t pos = 0;
+    while (pos < line.size()) {
+        if (!isAlnum(line[pos])) {
+            text += line[pos++];
+            continue;
+        }
+        size_t start = pos;
+        while (pos < line.size() && isAlnum(line[pos])) ++pos;
+        std::string_view name = line.substr(start, pos - start);
+
+        int parameter = -1;
+        if (pos <= headStart || start >= headEnd) {
+            for (size_t i = 0; i < size(parameters); ++i) {
+                if (name == parameters[i]) parameter = i;
+            }
+        }
+        if (parameter < 0) {
+            text += name;
+        } else {
+            segments.push_back({std::move(text), parameter});
+            text.clear();
+        }
+    }
+    segments.push_back({std::move(text), -1});
+    return segments;
+}
+
+std::unordered_map<std::string, PDPMacro> searchMacros(const std::vector<std::string> &lines) {
     std::unordered_map<std::string, PDPMacro> results;
     bool inMacro = false;
     PDPMacro currentMacro;
+    LineTokens tokens;
     for (const std::string& line : lines) {
-        if (inMacro && std::regex_match(line, endMacroRegex)) {
+        if (inMacro && isMacroEnd(line)) {
 #ifdef DEBUG
             std::cout << "Found macro \"" << currentMacro.name << "\"" << std::endl;
 #endif
             inMacro = false;
-            results[currentMacro.name] = currentMacro;
+            results[currentMacro.name] = std::move(currentMacro);
 
             currentMacro = {
                 "",
                 {},
                 {}
             };
-        } else if (!inMacro && std::regex_match(line, beginMacroMatch, beginMacroRegex)) {
+        } else if (!inMacro && isMacroBegin(line, tokens)) {
             inMacro = true;
-            currentMacro.name = beginMacroMatch[3].str();
+            currentMacro.name = std::string(nextOperand(tokens.operands));
             currentMacro.parameters.clear();
-
-            std::string operands = beginMacroMatch[4];
-
-            // split operands by whitespace
-            std::regex  operandRegex("[^ \t\r]+");
-            for (auto it = std::sregex_iterator(begin(operands), end(operands), operandRegex); it != std::sregex_iterator(); ++it) {
-                currentMacro.parameters.emplace_back(it->str());
+            for (std::string_view param = nextOperand(tokens.operands); !param.empty(); param = nextOperand(tokens.operands)) {
+                currentMacro.parameters.emplace_back(param);
             }
 
-            currentMacro.contentLines.clear();
+            currentMacro.body.clear();
         } else if (inMacro) {
-            currentMacro.contentLines.emplace_back(line);
+            currentMacro.body.emplace_back(compileLine(line, currentMacro.parameters));
         }
     }
     return results;
 }
 
-std::vector<std::string> resolveDirectives(const std::vector<std::string> &lines, const std::unordered_map<std::string, PDPMacro> &macros) {
-    std::regex beginMacroRegex("(([A-Za-z0-9]+): )?[ \t\r]*\\.macro[ \t\r]+([A-Za-z0-9]+)(([ \t\r]+[A-Za-z0-9]+)*)");
-    std::regex endMacroRegex("[ \t\r]*\\.endmacro");
-
-    std::vector<std::string> results;
-    bool inMacro = false;
+/**
+ * Resolves one line, appending what it becomes to results.
+ * @param depth: how many macro expansions the line came out of
+ */
+static void resolveLine(const std::string &line, const std::unordered_map<std::string, PDPMacro> &macros,
+                        std::vector<std::string> &results, unsigned int depth) {
+    LineTokens tokens;
+    if (!lexLine(line, tokens)) throw formatError(line);
+
+    if (tokens.kind == LineKind::DIRECTIVE) {
+        // .space stays one line, the assembler keeping it as a block of zeros
+        if (tokens.head == ".fill" || tokens.head == ".space") {
+            results.emplace_back(line);
+        }
+        // comments (and stray macro directives) go
+        return;
+    }
 
-    auto addLinesToMacro = [&](std::string macroName, std::vector<std::string> operands) {
-        auto it = macros.find(macroName);
+    std::vector<std::string_view> arguments;
+    auto it = macros.find(std::string(tokens.head));
+    if (tokens.kind == LineKind::INSTRUCTION) {
         if (it == end(macros)) {
-            throw UndefinedMacro{macroName};
+            results.emplace_back(line);
+            return;
         }
-        PDPMacro m = it->second;
-        std::vector<std::regex> parameterRegexes;
-        for (const std::string &param : m.parameters) {
-            parameterRegexes.emplace_back(std::regex{param});
+        // an invocation that looks like an instruction: its argument as written, '&' and all
+        if (!tokens.operands.empty()) {
+            arguments.emplace_back(tokens.operands.data() - tokens.indirect, tokens.operands.size() + tokens.indirect);
         }
+    } else {
+        if (it == end(macros)) throw UndefinedMacro{std::string(tokens.head)};
+        for (std::string_view operand = nextOperand(tokens.operands); !operand.empty(); operand = nextOperand(tokens.operands)) {
+            arguments.emplace_back(operand);
+        }
+    }
 
-        // go through macro body and replace parameters
-        for (const std::string &line : m.contentLines) {
-            std::string evaluated = line;
-            for (int i = 0; i < size(parameterRegexes); ++i) {
-                evaluated = std::regex_replace(evaluated, parameterRegexes[i], operands[i]);
-            }
-            results.emplace_back(evaluated);
+    const PDPMacro &macro = it->second;
+    if (size(arguments) != size(macro.parameters)) {
+        throw InvalidMacroInvocation{macro.name, "expected " + std::to_string(size(macro.parameters)) +
+                                                 " arguments, got " + std::to_string(size(arguments))};
+    }
+    if (depth >= MACRO_MAX_DEPTH) {
+        throw InvalidMacroInvocation{macro.name, "invocations nested more than " + std::to_string(MACRO_MAX_DEPTH) + " deep"};
+    }
+
+    std::string expanded;
+    for (const std::vector<MacroSegment> &segments : macro.body) {
+        expanded.clear();
+        for (const MacroSegment &segment : segments) {
+            expanded += segment.text;
+            if (segment.parameter >= 0) expanded += arguments[segment.parameter];
         }
+        resolveLine(expanded, macros, results, depth + 1);
+    }
+}
 
-        return;
-    };
+std::vector<std::string> resolveDirectives(const std::vector<std::string> &lines, const std::unordered_map<std::string, PDPMacro> &macros) {
+    std::vector<std::string> results;
+    bool inMacro = false;
 
-    for (auto line : lines) {
-        if (inMacro && std::regex_match(line, endMacroRegex)) {
+    LineTokens tokens;
+    for (const std::string &line : lines) {
+        if (inMacro && isMacroEnd(line)) {
             inMacro = false;
-        } else if (!inMacro && std::regex_match(line, beginMacroRegex)) {
+        } else if (!inMacro && isMacroBegin(line, tokens)) {
             inMacro = true;
         } else if (!inMacro) {
-            // don't actually care about line num rn
-            LineType parsed = parseLine(line, -1);
-            if (std::holds_alternative<InstructionLine>(parsed)) {
-                // instruction maybe
-                InstructionLine il = std::get<InstructionLine>(parsed);
-                if (macros.find(il.opcode) != end(macros)) {
-                    // nvm it's a macro
-                    std::vector<std::string> operands;
-                    operands.reserve(1);
-
-                    if (il.operand) operands.emplace_back(il.operand.value());
-
-                    addLinesToMacro(il.opcode, operands);
-                } else {
-                    results.emplace_back(line);
-                }
-            } else if (std::holds_alternative<DirectiveLine>(parsed)) {
-                // directive
-                DirectiveLine dl = std::get<DirectiveLine>(parsed);
-                if (dl.directive == ".") {
-                    continue;
-                }
-                if (dl.directive == ".fill") {
-                    results.emplace_back(line);
-                }
-                if (dl.directive == ".space") {
-                    if (size(dl.operands) == 0) throw InvalidDirective{"Operand is required for .space"};
-                    int numZeroes = stoi(dl.operands[0]);
-                    if (numZeroes < 0) throw InvalidDirective{".space cannot take negative values"};
-                    for (int i = 0; i < numZeroes; ++i) {
-                        results.emplace_back(" .fill 0");
-                    }
-                }
-                // macro is taken care of
-            } else {
-                // macro invocation
-                MacroInvocation mi = std::get<MacroInvocation>(parsed);
-                addLinesToMacro(mi.macro, mi.operands);
-            }
+            resolveLine(line, macros, results, 0);
         }
     }
     return results;
 }
-
@@ -10,17 +10,50 @@
 #include <unordered_map>
 #include <vector>
 
+// deepest nesting of macro invocations, which stops a recursive macro
+#define MACRO_MAX_DEPTH 64
+
+/**
+ * A piece of a macro body line: literal text, then (unless parameter is -1) the argument for
+ * the given parameter.
+ */
+struct MacroSegment {
+    std::string              text;
+    int                      parameter;
+};
+
 struct PDPMacro {
-    std::string              name;
-    std::vector<std::string> parameters;
-    std::vector<std::string> contentLines;
+    std::string                             name;
+    std::vector<std::string>                parameters;
+    std::vector<std::vector<MacroSegment>>  body;       // one template per body line
 };
 
+/**
+ * Notes down every macro definition, compiling each body line into a template in which the
+ * macro's parameters are slots. A parameter is only replaced where it makes up a whole name (a run
+ * of letters and digits) in a label or operand, never in an opcode or directive.
+ * @param lines: the source lines
+ * @return the macros by name
+ */
 std::unordered_map<std::string, PDPMacro> searchMacros(const std::vector<std::string> &lines);
 
+/**
+ * Expands macro invocations, and drops comments and macro definitions. The lines a
+ * macro expands to are resolved in turn, so macros may invoke other macros, up to MACRO_MAX_DEPTH
+ * deep.
+ * @param lines: the source lines
+ * @param macros: the macros, from searchMacros
+ * @return the resolved lines, one per word or .space block
+ * @throws UndefinedMacro, InvalidMacroInvocation or LineParseError
+ */
 std::vector<std::string> resolveDirectives(const std::vector<std::string> &lines, const std::unordered_map<std::string, PDPMacro> &macros);
 
 struct UndefinedMacro {
     std::string macroName;
 };
 
+struct InvalidMacroInvocation {
+    std::string macroName;
+    std::string error;
+};
+
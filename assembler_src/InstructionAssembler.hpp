@@ -9,6 +9,7 @@
 #include <bitset>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "LineParser.hpp"
 #include "LabelResolver.hpp"
@@ -17,9 +18,11 @@
  * Assembles the given instruction into machine code
  * @param il: the instruction to assemble
  * @param lr: a LabelResolver used to resolve any labels
+ * @param relocations: if given, a label operand is left for the linker and noted here instead
  * @return a std::bitset<18> containing the machine code for the provided instruction
  */
-std::bitset<18> assembleInstruction(const InstructionLine& il, const LabelResolver& lr);
+std::bitset<18> assembleInstruction(const InstructionLine& il, const LabelResolver& lr,
+                                    std::vector<Relocation>* relocations = nullptr);
 
 struct InvalidOpcode {
     std::string opcode;
@@ -1,19 +1,34 @@
 
 #include <algorithm>
 #include <array>
+#include <iomanip>
 #include <iostream>
-#include <regex>
 #include <string>
+#include <string_view>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "LabelResolver.hpp"
 
-void LabelResolver::addLabel(const LabelInfo& label) {
-    std::regex symbolicRegex("([A-Za-z][A-Za-z0-9]{0,7})");
-    std::regex numericRegex("([0-9]{1,3})");
+#include "AssemblerCommon.hpp"
+
+// a letter, then up to 7 letters or digits
+static bool isSymbolic(std::string_view label) {
+    if (label.empty() || label.size() > 8 || !isLetter(label[0])) return false;
+    for (char c : label) if (!isAlnum(c)) return false;
+    return true;
+}
 
-    if (std::regex_match(label.label, symbolicRegex)) {
+// 1 to 3 digits
+static bool isNumeric(std::string_view label) {
+    if (label.empty() || label.size() > 3) return false;
+    for (char c : label) if (!isDigit(c)) return false;
+    return true;
+}
+
+void LabelResolver::addLabel(const LabelInfo& label) {
+    if (isSymbolic(label.label)) {
 #ifdef DEBUG
         std::cout << "Found symbolic label " << label.label << std::endl;
 #endif
@@ -21,7 +36,7 @@ void LabelResolver::addLabel(const LabelInfo& label) {
             throw DuplicateLabelError{label.label};
         }
         symbolicLabels[label.label] = label.line;
-    } else if (std::regex_match(label.label, numericRegex)) {
+    } else if (isNumeric(label.label)) {
 #ifdef DEBUG
         std::cout << "Found numeric label " << label.label << std::endl;
 #endif
@@ -36,19 +51,20 @@ void LabelResolver::addLabel(const LabelInfo& label) {
 }
 
 unsigned int LabelResolver::resolveLabel(const std::string& label, unsigned int currentPosition) const {
-    std::regex symbolicRegex("([A-Za-z][A-Za-z0-9]{0,7})");
-    std::regex numericRegex("([0-9]{1,3})(f|b)");
-    std::smatch numericMatch;
+    std::string_view number(label.data(), label.empty() ? 0 : label.size() - 1);
+    char direction = label.empty() ? '\0' : label.back();
 
-    if (std::regex_match(label, symbolicRegex)) {
+    if (isSymbolic(label)) {
         auto it = symbolicLabels.find(label);
         if (it == end(symbolicLabels)) {
             throw UndefinedLabelError{label};
         }
         return it->second;
-    } else if (std::regex_match(label, numericMatch, numericRegex)) {
-        unsigned int index = stoul(numericMatch[1]);
-        char direction = numericMatch[2].str()[0];
+    } else if (isNumeric(number) && (direction == 'f' || direction == 'b')) {
+        unsigned int index = stoul(std::string(number));
+        if (index >= size(numericLabels)) {
+            throw UndefinedLabelError{label};
+        }
 
         const std::vector<unsigned int> &vec = numericLabels[index];
         if (size(vec) == 0) {
@@ -74,3 +90,40 @@ unsigned int LabelResolver::resolveLabel(const std::string& label, unsigned int
         throw InvalidLabelError{label, "Invalid label format."};
     }
 }
+
+unsigned int LabelResolver::resolveOperand(const std::string& label, unsigned int currentPosition, RelocationField field,
+                                           std::vector<Relocation>* relocations) const {
+    if (!relocations) return placeAddress(field, resolveLabel(label, currentPosition));
+
+    if (isSymbolic(label) && symbolicLabels.find(label) == end(symbolicLabels)) {
+        relocations->push_back({currentPosition, field, label, 0});
+    } else {
+        relocations->push_back({currentPosition, field, "", resolveLabel(label, currentPosition)});
+    }
+    return 0;
+}
+
+unsigned int LabelResolver::placeAddress(RelocationField field, unsigned int address) {
+    if (field == RelocationField::ADDRESS) return address & 0777;
+    return onesComplement(address, 18);
+}
+
+std::vector<LabelInfo> LabelResolver::labels() const {
+    std::vector<std::pair<unsigned int, std::string>> symbols;
+    for (const auto &[label, line] : symbolicLabels) symbols.emplace_back(line, label);
+    for (unsigned int i = 0; i < size(numericLabels); ++i) {
+        for (unsigned int line : numericLabels[i]) symbols.emplace_back(line, std::to_string(i));
+    }
+    std::sort(begin(symbols), end(symbols));
+
+    std::vector<LabelInfo> sorted;
+    sorted.reserve(size(symbols));
+    for (auto &[line, label] : symbols) sorted.push_back({std::move(label), line});
+    return sorted;
+}
+
+void LabelResolver::writeSymbols(std::ostream& os) const {
+    for (const LabelInfo &label : labels()) {
+        os << std::oct << std::setw(6) << std::setfill('0') << label.line << std::dec << " " << label.label << "\n";
+    }
+}
@@ -7,6 +7,7 @@
 #pragma once
 
 #include <array>
+#include <iostream>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -16,6 +17,22 @@ struct LabelInfo {
     unsigned int    line;
 };
 
+enum class RelocationField {
+    ADDRESS,    // the address bits of a memory reference instruction
+    WORD        // the whole word (.fill)
+};
+
+/**
+ * A label reference in a relocatable word, left for the linker to fill in once it has placed every
+ * file: the address of `symbol` if it is set, otherwise the word's own file's start plus `offset`.
+ */
+struct Relocation {
+    unsigned int    address;    // of the word, counting from the start of its file
+    RelocationField field;
+    std::string     symbol;     // a symbolic label defined in another file, or empty
+    unsigned int    offset;     // the label's address in this file, without a symbol
+};
+
 class LabelResolver {
 
 private:
@@ -45,6 +62,41 @@ public:
      */
     unsigned int resolveLabel(const std::string& label, unsigned int currentPosition) const;
 
+    /**
+     * Resolves a label operand into the bits of a word that hold it.
+     * With relocations, the word is assembled to be relocatable: the operand's bits are left 0 and
+     * the reference is appended to relocations instead, and a symbolic label that is not defined
+     * here is taken to be defined in another file.
+     * @param label: the label operand
+     * @param currentPosition: the address of the word
+     * @param field: where in the word the label goes
+     * @param relocations: where to note the reference, or nullptr to resolve it now
+     * @return the label's bits of the word
+     * @throws UndefinedLabelError if the label is not found (or is a missing numeric label)
+     */
+    unsigned int resolveOperand(const std::string& label, unsigned int currentPosition, RelocationField field,
+                                std::vector<Relocation>* relocations) const;
+
+    /**
+     * Places an address into a field of a word.
+     * @param field: the field
+     * @param address: the address
+     * @return the field's bits of the word
+     */
+    static unsigned int placeAddress(RelocationField field, unsigned int address);
+
+    /**
+     * @return every label (numeric ones once per definition), sorted by address
+     */
+    std::vector<LabelInfo> labels() const;
+
+    /**
+     * Writes a symbol map of every label, one "<octal address> <label>" line each, sorted by address.
+     * The simulator uses it to label profiles (simulator --symbols).
+     * @param os: the stream to write to
+     */
+    void writeSymbols(std::ostream& os) const;
+
 public:
 
     struct InvalidLabelError {
@@ -1,83 +1,128 @@
 
 #include <iostream>
 #include <string>
+#include <string_view>
 #include <utility>
-#include <regex>
 #include <variant>
 #include <vector>
 
 #include "LineParser.hpp"
 
-LineType parseInstruction(const std::smatch &match, unsigned int index) {
-    std::string label    = match[2];
-    std::string opcode   = match[3];
-    std::string operand  = match[6];
-    std::string indirect = match[5];
-    return InstructionLine {
-        label == ""   ? std::nullopt : std::optional<std::string>(label),
-        opcode,
-        operand == "" ? std::nullopt : std::optional<std::string>(operand),
-        index,
-        indirect == "&"
-    };
+#include "AssemblerCommon.hpp"
+
+/**
+ * Checks that the rest of a line is any number of operands, each preceded by blanks.
+ */
+static bool validOperands(std::string_view rest, unsigned int &count) {
+    size_t pos = 0;
+    count = 0;
+    while (pos < rest.size()) {
+        if (!isBlank(rest[pos])) return false;
+        while (pos < rest.size() && isBlank(rest[pos])) ++pos;
+        if (pos == rest.size()) return false;
+        while (pos < rest.size() && !isBlank(rest[pos])) ++pos;
+        ++count;
+    }
+    return true;
 }
 
-LineType parseDirective(const std::smatch &match, unsigned int index) {
-    std::string label     = match[2];
-    std::string directive = match[3];
-    std::string operands  = match[4];
+bool lexLine(std::string_view line, LineTokens &tokens) {
+    size_t pos = 0;
+    while (pos < line.size() && isAlnum(line[pos])) ++pos;
+    if (pos > 0 && pos + 1 < line.size() && line[pos] == ':' && line[pos + 1] == ' ') {
+        tokens.label = line.substr(0, pos);
+        pos += 2;
+    } else {
+        tokens.label = {};
+        pos = 0;
+    }
+    while (pos < line.size() && isBlank(line[pos])) ++pos;
+
+    size_t start = pos;
+    bool opcode = false;
+    if (pos < line.size() && line[pos] == '.') {
+        tokens.kind = LineKind::DIRECTIVE;
+        ++pos;
+        while (pos < line.size() && isLower(line[pos])) ++pos;
+    } else {
+        tokens.kind = LineKind::MACRO;
+        opcode = true;
+        for (; pos < line.size() && isAlnum(line[pos]); ++pos) opcode = opcode && isLower(line[pos]);
+        if (pos == start) return false;
+        opcode = opcode && pos - start >= 3 && pos - start <= 4;
+    }
+    tokens.head = line.substr(start, pos - start);
+    tokens.operands = line.substr(pos);
+    tokens.indirect = false;
 
-    std::vector<std::string> operandsList;
+    unsigned int count;
+    if (!validOperands(tokens.operands, count)) return false;
 
-    // split operands by whitespace
-    std::regex  operandRegex("[^ \t\r]+");
-    for (auto it = std::sregex_iterator(begin(operands), end(operands), operandRegex); it != std::sregex_iterator(); ++it) {
-        operandsList.emplace_back(it->str());
+    // an opcode with more than one operand can only be a macro
+    if (opcode && count <= 1) {
+        tokens.kind = LineKind::INSTRUCTION;
+        tokens.operands = nextOperand(tokens.operands);
+        if (tokens.operands.size() > 1 && tokens.operands[0] == '&') {
+            tokens.indirect = true;
+            tokens.operands.remove_prefix(1);
+        }
     }
+    return true;
+}
 
-    return DirectiveLine{
-        label == ""   ? std::nullopt : std::optional<std::string>(label),
-        directive,
-        operandsList,
-        index
-    };
+std::string_view nextOperand(std::string_view &operands) {
+    size_t start = 0;
+    while (start < operands.size() && isBlank(operands[start])) ++start;
+    size_t end = start;
+    while (end < operands.size() && !isBlank(operands[end])) ++end;
+    std::string_view operand = operands.substr(start, end - start);
+    operands.remove_prefix(end);
+    return operand;
 }
 
-LineType parseMacro(const std::smatch &match, unsigned int index) {
-    std::string label    = match[2];
-    std::string macro    = match[3];
-    std::string operands = match[4];
+LineParseError formatError(std::string_view line) {
+    std::cerr << "Formatting error: line \"" << line << "\"" << std::endl;
+    return LineParseError{"Formatting error: line \"" + std::string(line) + "\""};
+}
 
+static std::vector<std::string> splitOperands(std::string_view operands) {
     std::vector<std::string> operandsList;
-
-    // split operands by whitespace
-    std::regex  operandRegex("[^ \t\r]+");
-    for (auto it = std::sregex_iterator(begin(operands), end(operands), operandRegex); it != std::sregex_iterator(); ++it) {
-        operandsList.emplace_back(it->str());
+    for (std::string_view operand = nextOperand(operands); !operand.empty(); operand = nextOperand(operands)) {
+        operandsList.emplace_back(operand);
     }
-
-    return MacroInvocation {
-        label,
-        macro,
-        operandsList,
-        index
-    };
+    return operandsList;
 }
 
 LineType parseLine(const std::string &line, unsigned int index) {
-    std::regex instructionLineRegex("(([A-Za-z0-9]+): )?[ \t\r]*([a-z]{3,4})([ \t\r]+(&)?([^ \t\r]+))?");
-    std::regex directiveLineRegex("(([A-Za-z0-9]+): )?[ \t\r]*(\\.[a-z]*)(([ \t\r]+([^ \t\r]+))*)");
-    std::regex macroInvocationRegex("(([A-Za-z0-9]+): )?[ \t\r]*([A-Za-z0-9]+)(([ \t\r]+([^ \t\r]+))*)");
-    std::smatch match;
-    if (std::regex_match(line, match, instructionLineRegex)) {
-        return parseInstruction(match, index);
-    } else if (std::regex_match(line, match, directiveLineRegex)) {
-        return parseDirective(match, index);
-    } else if (std::regex_match(line, match, macroInvocationRegex)) {
-        return parseMacro(match, index);
-    } else {
-        std::cerr << "Formatting error: line \"" << line << "\"" << std::endl;
-        throw LineParseError{"Formatting error: line \"" + line + "\""};
+    LineTokens tokens;
+    if (!lexLine(line, tokens)) throw formatError(line);
+
+    std::optional<std::string> label;
+    if (!tokens.label.empty()) label = std::string(tokens.label);
+
+    switch (tokens.kind) {
+    case LineKind::INSTRUCTION:
+        return InstructionLine {
+            label,
+            std::string(tokens.head),
+            tokens.operands.empty() ? std::nullopt : std::optional<std::string>(tokens.operands),
+            index,
+            tokens.indirect
+        };
+    case LineKind::DIRECTIVE:
+        return DirectiveLine {
+            label,
+            std::string(tokens.head),
+            splitOperands(tokens.operands),
+            index
+        };
+    default:
+        // an invocation always has a label, if only an empty one
+        return MacroInvocation {
+            std::string(tokens.label),
+            std::string(tokens.head),
+            splitOperands(tokens.operands),
+            index
+        };
     }
 }
-
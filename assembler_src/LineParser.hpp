@@ -7,8 +7,8 @@
 #pragma once
 
 #include <optional>
-#include <regex>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <variant>
 #include <vector>
@@ -45,6 +45,51 @@ struct InvalidDirective {
     std::string                error;
 };
 
+enum class LineKind {
+    INSTRUCTION,
+    DIRECTIVE,
+    MACRO
+};
+
+/**
+ * The fields of one line, as views into it.
+ */
+struct LineTokens {
+    LineKind                   kind;
+    std::string_view           label;       // empty if there is none
+    std::string_view           head;        // opcode, directive (including its '.') or macro name
+    std::string_view           operands;    // an instruction's operand (without '&'), otherwise every operand with the blanks before each
+    bool                       indirect;
+};
+
+/**
+ * Splits the provided line into its fields in a single left to right scan, without copying it.
+ * A line is an optional "<label>: " (alphanumeric, followed by exactly one space), blanks (spaces,
+ * tabs or carriage returns), then either
+ *   - a directive: '.' and lowercase letters, then any number of blank-separated operands,
+ *   - an instruction: 3 or 4 lowercase letters, then at most one operand, optionally prefixed '&',
+ *   - a macro invocation: an alphanumeric name, then any number of blank-separated operands.
+ * Nothing may follow the last field, not even blanks.
+ * @param line: the line to split
+ * @param tokens: filled in with the line's fields
+ * @return false if the line format is unrecognized
+ */
+bool lexLine(std::string_view line, LineTokens &tokens);
+
+/**
+ * Takes the next operand off the front of a LineTokens' operands.
+ * @param operands: the remaining operands, advanced past the one returned
+ * @return the operand, or an empty view once there are none left
+ */
+std::string_view nextOperand(std::string_view &operands);
+
+/**
+ * Reports (on stderr) a line whose format is unrecognized.
+ * @param line: the line
+ * @return the error to throw
+ */
+LineParseError formatError(std::string_view line);
+
 /**
  * Parses the provided line, returning an InstructionLine or DirectiveLine depending on its format.
  * @param line: the line to parse
@@ -0,0 +1,156 @@
+
+#include <bitset>
+#include <charconv>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "ObjectFile.hpp"
+
+#include "Assembler.hpp"
+#include "AssemblerCommon.hpp"
+#include "LabelResolver.hpp"
+
+void writeObject(std::ostream &os, const AssembledProgram &program) {
+    std::vector<LabelInfo> labels = program.labels.labels();
+
+    os << OBJECT_MAGIC << " " << OBJECT_VERSION << "\n";
+    os << program.words << " " << size(program.machineCode) << " " << size(labels) << " " << size(program.relocations) << "\n";
+
+    for (unsigned int i = 0; i < size(program.machineCode); ++i) {
+        os << std::oct << std::setw(6) << std::setfill('0') << program.machineCode[i].to_ulong() << std::dec
+           << " " << program.lengths[i] << " " << program.lines[i] << "\n";
+    }
+    program.labels.writeSymbols(os);
+    for (const Relocation &r : program.relocations) {
+        os << std::oct << std::setw(6) << std::setfill('0') << r.address
+           << (r.field == RelocationField::ADDRESS ? " a " : " w ");
+        if (r.symbol.empty()) os << std::setw(6) << r.offset;
+        else os << r.symbol;
+        os << std::dec << "\n";
+    }
+}
+
+/**
+ * Takes the next space-separated field off the front of a line.
+ */
+static std::string_view nextField(std::string_view &rest) {
+    size_t end = rest.find(' ');
+    std::string_view field = rest.substr(0, end);
+    rest.remove_prefix(end == std::string_view::npos ? size(rest) : end + 1);
+    return field;
+}
+
+/**
+ * Takes the next field off the front of a line as a number in the given base.
+ * @return false if the field is not a number
+ */
+static bool nextNumber(std::string_view &rest, unsigned int &value, int base) {
+    std::string_view field = nextField(rest);
+    auto [ptr, ec] = std::from_chars(field.data(), field.data() + size(field), value, base);
+    return !field.empty() && ec == std::errc() && ptr == field.data() + size(field);
+}
+
+AssembledProgram readObject(std::istream &is, const std::string &name) {
+    AssembledProgram program;
+    std::string line;
+    auto error = [&](const std::string &what) { return ObjectFormatError{name + ": " + what}; };
+
+    if (!getline(is, line) || line != OBJECT_MAGIC " " + std::to_string(OBJECT_VERSION)) {
+        throw error("not a version " + std::to_string(OBJECT_VERSION) + " object file");
+    }
+
+    unsigned int words, segments, labels, relocations;
+    std::string_view rest;
+    if (!getline(is, line) || !nextNumber(rest = line, words, 10) || !nextNumber(rest, segments, 10)
+        || !nextNumber(rest, labels, 10) || !nextNumber(rest, relocations, 10) || !rest.empty()) {
+        throw error("bad counts line");
+    }
+
+    program.lines.reserve(segments);
+    program.machineCode.reserve(segments);
+    program.lengths.reserve(segments);
+    for (unsigned int i = 0; i < segments; ++i) {
+        unsigned int word, length;
+        if (!getline(is, line) || !nextNumber(rest = line, word, 8) || word > 0777777 || !nextNumber(rest, length, 10)) {
+            throw error("bad word " + std::to_string(i));
+        }
+        program.machineCode.emplace_back(word);
+        program.lengths.push_back(length);
+        program.lines.emplace_back(rest);
+        program.words += length;
+    }
+    if (program.words != words) throw error("words do not add up to " + std::to_string(words));
+
+    for (unsigned int i = 0; i < labels; ++i) {
+        unsigned int address;
+        if (!getline(is, line) || !nextNumber(rest = line, address, 8) || address > words) {
+            throw error("bad label " + std::to_string(i));
+        }
+        program.labels.addLabel({std::string(rest), address});
+    }
+
+    program.relocations.reserve(relocations);
+    for (unsigned int i = 0; i < relocations; ++i) {
+        Relocation r{0, RelocationField::ADDRESS, "", 0};
+        std::string_view field;
+        if (!getline(is, line) || !nextNumber(rest = line, r.address, 8) || r.address >= words
+            || (!program.relocations.empty() && r.address < program.relocations.back().address)
+            || ((field = nextField(rest)) != "a" && field != "w") || rest.empty()) {
+            throw error("bad relocation " + std::to_string(i));
+        }
+        if (field == "w") r.field = RelocationField::WORD;
+        if (!isDigit(rest[0])) {
+            r.symbol = rest;
+        } else if (!nextNumber(rest, r.offset, 8) || r.offset > words) {
+            throw error("bad relocation " + std::to_string(i));
+        }
+        program.relocations.push_back(std::move(r));
+    }
+
+    return program;
+}
+
+AssembledProgram linkObjects(const std::vector<AssembledProgram> &objects) {
+    AssembledProgram linked;
+
+    // place every file and gather the labels, so that any file can refer to any other
+
+    std::vector<unsigned int> bases;
+    bases.reserve(size(objects));
+    for (const AssembledProgram &object : objects) {
+        bases.push_back(linked.words);
+        for (const LabelInfo &label : object.labels.labels()) {
+            linked.labels.addLabel({label.label, static_cast<unsigned int>(linked.words) + label.line});
+        }
+        linked.words += object.words;
+    }
+
+    // copy the words, filling in the label references
+
+    for (unsigned int f = 0; f < size(objects); ++f) {
+        const AssembledProgram &object = objects[f];
+        size_t segment = size(linked.machineCode);
+        linked.lines.insert(end(linked.lines), begin(object.lines), end(object.lines));
+        linked.machineCode.insert(end(linked.machineCode), begin(object.machineCode), end(object.machineCode));
+        linked.lengths.insert(end(linked.lengths), begin(object.lengths), end(object.lengths));
+
+        // relocations come by address, like the segments
+        unsigned int address = 0;
+        for (const Relocation &r : object.relocations) {
+            while (segment < size(linked.lengths) && address + linked.lengths[segment] <= r.address) {
+                address += linked.lengths[segment++];
+            }
+            if (segment == size(linked.lengths) || address != r.address || linked.lengths[segment] != 1) {
+                throw ObjectFormatError{"relocation at " + std::to_string(r.address) + " is not in a word"};
+            }
+
+            unsigned int target = r.symbol.empty() ? bases[f] + r.offset : linked.labels.resolveLabel(r.symbol, 0);
+            linked.machineCode[segment] |= std::bitset<18>(LabelResolver::placeAddress(r.field, target));
+        }
+    }
+
+    return linked;
+}
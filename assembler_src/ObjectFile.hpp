@@ -0,0 +1,59 @@
+//
+// PDP-1 Assembler
+// Relocatable Object Files
+//
+
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "Assembler.hpp"
+
+// An object file is one relocatably assembled source file (assembler --object), as text:
+//
+//   PDP1OBJ <version>
+//   <words> <segments> <labels> <relocations>
+//   <octal word> <length> <source line>         one per segment: a word (length 1) or a .space block
+//   <octal address> <label>                     one per label, as in a symbol map
+//   <octal address> a|w <octal offset|symbol>   one per relocation, by address
+//
+// Addresses, words and offsets are octal, counts and lengths decimal. Addresses count from the
+// start of the file. A relocation names the word holding a label reference, whether the label
+// goes into its address bits (a) or the whole word (w, .fill), and either the label's address in
+// the same file or a symbolic label to find among all files.
+
+#define OBJECT_MAGIC    "PDP1OBJ"
+#define OBJECT_VERSION  1
+
+/**
+ * Writes a relocatable program as an object file.
+ * @param os: the stream to write to
+ * @param program: the program, assembled with relocatable set
+ */
+void writeObject(std::ostream &os, const AssembledProgram &program);
+
+/**
+ * Reads an object file back into the program it was written from.
+ * @param is: the stream to read
+ * @param name: the file's name, for error messages
+ * @return the relocatable program
+ * @throws ObjectFormatError if the file is not a well-formed object file
+ */
+AssembledProgram readObject(std::istream &is, const std::string &name);
+
+/**
+ * Links relocatable programs into one: places them one after another from address 0, merges
+ * their labels and fills in every label reference.
+ * @param objects: the programs, in the order they go into memory
+ * @return the linked program, with no relocations left
+ * @throws LabelResolver::DuplicateLabelError if two files define the same symbolic label
+ * @throws LabelResolver::UndefinedLabelError if no file defines a referenced symbolic label
+ * @throws ObjectFormatError if a relocation does not name a word
+ */
+AssembledProgram linkObjects(const std::vector<AssembledProgram> &objects);
+
+struct ObjectFormatError {
+    std::string                error;
+};
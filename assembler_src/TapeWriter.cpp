@@ -1,18 +1,58 @@
 
+#include <algorithm>
 #include <bitset>
+#include <cstdint>
 #include <iostream>
 #include <string>
 #include <vector>
 
 #include "TapeWriter.hpp"
 
-TapeWriter::TapeWriter(std::ostream &os_in) : os(os_in) {
+#include "../common_src/TapeFormat.hpp"
+
+static void writeLittleEndian(std::ostream &os, uint32_t value) {
+    char bytes[4] = {
+        static_cast<char>(value & 0xFF),
+        static_cast<char>((value >> 8) & 0xFF),
+        static_cast<char>((value >> 16) & 0xFF),
+        static_cast<char>((value >> 24) & 0xFF),
+    };
+    os.write(bytes, sizeof(bytes));
+}
+
+TapeWriter::TapeWriter(std::ostream &os_in, TapeFormat format_in) : os(os_in), format(format_in) {
+    if (format == TapeFormat::BINARY) {
+        os.write(TAPE_BINARY_MAGIC, TAPE_BINARY_MAGIC_SIZE);
+        writeLittleEndian(os, TAPE_BINARY_VERSION);
+        writeLittleEndian(os, 0);
+        return;
+    }
     os << "  3 2 1\n";
 }
 
 void TapeWriter::writeWord(const std::bitset<18> &word, const std::string& annotation) {
+    if (format == TapeFormat::BINARY) {
+        writeLittleEndian(os, static_cast<uint32_t>(word.to_ulong()));
+        return;
+    }
+    punchRecord(static_cast<uint32_t>(word.to_ulong()), false, annotation);
+}
+
+void TapeWriter::writeZeros(uint32_t count, const std::string& annotation) {
+    static_assert(TAPE_BINARY_RUN_MAX <= TAPE_BINARY_RUN_COUNT && TAPE_ASCII_RUN_MAX <= 0777777, "run too long for its record");
+    uint32_t most = format == TapeFormat::BINARY ? TAPE_BINARY_RUN_MAX : TAPE_ASCII_RUN_MAX;
+    while (count) {
+        uint32_t run = std::min(count, most);
+        if (format == TapeFormat::BINARY) writeLittleEndian(os, TAPE_BINARY_RUN | run);
+        else punchRecord(run, true, annotation);
+        count -= run;
+    }
+}
+
+void TapeWriter::punchRecord(uint32_t value, bool run, const std::string& annotation) {
+    std::bitset<18> word(value);
     os << "8 O O O\n";
-    os << "7      \n";
+    os << (run ? "7 O    \n" : "7      \n");
     for (int i = 6; i >= 1; --i) {
         os << i;
         if (word[i-1])    os << " O";
@@ -28,4 +68,3 @@ void TapeWriter::writeWord(const std::bitset<18> &word, const std::string& annot
         }
     }
 }
-
@@ -1,25 +1,50 @@
-
 //
 // PDP-1 Assembler
 // Punched Tape Writer
 //
 
+#pragma once
+
 #include <bitset>
+#include <cstdint>
 #include <iostream>
 #include <string>
 #include <vector>
 
+enum class TapeFormat {
+    ASCII,      // annotated ASCII art, one 9-line record per word
+    BINARY      // compact image, see common_src/TapeFormat.hpp
+};
+
 class TapeWriter {
 
 private:
 
     std::ostream& os;
+    TapeFormat format;
 
-public:
+    void punchRecord(uint32_t value, bool run, const std::string& annotation);
 
-    TapeWriter(std::ostream &os);
+public:
 
+    /**
+     * Writes the tape header.
+     * @param os: output stream (should be opened in binary mode for TapeFormat::BINARY)
+     * @param format: tape format to write
+     */
+    TapeWriter(std::ostream &os, TapeFormat format = TapeFormat::ASCII);
+
+    /**
+     * @param word: the word to punch
+     * @param annotation: source line shown next to the word (ASCII tapes only)
+     */
     void writeWord(const std::bitset<18> &word, const std::string& annotation);
 
-};
+    /**
+     * Punches a run of zero words (a .space block) as a single record, or a few for long runs.
+     * @param count: number of zero words
+     * @param annotation: source line shown next to the record (ASCII tapes only)
+     */
+    void writeZeros(uint32_t count, const std::string& annotation);
 
+};
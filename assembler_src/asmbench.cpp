@@ -0,0 +1,145 @@
+//
+// PDP-1 Assembler
+// Assembler throughput benchmark
+//
+// Benchmark CLI
+// ./asmbench [--lines N] [--repeat R] [INFILE]
+//
+// Assembles INFILE, or a generated source of N lines, R times in memory (no tape is written) and
+// prints the best run's time and throughput in source lines per second. The generated source mixes
+// symbolic and numeric labels, memory reference, skip, shift and operate instructions, indirect
+// operands, .fill, .space, comments and macro invocations, roughly like a hand-written program.
+//
+// Flags:
+//   -n / --lines <N>: lines of generated source, without INFILE (default 20000)
+//   -r / --repeat <R>: runs to time (default 5)
+//
+
+#include <chrono>
+#include <fstream>
+#include <getopt.h>
+#include <iostream>
+#include <random>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+#include "Assembler.hpp"
+
+// default generated source size, and runs to time
+#define ASMBENCH_LINES  20000
+#define ASMBENCH_REPEAT 5
+
+// a label every this many generated lines
+#define ASMBENCH_LABEL_EVERY 8
+
+void usage() {
+    std::cout << "Usage:\n"
+              << "./asmbench [--lines N] [--repeat R] [INFILE]\n";
+    exit(1);
+}
+
+/**
+ * Generates a program of (about) the given number of source lines.
+ */
+static std::vector<std::string> generateSource(unsigned int lines) {
+    static const char *const MEMORY[] = {"lac", "dac", "add", "sub", "and", "ior", "xor", "sad", "sas", "lio", "dio", "dzm", "idx", "isp"};
+    static const char *const OTHERS[] = {"sza", "spa", "sma", "szo", "cla", "cma", "cli", "lat", "nop", "skp za|pa", "skpn zo"};
+    static const char *const SHIFTS[] = {"ral", "rar", "sal", "sar", "ril", "rir", "rcl", "rcr"};
+
+    std::mt19937 rng(1);
+    std::vector<std::string> source = {
+        "            .macro  twice   X",
+        "            idx     X",
+        "            idx     X",
+        "            .endmacro",
+        "1:          nop",
+    };
+    unsigned int labels = lines / ASMBENCH_LABEL_EVERY + 1;
+    auto label = [&](unsigned int index) { return "l" + std::to_string(index); };
+
+    unsigned int generated = 0;
+    for (; source.size() < lines; ++generated) {
+        std::string line;
+        if (generated % ASMBENCH_LABEL_EVERY == 0) line = label(generated / ASMBENCH_LABEL_EVERY) + ": ";
+        else if (generated % ASMBENCH_LABEL_EVERY == 5) line = "1: ";
+        bool labelled = !line.empty();
+        line.resize(12, ' ');
+
+        // macro invocations, comments and .space only go on unlabelled lines
+        std::string target = label(rng() % labels);
+        unsigned int roll = rng() % (labelled ? 88 : 100);
+        if (roll < 45) line += std::string(MEMORY[rng() % std::size(MEMORY)]) + "     " + (rng() % 6 ? "" : "&") + target;
+        else if (roll < 55) line += std::string(rng() % 2 ? "jmp     " : "jsp     ") + (rng() % 2 ? "1b" : "1f");
+        else if (roll < 65) line += std::string(OTHERS[rng() % std::size(OTHERS)]);
+        else if (roll < 73) line += std::string(SHIFTS[rng() % std::size(SHIFTS)]) + "     #" + std::to_string(1 + rng() % 9);
+        else if (roll < 80) line += "law     #" + std::to_string(rng() % 4096);
+        else if (roll < 88) line += ".fill   " + std::to_string(static_cast<int>(rng() % 262143) - 131071);
+        else if (roll < 93) line += "twice   " + target;
+        else if (roll < 97) line += ". scratch " + std::to_string(generated);
+        else line += ".space  " + std::to_string(1 + rng() % 3);
+        source.emplace_back(line);
+    }
+
+    // the labels the generated code refers to but did not get to, and a final 1 for "1f"
+    for (unsigned int i = (generated + ASMBENCH_LABEL_EVERY - 1) / ASMBENCH_LABEL_EVERY; i < labels; ++i) {
+        source.emplace_back(label(i) + ":      hlt");
+    }
+    source.emplace_back("1:          hlt");
+    return source;
+}
+
+int main(int argc, char** argv) {
+    unsigned int lines = ASMBENCH_LINES;
+    unsigned int repeat = ASMBENCH_REPEAT;
+
+    option long_options[] = {
+        {"lines", required_argument, nullptr, 'n'},
+        {"repeat", required_argument, nullptr, 'r'},
+        {nullptr, 0, nullptr, 0}
+    };
+
+    int c;
+    while ((c = getopt_long(argc, argv, "n:r:", long_options, nullptr)) != -1) {
+        switch (c) {
+        case 'n':
+            lines = std::stoul(optarg);
+            break;
+        case 'r':
+            repeat = std::stoul(optarg);
+            if (repeat == 0) usage();
+            break;
+        default:
+            usage();
+        }
+    }
+    if (argc - optind > 1) usage();
+
+    std::vector<std::string> source;
+    std::string name;
+    if (optind < argc) {
+        std::ifstream infile(argv[optind]);
+        if (!infile) {
+            std::cout << argv[optind] << ": cannot open\n";
+            return 1;
+        }
+        source = readSource(infile);
+        name = argv[optind];
+    } else {
+        source = generateSource(lines);
+        name = "generated";
+    }
+
+    double best = 0;
+    size_t words = 0;
+    for (unsigned int r = 0; r < repeat; ++r) {
+        auto start = std::chrono::steady_clock::now();
+        AssembledProgram program = assembleSource(source);
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        if (r == 0 || elapsed.count() < best) best = elapsed.count();
+        words = program.words;
+    }
+
+    std::cout << name << ": " << source.size() << " lines, " << words << " words, best of " << repeat << " runs "
+              << best * 1e3 << " ms, " << static_cast<uint64_t>(source.size() / best) << " lines/s\n";
+}
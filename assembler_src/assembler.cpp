@@ -4,10 +4,22 @@
 // A custom assembler for the PDP-1, inspired by the MIT PDP-1 Assembler and modern assemblers
 //
 // Assembler CLI
-// ./assembler INFILE [OUTFILE]
+// ./assembler [--binary] [--symbols FILE] INFILE [OUTFILE]
+// ./assembler --object INFILE [OUTFILE]
 //
 // Writes (annotated) punched tape in ASCII art format to the output file!
 //
+// Flags:
+//   -b / --binary: writes a compact binary tape image instead (see common_src/TapeFormat.hpp).
+//                  The simulator detects the format automatically.
+//   -s / --symbols <FILE>: also writes a symbol map to FILE, one "<octal address> <label>" line per
+//                  label, for labelling simulator profiles (simulator --symbols).
+//   -c / --object: writes a relocatable object file (see ObjectFile.hpp) instead of a tape, for one
+//                  file of a program split over several. Symbolic labels are shared by all of the
+//                  program's files, so the file may refer to labels that another one defines; numeric
+//                  labels and macros stay within their file. The linker puts the objects together into
+//                  a tape, so after a change only the changed files need assembling again.
+//
 // Assembly syntax
 //
 // Instruction lines:
@@ -40,108 +52,85 @@
 // - .fill  <N>
 //   Inserts the 18-bit one's complement value <N>
 // - .space <k>
-//   Inserts k entries of +0s. (0o000000)
+//   Inserts k entries of +0s. (0o000000) They are punched as one run record rather than k words.
 // - .macro <name> [<arg1> <arg2>...]
-//   Defines a macro with the provided name and arguments. Macro names and parameters are alphanumeric strings. To avoid opcodes getting replaced, avoid utilizing short lowercase parameter names.
+//   Defines a macro with the provided name and arguments. Macro names and parameters are alphanumeric strings. A parameter is replaced wherever it makes up a whole name in a label or operand of the body (never in an opcode or directive).
+//   A macro is invoked as "<name> <operand1> <operand2>...", with exactly one operand per argument. Its body may use any directive and invoke other macros, nested up to 64 deep.
 // - .endmacro
 //   Signifies the end of a macro
 //
 
-#include <bitset>
 #include <fstream>
 #include <getopt.h>
 #include <iostream>
+#include <optional>
 #include <stdlib.h>
 #include <string>
 #include <vector>
 
-#include "LineParser.hpp"
-#include "LabelResolver.hpp"
-#include "InstructionAssembler.hpp"
-#include "DirectiveResolver.hpp"
-#include "DirectiveAssembler.hpp"
+#include "Assembler.hpp"
+#include "ObjectFile.hpp"
 #include "TapeWriter.hpp"
 
 void usage() {
     std::cout << "Usage:\n"
-              << "./assembler INFILE [OUTFILE]\n";
+              << "./assembler [--binary] [--symbols FILE] INFILE [OUTFILE]\n"
+              << "./assembler --object INFILE [OUTFILE]\n";
     exit(0);
 }
 
 int main(int argc, char** argv) {
-    if (argc < 2 || argc > 3) usage();
-
-    std::ifstream infile(argv[1]);
-    std::optional<std::string> outfile;
-    if (argc == 3) outfile = argv[2];
-    std::string line = "";
-
-    std::vector<std::string> allLines;
-    std::vector<std::string> preprocessedLines;
-
-    while (getline(infile, line)) {
-#ifdef DEBUG
-        std::cout << "Read line: " << line << std::endl;
-#endif
-        if (line == "") break;
-        allLines.emplace_back(line);
-    }
-
-    std::vector<LineType> parsedLines;
-    LabelResolver resolver;
-
-    // 1st pass: note down macros
-
-    auto macros = searchMacros(allLines);
-
-    // 2nd pass: resolve multi-line directives (macros, space)
-
-    preprocessedLines = resolveDirectives(allLines, macros);
-
-#ifdef DEBUG
-    for (auto prep : preprocessedLines) {
-        std::cout << "Preprocessed line: " << prep << std::endl;
+    TapeFormat format = TapeFormat::ASCII;
+    std::optional<std::string> symbolFile;
+    bool object = false;
+
+    option long_options[] = {
+        {"binary", no_argument, nullptr, 'b'},
+        {"symbols", required_argument, nullptr, 's'},
+        {"object", no_argument, nullptr, 'c'},
+        {nullptr, 0, nullptr, 0}
+    };
+
+    int c;
+    while ((c = getopt_long(argc, argv, "bs:c", long_options, nullptr)) != -1) {
+        switch (c) {
+        case 'b':
+            format = TapeFormat::BINARY;
+            break;
+        case 's':
+            symbolFile = optarg;
+            break;
+        case 'c':
+            object = true;
+            break;
+        default:
+            usage();
+        }
     }
-#endif
-
-    // 3rd pass: note down labels and addresses
 
-    for (unsigned int i = 0; i < size(preprocessedLines); ++i) {
-        std::string l = preprocessedLines[i];
+    int positional = argc - optind;
+    if (positional < 1 || positional > 2) usage();
+    if (object && (format == TapeFormat::BINARY || symbolFile)) usage();
 
-        LineType parsed = parseLine(l, i);
-        parsedLines.emplace_back(parsed);
+    std::ifstream infile(argv[optind]);
+    std::optional<std::string> outfile;
+    if (positional == 2) outfile = argv[optind + 1];
 
-        if (std::holds_alternative<InstructionLine>(parsed)) {
-            InstructionLine il = std::get<InstructionLine>(parsed);
+    AssembledProgram program = assembleSource(readSource(infile), object);
 
-            if (il.label) {
-                resolver.addLabel({il.label.value(), i});
-            }
-        } else if (std::holds_alternative<DirectiveLine>(parsed)) {
-            DirectiveLine dl = std::get<DirectiveLine>(parsed);
-            if (dl.label) {
-                resolver.addLabel({dl.label.value(), i});
-            }
+    if (object) {
+        if (outfile) {
+            std::ofstream os(outfile.value());
+            writeObject(os, program);
         } else {
-            std::cerr << "Something went wrong :(" << std::endl;
+            writeObject(std::cout, program);
         }
-
-        // there should be no macro invocations at this stage
+        return 0;
     }
 
-    // 4th pass: resolve hanging labels and assemble to MC
-
-    std::vector<std::bitset<18>> machineCode;
-
-    for (LineType parsed : parsedLines) {
-        if (std::holds_alternative<InstructionLine>(parsed)) {
-            std::bitset<18> mc = assembleInstruction(std::get<InstructionLine>(parsed), resolver);
-            machineCode.emplace_back(mc);
-        } else {
-            std::bitset<18> mc = assembleDirective(std::get<DirectiveLine>(parsed), resolver);
-            machineCode.emplace_back(mc);
-        }
+    if (symbolFile) {
+        std::ofstream symbols(symbolFile.value());
+        program.labels.writeSymbols(symbols);
     }
 
     // Print out machine code as tape!
@@ -149,13 +138,13 @@ int main(int argc, char** argv) {
     TapeWriter *writer = nullptr;
     std::ofstream *os = nullptr;
     if (outfile) {
-        os = new std::ofstream(outfile.value());
-        writer = new TapeWriter(*os);
+        os = new std::ofstream(outfile.value(), std::ios::binary);
+        writer = new TapeWriter(*os, format);
     } else {
-        writer = new TapeWriter(std::cout);
+        writer = new TapeWriter(std::cout, format);
     }
 
-    for (int i = 0; i < size(machineCode); ++i) writer->writeWord(machineCode[i], preprocessedLines[i]);
+    writeProgram(program, *writer);
     if (os) delete os;
     delete writer;
 
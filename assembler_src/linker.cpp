@@ -0,0 +1,116 @@
+//
+// PDP-1 Assembler
+// Object file linker
+//
+// Linker CLI
+// ./linker [--binary] [--symbols FILE] [--output OUTFILE] OBJFILE...
+//
+// Puts the object files written by assembler --object together into one program, placing them
+// one after another from address 0 in the order given, and writes it as (annotated) punched tape,
+// exactly as the assembler would have for the program in a single file. Every symbolic label
+// referred to must be defined in exactly one of the files.
+//
+// A program split over several files builds incrementally: assemble each file into an object
+// (independently, so in parallel with make -j), then link. After a change, only the changed files
+// need assembling again, e.g.
+//   %.o1: %.pdp1
+//       ./assembler --object $< $@
+//   prog.tape: main.o1 lib.o1
+//       ./linker --output $@ $^
+//
+// Flags:
+//   -b / --binary: writes a compact binary tape image instead (see common_src/TapeFormat.hpp).
+//   -s / --symbols <FILE>: also writes a symbol map of the linked program to FILE, as assembler
+//                  --symbols does.
+//   -o / --output <FILE>: writes the tape to FILE rather than to stdout.
+//
+
+#include <fstream>
+#include <getopt.h>
+#include <iostream>
+#include <optional>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+#include "Assembler.hpp"
+#include "LabelResolver.hpp"
+#include "ObjectFile.hpp"
+#include "TapeWriter.hpp"
+
+void usage() {
+    std::cout << "Usage:\n"
+              << "./linker [--binary] [--symbols FILE] [--output OUTFILE] OBJFILE...\n";
+    exit(1);
+}
+
+int main(int argc, char** argv) {
+    TapeFormat format = TapeFormat::ASCII;
+    std::optional<std::string> symbolFile;
+    std::optional<std::string> outfile;
+
+    option long_options[] = {
+        {"binary", no_argument, nullptr, 'b'},
+        {"symbols", required_argument, nullptr, 's'},
+        {"output", required_argument, nullptr, 'o'},
+        {nullptr, 0, nullptr, 0}
+    };
+
+    int c;
+    while ((c = getopt_long(argc, argv, "bs:o:", long_options, nullptr)) != -1) {
+        switch (c) {
+        case 'b':
+            format = TapeFormat::BINARY;
+            break;
+        case 's':
+            symbolFile = optarg;
+            break;
+        case 'o':
+            outfile = optarg;
+            break;
+        default:
+            usage();
+        }
+    }
+    if (optind == argc) usage();
+
+    AssembledProgram program;
+    try {
+        std::vector<AssembledProgram> objects;
+        for (int i = optind; i < argc; ++i) {
+            std::ifstream infile(argv[i]);
+            if (!infile) {
+                std::cerr << argv[i] << ": cannot open" << std::endl;
+                return 1;
+            }
+            objects.push_back(readObject(infile, argv[i]));
+        }
+        program = linkObjects(objects);
+    } catch (const ObjectFormatError &e) {
+        std::cerr << e.error << std::endl;
+        return 1;
+    } catch (const LabelResolver::DuplicateLabelError &e) {
+        std::cerr << "Label " << e.label << " is defined in more than one place" << std::endl;
+        return 1;
+    } catch (const LabelResolver::UndefinedLabelError &e) {
+        std::cerr << "Label " << e.label << " is not defined in any file" << std::endl;
+        return 1;
+    } catch (const LabelResolver::InvalidLabelError &e) {
+        std::cerr << "Invalid label " << e.label << ": " << e.reason << std::endl;
+        return 1;
+    }
+
+    if (symbolFile) {
+        std::ofstream symbols(symbolFile.value());
+        program.labels.writeSymbols(symbols);
+    }
+
+    if (outfile) {
+        std::ofstream os(outfile.value(), std::ios::binary);
+        TapeWriter writer(os, format);
+        writeProgram(program, writer);
+    } else {
+        TapeWriter writer(std::cout, format);
+        writeProgram(program, writer);
+    }
+}
@@ -0,0 +1,57 @@
+#!/bin/sh
+#
+# Parallel ASCII tape decoding: every tape make check loads is far smaller than one chunk
+# (TAPE_CHUNK_MIN in simulator_src/TapeReader.hpp), so this builds simulators that cut tapes into
+# chunks of a few bytes on several threads, which start partway through records, resynchronize and
+# get stitched back together, and checks that they load the same memory as a single-thread build.
+# Covers the example tapes, one ending in a truncated record, one with a malformed record in the
+# middle, one missing a line in the middle, after which every record is out of step, and one whose
+# data rows 6 and 5 read like the "8 O O O" / "7" feed rows that start a record. That last tape is
+# still well formed, but chunks resynchronize on the false record starts, so their words must be
+# thrown away and the chunks decoded again from the real boundaries.
+#
+
+set -e
+cd "$(dirname "$0")/.."
+
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+
+# only TapeReader.cpp reads the two settings; the rest comes from the regular build
+others=$(ls simulator_src/*.o | grep -v -e '\.dbg\.o' -e TapeReader.o -e PDPEnsemble.o -e PDPBatch.o -e PDPCosim.o)
+build() {
+    g++ -std=c++17 -O3 -Wall -Werror -pthread "$@" -c simulator_src/TapeReader.cpp -o "$tmp/TapeReader.o"
+    g++ -std=c++17 -O3 -Wall -Werror -pthread $others "$tmp/TapeReader.o" simulator_src/simulator.cpp -o "$tmp/simulator"
+}
+build -DTAPE_THREADS=1
+mv "$tmp/simulator" "$tmp/single"
+build -DTAPE_CHUNK_MIN=1 -DTAPE_THREADS=7
+mv "$tmp/simulator" "$tmp/tiny"
+build -DTAPE_CHUNK_MIN=64 -DTAPE_THREADS=4
+mv "$tmp/simulator" "$tmp/small"
+
+# the last record cut off after its annotation line, the third record's feed row spoilt, a data row
+# of the third record dropped, and false record starts in every record
+lines=$(wc -l < examples/break_extend.tape)
+head -n $((lines - 3)) examples/break_extend.tape > "$tmp/truncated.tape"
+awk '/^8 O O O$/ && ++n == 3 { print "8 O O ."; next } { print }' examples/break_extend.tape > "$tmp/malformed.tape"
+awk '/^8 O O O$/ { ++n } n == 3 && /^3 / { next } { print }' examples/break_extend.tape > "$tmp/shifted.tape"
+sed -e 's/^6 .*/8 O O O/' -e 's/^5 .*/7      /' examples/break_extend.tape > "$tmp/decoy.tape"
+
+status=0
+for tape in examples/*.tape "$tmp/truncated.tape" "$tmp/malformed.tape" "$tmp/shifted.tape" "$tmp/decoy.tape"; do
+    # one instruction, so the memory digest is (nearly) that of the loaded image
+    "$tmp/single" --batch --max-instructions 1 --summary - "$tape" > "$tmp/expected" 2> "$tmp/expected.err"
+    result=ok
+    for variant in tiny small; do
+        "$tmp/$variant" --batch --max-instructions 1 --summary - "$tape" > "$tmp/actual" 2> "$tmp/actual.err"
+        if ! cmp -s "$tmp/expected" "$tmp/actual" || ! cmp -s "$tmp/expected.err" "$tmp/actual.err"; then
+            result="LOADS DIFFERENTLY ($variant)"
+            diff "$tmp/expected" "$tmp/actual" || true
+            diff "$tmp/expected.err" "$tmp/actual.err" || true
+            status=1
+        fi
+    done
+    echo "$(basename "$tape"): $result"
+done
+exit $status
@@ -0,0 +1,38 @@
+#!/bin/sh
+#
+# --display frame patterns: a filename with a % must hold exactly one %d or %0Nd, with %% for a
+# literal %. Anything else is refused with a message rather than handed to printf, and the accepted
+# patterns create the first frame's file under the expected name.
+#
+
+set -e
+cd "$(dirname "$0")/.."
+
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+
+status=0
+for pattern in 'x%s%s%s%s.ppm' '100%.ppm' 'f%d%d.ppm' 'f%%.ppm' 'f%00d.ppm' 'f%5d.ppm' 'f%'; do
+    if ./simulator --batch --display "$tmp/$pattern" examples/loop.tape > /dev/null 2> "$tmp/err"; then
+        echo "$pattern: ACCEPTED"
+        status=1
+    elif ! grep -q 'frame pattern' "$tmp/err"; then
+        echo "$pattern: NO MESSAGE"
+        cat "$tmp/err"
+        status=1
+    else
+        echo "$pattern: refused"
+    fi
+done
+
+for pair in 'f%d.ppm f0.ppm' 'f%05d.ppm f00000.ppm' 'g%d-100%%.ppm g0-100%.ppm'; do
+    set -- $pair
+    ./simulator --batch --display "$tmp/$1" examples/loop.tape > /dev/null
+    if [ -f "$tmp/$2" ]; then
+        echo "$1: ok"
+    else
+        echo "$1: NO $2"
+        status=1
+    fi
+done
+exit $status
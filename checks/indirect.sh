@@ -0,0 +1,53 @@
+#!/bin/sh
+#
+# Indirect read-modify-write instructions: idx, isp, dap and dip through a one-hop chain must walk it
+# once, like lac, so they take the same cycles and the profile counts the same single hop for them.
+# The op is written out with .fill as an instruction word with the indirect bit (010000) and address
+# 3; word 3 is the pointer 010004, which leads to word 4. isp skips, so the op is followed by two
+# hlts. Runs on each engine.
+#
+
+set -e
+cd "$(dirname "$0")/.."
+
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+
+# prints "CYCLES HOPS" for the op with opcode bits $1 (octal, leading 0), run on engine $2
+measure() {
+    # .fill takes a signed decimal, so a word with bit 17 set is written as its negative
+    word=$(($1 + 010003))
+    if [ $word -ge $((0400000)) ]; then word=$((word - 0777777)); fi
+    cat > "$tmp/op.pdp1" <<END
+            .fill   $word
+            hlt
+            hlt
+            .fill   $((010004))
+            .fill   5
+END
+    ./assembler "$tmp/op.pdp1" "$tmp/op.tape" > /dev/null
+    ./simulator --batch --engine $2 --profile "$tmp/op.prof" "$tmp/op.tape" > "$tmp/op.out" 2> /dev/null
+    cycles=$(sed -n 's/^CYC: *\([0-9]*\) .*/\1/p' "$tmp/op.out")
+    hops=$(awk '$1 == "000000" { print $(NF - 1) }' "$tmp/op.prof")
+    echo "$cycles $hops"
+}
+
+status=0
+for engine in interp cached jit; do
+    want=$(measure 0200000 $engine)
+    if [ "$want" != "4 1" ]; then
+        echo "$engine lac: WRONG TIMING ($want, want 4 cycles and 1 hop)"
+        status=1
+        continue
+    fi
+    for op in idx:0440000 isp:0460000 dap:0260000 dip:0300000; do
+        got=$(measure ${op#*:} $engine)
+        if [ "$got" = "$want" ]; then
+            echo "$engine ${op%:*}: ok"
+        else
+            echo "$engine ${op%:*}: WRONG TIMING ($got, want $want as for lac)"
+            status=1
+        fi
+    done
+done
+exit $status
@@ -0,0 +1,12 @@
+#!/bin/sh
+#
+# Batch ensembles: every lane of an N-lane ensemble must end exactly as the same job run on its own
+# does, i.e. batch --lanes N and --lanes 1 must write the same rows. Runs the example tapes and random
+# programs through cosim --lanes, on the AVX2 kernels and then on the scalar fallback.
+#
+
+set -e
+cd "$(dirname "$0")/.."
+
+./cosim --lanes 8 --max-instructions 20000 --random 300 examples/*.tape
+./cosim --engine interp --lanes 8 --max-instructions 20000 --random 300 examples/*.tape
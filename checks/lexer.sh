@@ -0,0 +1,34 @@
+#!/bin/sh
+#
+# Assembler lexer: the single-pass lexer must keep assembling every example exactly as the regex line
+# parser it replaced did. checks/expected holds the ASCII tape, binary tape and symbol map of each
+# example; this compares the current assembler's output with them byte for byte.
+#
+# The expected files are the regex parser's output, except where a later change altered the tape
+# formats on purpose: binary tapes are version 2 and a .space is a run record (see
+# common_src/TapeFormat.hpp). After another deliberate format change, regenerate them with
+#   ./assembler --symbols checks/expected/X.sym examples/X.pdp1 checks/expected/X.tape
+#   ./assembler --binary examples/X.pdp1 checks/expected/X.bin
+#
+
+set -e
+cd "$(dirname "$0")/.."
+
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+
+status=0
+for f in examples/*.pdp1; do
+    name=$(basename "$f" .pdp1)
+    ./assembler --symbols "$tmp/$name.sym" "$f" "$tmp/$name.tape" > /dev/null
+    ./assembler --binary "$f" "$tmp/$name.bin" > /dev/null
+    result=ok
+    for ext in tape bin sym; do
+        if ! cmp -s "checks/expected/$name.$ext" "$tmp/$name.$ext"; then
+            result="DIFFERS ($ext)"
+            status=1
+        fi
+    done
+    echo "$f: $result"
+done
+exit $status
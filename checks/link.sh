@@ -0,0 +1,58 @@
+#!/bin/sh
+#
+# Linker: a program split over two files, assembled into objects and linked, must come out exactly as
+# the same program assembled from one file. Compares the ASCII tapes, binary tapes and symbol maps
+# byte for byte. The files refer to each other's labels both ways and both have a numeric label 1.
+#
+
+set -e
+cd "$(dirname "$0")/.."
+
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+
+cat > "$tmp/main.pdp1" <<'END'
+            .macro  ADD2    X
+            add     X
+            add     X
+            .endmacro
+start:      lac     #0
+1:          add     step
+            ADD2    step
+            isp     count
+            jmp     1b
+            dac     total
+            jmp     double
+back:       hlt
+count:      .fill   -5
+            .space  3
+END
+cat > "$tmp/lib.pdp1" <<'END'
+double:     lac     total
+1:          add     total
+            dac     total
+            jmp     back
+            .space  2
+step:       .fill   3
+total:      .fill   0
+END
+cat "$tmp/main.pdp1" "$tmp/lib.pdp1" > "$tmp/whole.pdp1"
+
+./assembler --symbols "$tmp/whole.sym" "$tmp/whole.pdp1" "$tmp/whole.tape" > /dev/null
+./assembler --binary "$tmp/whole.pdp1" "$tmp/whole.bin" > /dev/null
+./assembler --object "$tmp/main.pdp1" "$tmp/main.o1" > /dev/null
+./assembler --object "$tmp/lib.pdp1" "$tmp/lib.o1" > /dev/null
+./linker --symbols "$tmp/linked.sym" --output "$tmp/linked.tape" "$tmp/main.o1" "$tmp/lib.o1" > /dev/null
+./linker --binary --output "$tmp/linked.bin" "$tmp/main.o1" "$tmp/lib.o1" > /dev/null
+
+status=0
+for ext in tape bin sym; do
+    if cmp -s "$tmp/whole.$ext" "$tmp/linked.$ext"; then
+        echo "$ext: ok"
+    else
+        echo "$ext: DIFFERS"
+        diff "$tmp/whole.$ext" "$tmp/linked.$ext" || true
+        status=1
+    fi
+done
+exit $status
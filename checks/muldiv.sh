@@ -0,0 +1,81 @@
+#!/bin/sh
+#
+# mul and div (the Type 10 multiply/divide option) as instructions: a negative product with its -0
+# high half, a negative dividend leaving a negative quotient and remainder and skipping, and a
+# quotient overflow and a division by -0 that leave AC and IO alone and do not skip. The program halts
+# at pass only if every result is right; it runs on each engine. The arithmetic itself is checked
+# case by case by the static_asserts in simulator_src/PDPWord.hpp.
+#
+
+set -e
+cd "$(dirname "$0")/.."
+
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+
+cat > "$tmp/muldiv.pdp1" <<'END'
+            cla
+            cma
+            dac     mzero
+            lac     three
+            mul     mfive
+            sas     mzero
+            jmp     fail
+            dio     t
+            lac     t
+            sas     m30
+            jmp     fail
+            lac     mzero
+            lio     m70
+            div     six
+            jmp     fail
+            sas     mfive
+            jmp     fail
+            dio     t
+            lac     t
+            sas     mfive
+            jmp     fail
+            lac     six
+            lio     three
+            div     six
+            jmp     1f
+            jmp     fail
+1:          sas     six
+            jmp     fail
+            dio     t
+            lac     t
+            sas     three
+            jmp     fail
+            lac     zero
+            lio     three
+            div     mzero
+            jmp     1f
+            jmp     fail
+1:          sas     zero
+            jmp     fail
+pass:       hlt
+fail:       hlt
+zero:       .fill   0
+three:      .fill   3
+six:        .fill   6
+mfive:      .fill   -5
+m30:        .fill   -30
+m70:        .fill   -70
+mzero:      .fill   0
+t:          .fill   0
+END
+./assembler --symbols "$tmp/muldiv.sym" "$tmp/muldiv.pdp1" "$tmp/muldiv.tape" > /dev/null
+pass=$((0$(grep ' pass$' "$tmp/muldiv.sym" | cut -d' ' -f1)))
+
+status=0
+for engine in interp cached jit; do
+    ./simulator --batch --engine $engine --summary - "$tmp/muldiv.tape" > "$tmp/summary"
+    if grep -q "\"pc\": $pass," "$tmp/summary"; then
+        echo "$engine: ok"
+    else
+        echo "$engine: WRONG RESULT"
+        cat "$tmp/summary"
+        status=1
+    fi
+done
+exit $status
@@ -0,0 +1,65 @@
+#!/bin/sh
+#
+# .space runs: a run longer than one tape record holds (TAPE_ASCII_RUN_MAX, TAPE_BINARY_RUN_MAX in
+# common_src/TapeFormat.hpp) is split over several, and the loader must put the pieces back together.
+# The real limits are larger than core, so this builds an assembler with both lowered to 5 and
+# checks that its ASCII and binary tapes, the regular assembler's tapes and a tape with every zero
+# spelt out as .fill 0 all load the same memory.
+#
+
+set -e
+cd "$(dirname "$0")/.."
+
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+
+g++ -std=c++17 -O3 -Wall -Werror -DTAPE_ASCII_RUN_MAX=5 -DTAPE_BINARY_RUN_MAX=5 \
+    $(ls assembler_src/*.cpp | grep -v -e linker.cpp -e asmbench.cpp) -o "$tmp/assembler"
+
+# runs of 12 (5 + 5 + 2), 5 (exactly one record) and 6 (5 + 1) zeros
+cat > "$tmp/space.pdp1" <<'END'
+            hlt
+            .space  12
+            .fill   7
+            .space  5
+            .fill   3
+            .space  6
+            .fill   -1
+END
+{
+    echo "            hlt"
+    for i in $(seq 12); do echo "            .fill   0"; done
+    echo "            .fill   7"
+    for i in $(seq 5); do echo "            .fill   0"; done
+    echo "            .fill   3"
+    for i in $(seq 6); do echo "            .fill   0"; done
+    echo "            .fill   -1"
+} > "$tmp/zeros.pdp1"
+
+"$tmp/assembler" "$tmp/space.pdp1" "$tmp/split.tape" > /dev/null
+"$tmp/assembler" --binary "$tmp/space.pdp1" "$tmp/split.bin" > /dev/null
+./assembler "$tmp/space.pdp1" "$tmp/whole.tape" > /dev/null
+./assembler --binary "$tmp/space.pdp1" "$tmp/whole.bin" > /dev/null
+./assembler "$tmp/zeros.pdp1" "$tmp/zeros.tape" > /dev/null
+
+# 6 run records, and a binary tape of the header and 4 words and 6 runs
+runs=$(grep -c '^7 O' "$tmp/split.tape")
+bytes=$(wc -c < "$tmp/split.bin")
+if [ "$runs" -ne 6 ] || [ "$bytes" -ne 56 ]; then
+    echo "runs not split: $runs ASCII run records, $bytes byte binary tape"
+    exit 1
+fi
+
+./simulator --batch --summary - "$tmp/zeros.tape" > "$tmp/expected"
+status=0
+for tape in split.tape split.bin whole.tape whole.bin; do
+    ./simulator --batch --summary - "$tmp/$tape" > "$tmp/actual"
+    if cmp -s "$tmp/expected" "$tmp/actual"; then
+        echo "$tape: ok"
+    else
+        echo "$tape: LOADS DIFFERENTLY"
+        diff "$tmp/expected" "$tmp/actual" || true
+        status=1
+    fi
+done
+exit $status
@@ -0,0 +1,31 @@
+#!/bin/sh
+#
+# Trace writer: a trace that decodes must hold every instruction the run retired, and a trace file
+# whose writes fail (/dev/full) must be reported on stderr rather than left silently truncated.
+#
+
+set -e
+cd "$(dirname "$0")/.."
+
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+
+status=0
+./simulator --batch --max-instructions 100000 --trace "$tmp/bench.trace" examples/bench.tape > /dev/null
+if [ "$(./tracedump --quiet "$tmp/bench.trace")" = "100000 instructions" ]; then
+    echo "bench.trace: ok"
+else
+    echo "bench.trace: WRONG LENGTH"
+    status=1
+fi
+
+for n in 10 100000; do
+    ./simulator --batch --max-instructions $n --trace /dev/full examples/bench.tape > /dev/null 2> "$tmp/err"
+    if grep -q '/dev/full: could not write trace' "$tmp/err"; then
+        echo "/dev/full, $n instructions: reported"
+    else
+        echo "/dev/full, $n instructions: NOT REPORTED"
+        status=1
+    fi
+done
+exit $status
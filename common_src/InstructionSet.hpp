@@ -0,0 +1,235 @@
+//
+// PDP-1 Assembler and Simulator
+// Instruction Set
+//
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <string_view>
+
+// The one definition of the assembler's mnemonics. The assembler encodes instructions from it by
+// mnemonic, and the simulator's disassembler (and so traces, profiles and the monitor) decodes
+// words with it.
+
+enum class InstructionClass : uint8_t {
+    MEMORY,     // <mnemonic> (&)<label or #address>; cal and jda include the indirect bit
+    LAW,        // law #N, N in 13-bit one's complement
+    SHIFT,      // <mnemonic> #N, shifting N places (a mask of N ones)
+    SKIP,       // skp / skpn c1|c2|..., conditions from SKIP_CONDITIONS
+    SWITCH,     // szs #N, sense switch N (0-7)
+    FLAG,       // szf / clf / stf #N, program flag N (0-7)
+    FIXED       // no operand: single condition skips, operate and in-out transfer instructions
+};
+
+struct InstructionInfo {
+    std::string_view    mnemonic;
+    InstructionClass    kind;
+    uint32_t            bits;       // the instruction word with its operand 0
+    uint32_t            mask;       // the bits of a word that identify the instruction
+};
+
+struct SkipCondition {
+    std::string_view    name;
+    uint32_t            bits;
+};
+
+#define INSTRUCTION_OPCODE_MASK 0760000
+#define INSTRUCTION_SHIFT_MASK  0777000
+#define INSTRUCTION_SKIP_MASK   0770077
+#define INSTRUCTION_EXACT_MASK  0777777
+
+// the skip group ignores bit 04000 of its operand
+#define INSTRUCTION_SKIP_EXACT_MASK 0773777
+
+// Decoding takes the first entry (in this order) whose mask and bits match, so overlapping
+// entries go most specific first: szf before szs before the single condition skips before
+// skp / skpn, and nop before clf / stf.
+inline constexpr InstructionInfo INSTRUCTION_SET[] = {
+    {"add",  InstructionClass::MEMORY, 0400000, INSTRUCTION_OPCODE_MASK},
+    {"sub",  InstructionClass::MEMORY, 0420000, INSTRUCTION_OPCODE_MASK},
+    {"mul",  InstructionClass::MEMORY, 0540000, INSTRUCTION_OPCODE_MASK},
+    {"div",  InstructionClass::MEMORY, 0560000, INSTRUCTION_OPCODE_MASK},
+    {"idx",  InstructionClass::MEMORY, 0440000, INSTRUCTION_OPCODE_MASK},
+    {"isp",  InstructionClass::MEMORY, 0460000, INSTRUCTION_OPCODE_MASK},
+    {"and",  InstructionClass::MEMORY, 0020000, INSTRUCTION_OPCODE_MASK},
+    {"xor",  InstructionClass::MEMORY, 0060000, INSTRUCTION_OPCODE_MASK},
+    {"ior",  InstructionClass::MEMORY, 0040000, INSTRUCTION_OPCODE_MASK},
+    {"lac",  InstructionClass::MEMORY, 0200000, INSTRUCTION_OPCODE_MASK},
+    {"dac",  InstructionClass::MEMORY, 0240000, INSTRUCTION_OPCODE_MASK},
+    {"dap",  InstructionClass::MEMORY, 0260000, INSTRUCTION_OPCODE_MASK},
+    {"dip",  InstructionClass::MEMORY, 0300000, INSTRUCTION_OPCODE_MASK},
+    {"lio",  InstructionClass::MEMORY, 0220000, INSTRUCTION_OPCODE_MASK},
+    {"dio",  InstructionClass::MEMORY, 0320000, INSTRUCTION_OPCODE_MASK},
+    {"dzm",  InstructionClass::MEMORY, 0340000, INSTRUCTION_OPCODE_MASK},
+    {"xct",  InstructionClass::MEMORY, 0100000, INSTRUCTION_OPCODE_MASK},
+    {"jmp",  InstructionClass::MEMORY, 0600000, INSTRUCTION_OPCODE_MASK},
+    {"jsp",  InstructionClass::MEMORY, 0620000, INSTRUCTION_OPCODE_MASK},
+    {"cal",  InstructionClass::MEMORY, 0160000, 0770000},
+    {"jda",  InstructionClass::MEMORY, 0170000, 0770000},
+    {"sad",  InstructionClass::MEMORY, 0500000, INSTRUCTION_OPCODE_MASK},
+    {"sas",  InstructionClass::MEMORY, 0520000, INSTRUCTION_OPCODE_MASK},
+
+    {"law",  InstructionClass::LAW,    0700000, INSTRUCTION_OPCODE_MASK},
+
+    {"rar",  InstructionClass::SHIFT,  0671000, INSTRUCTION_SHIFT_MASK},
+    {"ral",  InstructionClass::SHIFT,  0661000, INSTRUCTION_SHIFT_MASK},
+    {"sar",  InstructionClass::SHIFT,  0675000, INSTRUCTION_SHIFT_MASK},
+    {"sal",  InstructionClass::SHIFT,  0665000, INSTRUCTION_SHIFT_MASK},
+    {"rir",  InstructionClass::SHIFT,  0672000, INSTRUCTION_SHIFT_MASK},
+    {"ril",  InstructionClass::SHIFT,  0662000, INSTRUCTION_SHIFT_MASK},
+    {"sir",  InstructionClass::SHIFT,  0676000, INSTRUCTION_SHIFT_MASK},
+    {"sil",  InstructionClass::SHIFT,  0666000, INSTRUCTION_SHIFT_MASK},
+    {"rcr",  InstructionClass::SHIFT,  0673000, INSTRUCTION_SHIFT_MASK},
+    {"rcl",  InstructionClass::SHIFT,  0663000, INSTRUCTION_SHIFT_MASK},
+    {"scr",  InstructionClass::SHIFT,  0677000, INSTRUCTION_SHIFT_MASK},
+    {"scl",  InstructionClass::SHIFT,  0667000, INSTRUCTION_SHIFT_MASK},
+
+    {"szf",  InstructionClass::FLAG,   0640000, 0773770},
+    {"szs",  InstructionClass::SWITCH, 0640000, 0773707},
+    {"sza",  InstructionClass::FIXED,  0640100, INSTRUCTION_SKIP_EXACT_MASK},
+    {"spa",  InstructionClass::FIXED,  0640200, INSTRUCTION_SKIP_EXACT_MASK},
+    {"sma",  InstructionClass::FIXED,  0640400, INSTRUCTION_SKIP_EXACT_MASK},
+    {"szo",  InstructionClass::FIXED,  0641000, INSTRUCTION_SKIP_EXACT_MASK},
+    {"spi",  InstructionClass::FIXED,  0642000, INSTRUCTION_SKIP_EXACT_MASK},
+    {"snza", InstructionClass::FIXED,  0650100, INSTRUCTION_SKIP_EXACT_MASK},
+    {"snpa", InstructionClass::FIXED,  0650200, INSTRUCTION_SKIP_EXACT_MASK},
+    {"snma", InstructionClass::FIXED,  0650400, INSTRUCTION_SKIP_EXACT_MASK},
+    {"snzo", InstructionClass::FIXED,  0651000, INSTRUCTION_SKIP_EXACT_MASK},
+    {"snpi", InstructionClass::FIXED,  0652000, INSTRUCTION_SKIP_EXACT_MASK},
+    {"skp",  InstructionClass::SKIP,   0640000, INSTRUCTION_SKIP_MASK},
+    {"skpn", InstructionClass::SKIP,   0650000, INSTRUCTION_SKIP_MASK},
+
+    {"cli",  InstructionClass::FIXED,  0764000, INSTRUCTION_EXACT_MASK},
+    {"lat",  InstructionClass::FIXED,  0762000, INSTRUCTION_EXACT_MASK},
+    {"lap",  InstructionClass::FIXED,  0760100, INSTRUCTION_EXACT_MASK},
+    {"cma",  InstructionClass::FIXED,  0761000, INSTRUCTION_EXACT_MASK},
+    {"hlt",  InstructionClass::FIXED,  0760400, INSTRUCTION_EXACT_MASK},
+    {"cla",  InstructionClass::FIXED,  0760200, INSTRUCTION_EXACT_MASK},
+    {"nop",  InstructionClass::FIXED,  0760000, INSTRUCTION_EXACT_MASK},
+    {"clf",  InstructionClass::FLAG,   0760000, 0777770},
+    {"stf",  InstructionClass::FLAG,   0760010, 0777770},
+
+    // in-out transfer group; the ones with 010000 wait for the device
+    {"rpa",  InstructionClass::FIXED,  0730001, INSTRUCTION_EXACT_MASK},
+    {"rpb",  InstructionClass::FIXED,  0730002, INSTRUCTION_EXACT_MASK},
+    {"tyo",  InstructionClass::FIXED,  0730003, INSTRUCTION_EXACT_MASK},
+    {"tyi",  InstructionClass::FIXED,  0720004, INSTRUCTION_EXACT_MASK},
+    {"ppa",  InstructionClass::FIXED,  0730005, INSTRUCTION_EXACT_MASK},
+    {"ppb",  InstructionClass::FIXED,  0730006, INSTRUCTION_EXACT_MASK},
+    {"rrb",  InstructionClass::FIXED,  0720030, INSTRUCTION_EXACT_MASK},
+    {"dpy",  InstructionClass::FIXED,  0730007, INSTRUCTION_EXACT_MASK},
+    {"lsm",  InstructionClass::FIXED,  0720054, INSTRUCTION_EXACT_MASK},
+    {"esm",  InstructionClass::FIXED,  0720055, INSTRUCTION_EXACT_MASK},
+    {"cbs",  InstructionClass::FIXED,  0720056, INSTRUCTION_EXACT_MASK},
+};
+
+// skp / skpn conditions, in the order the disassembler lists them
+inline constexpr SkipCondition SKIP_CONDITIONS[] = {
+    {"za", 0100}, {"pa", 0200}, {"ma", 0400}, {"zo", 01000}, {"pi", 02000}
+};
+
+// Mnemonics are looked up by their (at most 4) characters packed into a key, multiplied and the
+// top bits taken as a slot; the multiplier is searched for at compile time so that no two
+// mnemonics share a slot, making a lookup one multiply, one load and one comparison.
+#define INSTRUCTION_HASH_BITS 10
+#define INSTRUCTION_HASH_SIZE (1 << INSTRUCTION_HASH_BITS)
+
+inline constexpr size_t INSTRUCTION_COUNT = std::size(INSTRUCTION_SET);
+static_assert(INSTRUCTION_COUNT < 256, "slots hold an 8-bit index");
+
+/**
+ * @return the mnemonic's characters packed into a key, or 0 if it cannot be one (empty or longer than 4)
+ */
+constexpr uint32_t mnemonicKey(std::string_view mnemonic) {
+    if (mnemonic.empty() || mnemonic.size() > 4) return 0;
+    uint32_t key = 0;
+    for (size_t i = 0; i < mnemonic.size(); ++i) key |= uint32_t{static_cast<uint8_t>(mnemonic[i])} << (8 * i);
+    return key;
+}
+
+constexpr uint32_t mnemonicSlot(uint32_t key, uint32_t multiplier) {
+    return (key * multiplier) >> (32 - INSTRUCTION_HASH_BITS);
+}
+
+constexpr bool isPerfectMultiplier(uint32_t multiplier) {
+    bool used[INSTRUCTION_HASH_SIZE] = {};
+    for (const InstructionInfo &info : INSTRUCTION_SET) {
+        uint32_t slot = mnemonicSlot(mnemonicKey(info.mnemonic), multiplier);
+        if (used[slot]) return false;
+        used[slot] = true;
+    }
+    return true;
+}
+
+constexpr uint32_t findPerfectMultiplier() {
+    uint32_t multiplier = 0x9e3779b1;
+    while (!isPerfectMultiplier(multiplier)) multiplier += 2;
+    return multiplier;
+}
+
+inline constexpr uint32_t MNEMONIC_MULTIPLIER = findPerfectMultiplier();
+
+// each slot holds 1 + the index of the mnemonic hashed to it, or 0
+constexpr std::array<uint8_t, INSTRUCTION_HASH_SIZE> buildMnemonicSlots() {
+    std::array<uint8_t, INSTRUCTION_HASH_SIZE> slots{};
+    for (size_t i = 0; i < INSTRUCTION_COUNT; ++i) {
+        slots[mnemonicSlot(mnemonicKey(INSTRUCTION_SET[i].mnemonic), MNEMONIC_MULTIPLIER)] = i + 1;
+    }
+    return slots;
+}
+
+inline constexpr std::array<uint8_t, INSTRUCTION_HASH_SIZE> MNEMONIC_SLOTS = buildMnemonicSlots();
+
+/**
+ * Looks up an instruction by mnemonic.
+ * @param mnemonic: the mnemonic, e.g. "lac"
+ * @return its entry in INSTRUCTION_SET, or nullptr if there is none
+ */
+inline const InstructionInfo *findInstruction(std::string_view mnemonic) {
+    uint32_t key = mnemonicKey(mnemonic);
+    if (!key) return nullptr;
+    uint8_t entry = MNEMONIC_SLOTS[mnemonicSlot(key, MNEMONIC_MULTIPLIER)];
+    if (!entry || INSTRUCTION_SET[entry - 1].mnemonic != mnemonic) return nullptr;
+    return &INSTRUCTION_SET[entry - 1];
+}
+
+// Words are decoded by their top 5 bits, which every mask includes: DECODE_INDEX lists the entries
+// of each of those 32 buckets, in table order, from start[bucket] to start[bucket + 1] of order.
+#define INSTRUCTION_BUCKET_SHIFT 13
+#define INSTRUCTION_BUCKETS      32
+
+struct InstructionDecodeIndex {
+    std::array<uint8_t, INSTRUCTION_COUNT>       order;
+    std::array<uint8_t, INSTRUCTION_BUCKETS + 1> start;
+};
+
+constexpr InstructionDecodeIndex buildDecodeIndex() {
+    InstructionDecodeIndex index{};
+    for (const InstructionInfo &info : INSTRUCTION_SET) ++index.start[(info.bits >> INSTRUCTION_BUCKET_SHIFT) + 1];
+    for (size_t b = 0; b < INSTRUCTION_BUCKETS; ++b) index.start[b + 1] += index.start[b];
+
+    std::array<uint8_t, INSTRUCTION_BUCKETS> next{};
+    for (size_t b = 0; b < INSTRUCTION_BUCKETS; ++b) next[b] = index.start[b];
+    for (size_t i = 0; i < INSTRUCTION_COUNT; ++i) index.order[next[INSTRUCTION_SET[i].bits >> INSTRUCTION_BUCKET_SHIFT]++] = i;
+    return index;
+}
+
+inline constexpr InstructionDecodeIndex DECODE_INDEX = buildDecodeIndex();
+
+/**
+ * Finds the instruction an 18-bit word encodes.
+ * @param word: the instruction word
+ * @return the first entry in INSTRUCTION_SET that matches it, or nullptr if none does
+ */
+inline const InstructionInfo *decodeInstruction(uint32_t word) {
+    unsigned int bucket = (word >> INSTRUCTION_BUCKET_SHIFT) & (INSTRUCTION_BUCKETS - 1);
+    for (unsigned int i = DECODE_INDEX.start[bucket]; i < DECODE_INDEX.start[bucket + 1]; ++i) {
+        const InstructionInfo &info = INSTRUCTION_SET[DECODE_INDEX.order[i]];
+        if ((word & info.mask) == info.bits) return &info;
+    }
+    return nullptr;
+}
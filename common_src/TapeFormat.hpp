@@ -0,0 +1,38 @@
+//
+// PDP-1 Assembler and Simulator
+// Binary Tape Format
+//
+
+#pragma once
+
+#include <cstdint>
+
+// A binary tape is a 16-byte header followed by one little-endian uint32_t per entry. An entry is
+// either an 18-bit word, in exactly the simulator's in-memory WORD layout, or (with bit 31 set) a
+// run of (entry & TAPE_BINARY_RUN_COUNT) zero words, as the assembler writes for .space. A tape
+// without runs can be copied straight into core.
+//
+//   bytes 0-7:   magic "PDP1TAPE"
+//   bytes 8-11:  format version (little-endian); version 1 tapes have no runs
+//   bytes 12-15: reserved, must be 0
+//
+// ASCII art tapes start with the "  3 2 1" header line, so the magic never collides with them.
+// Their records are one word each, except that a record with row 7 punched ("7 O    ") is a run
+// of zero words, its 18 bits holding the count.
+
+#define TAPE_BINARY_MAGIC       "PDP1TAPE"
+#define TAPE_BINARY_MAGIC_SIZE  8
+#define TAPE_BINARY_VERSION     2
+#define TAPE_BINARY_HEADER_SIZE 16
+
+#define TAPE_BINARY_RUN         0x80000000u
+#define TAPE_BINARY_RUN_COUNT   0x7fffffffu
+
+// longest run the assembler writes in one entry or record; longer runs take several. A build may
+// lower them (checks/space.sh does) to split runs on a tape small enough to load.
+#ifndef TAPE_BINARY_RUN_MAX
+#define TAPE_BINARY_RUN_MAX     TAPE_BINARY_RUN_COUNT
+#endif
+#ifndef TAPE_ASCII_RUN_MAX
+#define TAPE_ASCII_RUN_MAX      0777777
+#endif
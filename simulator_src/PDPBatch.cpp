@@ -0,0 +1,249 @@
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <map>
+#include <sstream>
+#include <thread>
+#include <tuple>
+
+#include "PDPBatch.hpp"
+
+#include "PDPEnsemble.hpp"
+#include "PDPState.hpp"
+#include "TapeReader.hpp"
+
+std::vector<PDPJob> parseJobList(std::istream &is) {
+    std::vector<PDPJob> jobs;
+    std::string line;
+    unsigned int lineNumber = 0;
+
+    while (std::getline(is, line)) {
+        ++lineNumber;
+        std::istringstream fields(line);
+        std::string tape, switches, memory, budget, extra;
+        if (!(fields >> tape) || tape[0] == '#') continue;
+
+        PDPJob job;
+        job.tapeFile = tape;
+        std::string error;
+        if (fields >> switches) {
+            std::optional<uint64_t> mask = parseNumber(switches);
+            if (!mask || mask.value() > 077) error = "bad sense switch mask \"" + switches + "\"";
+            else job.senseSwitches = mask.value();
+        }
+        if (error.empty() && fields >> memory) {
+            std::optional<unsigned int> size = parseMemorySize(memory);
+            if (!size) error = "bad memory size \"" + memory + "\"";
+            else job.memorySize = size.value();
+        }
+        if (error.empty() && fields >> budget) {
+            std::optional<uint64_t> n = parseNumber(budget);
+            if (!n) error = "bad budget \"" + budget + "\"";
+            else job.budget = n.value();
+        }
+        if (error.empty() && fields >> extra) error = "unexpected \"" + extra + "\"";
+
+        if (!error.empty()) throw JobListError{"line " + std::to_string(lineNumber) + ": " + error};
+        jobs.emplace_back(job);
+    }
+
+    return jobs;
+}
+
+void PDPJobQueue::push(size_t job) {
+    std::lock_guard<std::mutex> lock(mutex);
+    jobs.push_back(job);
+}
+
+std::optional<size_t> PDPJobQueue::pop() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (jobs.empty()) return {};
+    size_t job = jobs.front();
+    jobs.pop_front();
+    return job;
+}
+
+std::optional<size_t> PDPJobQueue::steal() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (jobs.empty()) return {};
+    size_t job = jobs.back();
+    jobs.pop_back();
+    return job;
+}
+
+struct TapeImage {
+    std::vector<WORD>   words;
+    std::string         error;      // set if the tape could not be loaded
+};
+
+static std::string jsonString(const std::string &s) {
+    std::string out = "\"";
+    for (char c : s) {
+        if (c == '"' || c == '\\') out += '\\';
+        if (static_cast<unsigned char>(c) < 0x20) continue;
+        out += c;
+    }
+    return out + "\"";
+}
+
+static std::string rowPrefix(size_t index, const PDPJob &job) {
+    std::ostringstream row;
+    row << "{\"job\": " << index
+        << ", \"tape\": " << jsonString(job.tapeFile)
+        << ", \"switches\": " << job.senseSwitches.to_ulong()
+        << ", \"memory\": " << job.memorySize
+        << ", \"budget\": " << job.budget;
+    return row.str();
+}
+
+static PDPSettings jobSettings(const PDPJob &job, const PDPSettings &base) {
+    PDPSettings settings = base;
+    settings.tapeFile = job.tapeFile;
+    settings.senseSwitches = job.senseSwitches;
+    settings.memory_size = job.memorySize;
+    settings.maxInstructions = job.budget;
+    settings.batch = true;
+    return settings;
+}
+
+/**
+ * Runs one job to completion.
+ * @return the job's result row, without a trailing newline
+ */
+static std::string runJob(size_t index, const PDPJob &job, const PDPSettings &base, const TapeImage &image, bool &failed) {
+    std::ostringstream row;
+    row << rowPrefix(index, job);
+
+    failed = true;
+    if (!image.error.empty()) {
+        row << ", \"error\": " << jsonString(image.error) << "}";
+        return row.str();
+    }
+
+    try {
+        PDPProcessor proc(jobSettings(job, base), image.words);
+        proc.run();
+        row << ", ";
+        proc.writeSummaryFields(row);
+        failed = proc.haltReason() == PDPHaltReason::ILLEGAL || proc.haltReason() == PDPHaltReason::INDIRECT;
+    } catch (const TapeFormatError &e) {
+        row << ", \"error\": " << jsonString(e.error);
+    }
+    row << "}";
+    return row.str();
+}
+
+/**
+ * Runs jobs that share a tape, memory size and budget as the lanes of one PDPEnsemble.
+ * @return one result row per job, as runJob
+ */
+static std::vector<std::string> runEnsemble(const std::vector<size_t> &indices, const std::vector<PDPJob> &jobs, const PDPSettings &base, const TapeImage &image, size_t &failed) {
+    std::vector<std::string> rows;
+    const PDPJob &first = jobs[indices[0]];
+
+    try {
+        PDPEnsemble ensemble(jobSettings(first, base), indices.size(), image.words);
+        for (unsigned int lane = 0; lane < indices.size(); ++lane) ensemble.setSenseSwitches(lane, jobs[indices[lane]].senseSwitches);
+        ensemble.run();
+
+        for (unsigned int lane = 0; lane < indices.size(); ++lane) {
+            std::ostringstream row;
+            row << rowPrefix(indices[lane], jobs[indices[lane]]) << ", ";
+            ensemble.writeSummaryFields(lane, row);
+            row << "}";
+            rows.emplace_back(row.str());
+            PDPHaltReason reason = ensemble.haltReason(lane);
+            if (reason == PDPHaltReason::ILLEGAL || reason == PDPHaltReason::INDIRECT) ++failed;
+        }
+    } catch (const TapeFormatError &e) {
+        for (size_t index : indices) rows.emplace_back(rowPrefix(index, jobs[index]) + ", \"error\": " + jsonString(e.error) + "}");
+        failed += indices.size();
+    }
+    return rows;
+}
+
+size_t runBatch(const std::vector<PDPJob> &jobs, const PDPSettings &base, unsigned int threads, unsigned int lanes, std::ostream &os) {
+    // load each distinct tape once, at the largest memory size any job could use
+    std::map<std::string, TapeImage> images;
+    for (const PDPJob &job : jobs) {
+        if (images.count(job.tapeFile)) continue;
+        TapeImage &image = images[job.tapeFile];
+        image.words.resize(MAX_MEMORY_SIZE);
+        try {
+            image.words.resize(loadTape(job.tapeFile, image.words.data(), image.words.size()));
+        } catch (const TapeFormatError &e) {
+            image.words.clear();
+            image.error = e.error;
+        }
+    }
+
+    // a task is a single job, or with lanes > 1 up to that many jobs that differ only in their sense switches
+    std::vector<std::vector<size_t>> tasks;
+    std::map<std::tuple<std::string, unsigned int, uint64_t>, size_t> open;
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        const PDPJob &job = jobs[i];
+        if (lanes <= 1 || !images.at(job.tapeFile).error.empty()) {
+            tasks.push_back({i});
+            continue;
+        }
+        auto key = std::make_tuple(job.tapeFile, job.memorySize, job.budget);
+        auto it = open.find(key);
+        if (it == open.end() || tasks[it->second].size() == lanes) {
+            open[key] = tasks.size();
+            tasks.push_back({i});
+        } else {
+            tasks[it->second].push_back(i);
+        }
+    }
+
+    if (threads == 0) threads = std::thread::hardware_concurrency();
+    threads = std::max<size_t>(1, std::min<size_t>(threads, tasks.size()));
+
+    // deal the tasks out round-robin, so the first few rows are ready early on every worker
+    std::vector<PDPJobQueue> queues(threads);
+    for (size_t i = 0; i < tasks.size(); ++i) queues[i % threads].push(i);
+
+    std::mutex outputMutex;
+    std::vector<std::optional<std::string>> rows(jobs.size());
+    size_t nextRow = 0;
+    std::atomic<size_t> failures{0};
+
+    auto worker = [&](unsigned int self) {
+        while (true) {
+            std::optional<size_t> task = queues[self].pop();
+            for (unsigned int k = 1; !task && k < threads; ++k) task = queues[(self + k) % threads].steal();
+            // tasks never spawn tasks, so once every queue is empty the worker is done
+            if (!task) return;
+
+            const std::vector<size_t> &indices = tasks[task.value()];
+            const TapeImage &image = images.at(jobs[indices[0]].tapeFile);
+            std::vector<std::string> done;
+            size_t failed = 0;
+            if (lanes <= 1 || !image.error.empty()) {
+                bool jobFailed = false;
+                done.emplace_back(runJob(indices[0], jobs[indices[0]], base, image, jobFailed));
+                failed = jobFailed;
+            } else {
+                done = runEnsemble(indices, jobs, base, image, failed);
+            }
+            failures += failed;
+
+            std::lock_guard<std::mutex> lock(outputMutex);
+            for (size_t k = 0; k < indices.size(); ++k) rows[indices[k]] = std::move(done[k]);
+            while (nextRow < rows.size() && rows[nextRow]) {
+                os << rows[nextRow].value() << "\n";
+                rows[nextRow].reset();
+                ++nextRow;
+            }
+            os.flush();
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (unsigned int i = 1; i < threads; ++i) pool.emplace_back(worker, i);
+    worker(0);
+    for (std::thread &t : pool) t.join();
+
+    return failures;
+}
@@ -0,0 +1,76 @@
+//
+// PDP-1 Simulator
+// Multi-Core Batch Runner
+//
+
+#pragma once
+
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "PDPSettings.hpp"
+
+struct PDPJob {
+    std::string     tapeFile;
+    std::bitset<6>  senseSwitches;
+    unsigned int    memorySize  = 4096;
+    uint64_t        budget      = 0;    // 0 = run until the machine stops
+};
+
+struct JobListError {
+    std::string                error;
+};
+
+/**
+ * Parses a job list: one job per line, as whitespace-separated fields
+ *   TAPE [SWITCHES [MEMORY [BUDGET]]]
+ * SWITCHES is a mask with bit 0 = sense switch 1 (decimal, 0x hex or 0 octal, default 0),
+ * MEMORY is any --mem value (default 4K) and BUDGET is an instruction budget (default none).
+ * Blank lines and lines starting with '#' are ignored.
+ * @throws JobListError naming the offending line
+ */
+std::vector<PDPJob> parseJobList(std::istream &is);
+
+/**
+ * Per-worker job queue. The owner takes jobs from the front, in job order, so rows can be written
+ * early; idle workers steal from the back, taking the jobs their victim would have reached last.
+ */
+class PDPJobQueue {
+
+private:
+
+    std::mutex mutex;
+    std::deque<size_t> jobs;
+
+public:
+
+    void push(size_t job);
+
+    std::optional<size_t> pop();
+
+    std::optional<size_t> steal();
+
+};
+
+/**
+ * Runs every job on a pool of worker threads, each with its own PDPProcessor per job. Each
+ * distinct tape is loaded once and shared read-only between the workers. Writes one JSON row per
+ * job to os, in job order, as soon as the job and all jobs before it have finished:
+ *   {"job": N, "tape": ..., "switches": ..., "memory": ..., "budget": ..., <summary fields>}
+ * or {"job": N, ..., "error": "..."} if the job's tape could not be loaded.
+ * @param jobs: the jobs to run
+ * With lanes > 1, jobs with the same tape, memory size and budget run together as the lanes of
+ * PDPEnsembles of up to that many lanes instead; the rows are the same either way.
+ * @param base: settings shared by every job (engine, extend mode, time limit)
+ * @param threads: number of worker threads (0 for one per hardware thread)
+ * @param lanes: maximum ensemble size (0 or 1 to run every job on its own PDPProcessor)
+ * @return the number of jobs that failed to load or stopped on an illegal instruction
+ */
+size_t runBatch(const std::vector<PDPJob> &jobs, const PDPSettings &base, unsigned int threads, unsigned int lanes, std::ostream &os);
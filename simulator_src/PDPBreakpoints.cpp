@@ -0,0 +1,77 @@
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <vector>
+
+#include "PDPBreakpoints.hpp"
+
+void PDPBreakpoints::resize(unsigned int memorySize) {
+    flags.assign(memorySize, 0);
+    conditions.assign(memorySize, PDPBreakCondition{});
+    armedCount = 0;
+}
+
+void PDPBreakpoints::setFlags(unsigned int addr, uint8_t newFlags) {
+    if (!flags[addr] && newFlags) ++armedCount;
+    if (flags[addr] && !newFlags) --armedCount;
+    flags[addr] = newFlags;
+}
+
+void PDPBreakpoints::setBreak(unsigned int addr, const PDPBreakCondition &condition) {
+    conditions[addr] = condition;
+    setFlags(addr, flags[addr] | BREAK_EXEC);
+}
+
+void PDPBreakpoints::setWatch(unsigned int addr, uint8_t mask) {
+    setFlags(addr, flags[addr] | (mask & (BREAK_READ | BREAK_WRITE)));
+}
+
+void PDPBreakpoints::clear(unsigned int addr) {
+    conditions[addr] = PDPBreakCondition{};
+    setFlags(addr, 0);
+}
+
+void PDPBreakpoints::clearAll() {
+    std::fill(flags.begin(), flags.end(), 0);
+    std::fill(conditions.begin(), conditions.end(), PDPBreakCondition{});
+    armedCount = 0;
+}
+
+bool PDPBreakpoints::conditionHolds(unsigned int addr, WORD ac, WORD io, PDPRegister<6> pf) const {
+    const PDPBreakCondition &c = conditions[addr];
+    uint32_t value;
+    switch (c.reg) {
+    case PDPBreakRegister::NONE: return true;
+    case PDPBreakRegister::AC:   value = ac.value; break;
+    case PDPBreakRegister::IO:   value = io.value; break;
+    case PDPBreakRegister::PF:   value = pf.value; break;
+    default:                     return true;
+    }
+    return (value == c.value) == c.equal;
+}
+
+void PDPBreakpoints::list(std::ostream &os) const {
+    static const char *registers[] = {"", "ac", "io", "pf"};
+
+    char line[80];
+    for (unsigned int addr = 0; addr < flags.size(); ++addr) {
+        if (!flags[addr]) continue;
+        if (flags[addr] & BREAK_EXEC) {
+            const PDPBreakCondition &c = conditions[addr];
+            if (c.reg == PDPBreakRegister::NONE) {
+                snprintf(line, sizeof(line), "break  %06o\n", addr);
+            } else {
+                snprintf(line, sizeof(line), "break  %06o if %s %s %06o\n", addr,
+                         registers[static_cast<int>(c.reg)], c.equal ? "==" : "!=", c.value);
+            }
+            os << line;
+        }
+        if (flags[addr] & (BREAK_READ | BREAK_WRITE)) {
+            const char *mode = (flags[addr] & BREAK_READ) ? ((flags[addr] & BREAK_WRITE) ? "rw" : "r") : "w";
+            snprintf(line, sizeof(line), "watch  %06o %s\n", addr, mode);
+            os << line;
+        }
+    }
+}
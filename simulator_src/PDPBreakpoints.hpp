@@ -0,0 +1,94 @@
+//
+// PDP-1 Simulator
+// Breakpoints and Watchpoints
+//
+
+#pragma once
+
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+#include "PDPWord.hpp"
+
+// PDPBreakpoints flag bits, also used as PDPBreakHit::kind
+#define BREAK_EXEC  0x01    // stop before executing the instruction at this address
+#define BREAK_READ  0x02    // stop after an instruction reads an operand from this address
+#define BREAK_WRITE 0x04    // stop after an instruction writes an operand to this address
+
+enum class PDPBreakRegister {
+    NONE,   // unconditional
+    AC,
+    IO,
+    PF
+};
+
+/**
+ * Condition on an execute breakpoint: the register compared with value when the PC reaches it.
+ */
+struct PDPBreakCondition {
+    PDPBreakRegister    reg   = PDPBreakRegister::NONE;
+    bool                equal = true;   // stop if reg == value, otherwise if reg != value
+    uint32_t            value = 0;
+};
+
+/**
+ * Why the processor stopped. kind is 0 while nothing has fired.
+ */
+struct PDPBreakHit {
+    uint8_t         kind = 0;       // BREAK_EXEC, BREAK_READ or BREAK_WRITE
+    unsigned int    pc   = 0;       // instruction that was about to run (EXEC) or that touched addr
+    unsigned int    addr = 0;       // breakpoint or watched address
+};
+
+/**
+ * Breakpoints and watchpoints, as one flag byte per core memory address, so checking an address
+ * is a single load. Conditions live in a parallel array and are only looked at once the flag is set.
+ */
+class PDPBreakpoints {
+
+private:
+
+    std::vector<uint8_t> flags;
+    std::vector<PDPBreakCondition> conditions;
+    unsigned int armedCount = 0;    // addresses with any flag set
+
+    void setFlags(unsigned int addr, uint8_t newFlags);
+
+public:
+
+    void resize(unsigned int memorySize);
+
+    uint8_t at(unsigned int addr) const { return flags[addr]; }
+
+    bool armed() const { return armedCount != 0; }
+
+    /**
+     * Sets (or replaces) the execute breakpoint at addr.
+     */
+    void setBreak(unsigned int addr, const PDPBreakCondition &condition);
+
+    /**
+     * Adds a watchpoint at addr.
+     * @param mask: BREAK_READ, BREAK_WRITE or both
+     */
+    void setWatch(unsigned int addr, uint8_t mask);
+
+    /**
+     * Removes every breakpoint and watchpoint at addr.
+     */
+    void clear(unsigned int addr);
+
+    void clearAll();
+
+    /**
+     * @return true if the execute breakpoint at addr should stop the machine with these registers
+     */
+    bool conditionHolds(unsigned int addr, WORD ac, WORD io, PDPRegister<6> pf) const;
+
+    /**
+     * Writes one line per armed address, lowest address first.
+     */
+    void list(std::ostream &os) const;
+
+};
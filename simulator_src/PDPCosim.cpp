@@ -0,0 +1,253 @@
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <sstream>
+#include <stdio.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "PDPCosim.hpp"
+
+#include "PDPDisassembler.hpp"
+#include "PDPEnsemble.hpp"
+
+#define DIGEST_MULTIPLIER 0x9e3779b97f4a7c15ULL
+
+static uint64_t mix(uint64_t hash, uint64_t value) {
+    hash = (hash ^ value) * DIGEST_MULTIPLIER;
+    return hash ^ (hash >> 32);
+}
+
+uint64_t stateDigest(const PDPState &state) {
+    uint64_t flags = state.pc.value
+                   | uint64_t{state.pf.value} << 16
+                   | uint64_t{state.overflow} << 22
+                   | uint64_t{state.extend} << 23
+                   | uint64_t{state.sequenceBreak} << 24
+                   | uint64_t{state.breakRequest} << 25
+                   | uint64_t{state.inBreak} << 26
+                   | uint64_t{state.running} << 27
+                   | uint64_t{static_cast<unsigned int>(state.halt)} << 28;
+
+    uint64_t hash = mix(0, flags);
+    hash = mix(hash, state.ac.value | uint64_t{state.io.value} << 18);
+    hash = mix(hash, state.retired);
+    hash = mix(hash, state.cycles);
+
+    // a polynomial hash per lane: with an odd multiplier, any single differing word changes it
+    uint64_t lanes[4] = {1, 2, 3, 4};
+    size_t size = state.cm.size();
+    size_t a = 0;
+    for (; a + 4 <= size; a += 4) {
+        for (int l = 0; l < 4; ++l) lanes[l] = (lanes[l] + state.cm[a + l].value) * DIGEST_MULTIPLIER;
+    }
+    for (; a < size; ++a) lanes[0] = (lanes[0] + state.cm[a].value) * DIGEST_MULTIPLIER;
+
+    for (uint64_t lane : lanes) hash = mix(hash, lane);
+    return hash;
+}
+
+static std::string registers(const PDPState &state) {
+    char text[192];
+    snprintf(text, sizeof(text), "pc %06o  ac %06o  io %06o  pf %02o  ov %d  ex %d  sbs %d%d%d  instructions %llu  cycles %llu  %s",
+             state.pc.value, state.ac.value, state.io.value, state.pf.value, state.overflow, state.extend,
+             state.sequenceBreak, state.breakRequest, state.inBreak,
+             static_cast<unsigned long long>(state.retired), static_cast<unsigned long long>(state.cycles),
+             haltReasonName(state.halt));
+    return text;
+}
+
+/**
+ * Both machines' registers, and where their memories differ.
+ */
+static std::string describe(const PDPState &reference, const PDPState &candidate) {
+    std::ostringstream os;
+    os << "  reference  " << registers(reference) << "\n"
+       << "  candidate  " << registers(candidate) << "\n";
+
+    size_t differing = 0;
+    size_t first = 0;
+    for (size_t a = 0; a < reference.cm.size(); ++a) {
+        if (reference.cm[a] != candidate.cm[a] && differing++ == 0) first = a;
+    }
+    if (differing) {
+        char text[128];
+        snprintf(text, sizeof(text), "  memory     %zu word%s differ, first at %06zo: reference %06o, candidate %06o\n",
+                 differing, differing == 1 ? "" : "s", first, reference.cm[first].value, candidate.cm[first].value);
+        os << text;
+    }
+    return os.str();
+}
+
+static std::string listing(unsigned int pc, uint32_t instr) {
+    char text[64];
+    snprintf(text, sizeof(text), "%06o  %06o  ", pc, instr);
+    return text + disassemble(instr);
+}
+
+/**
+ * Replays the run from the last matching checkpoint, stepping the candidate on its own.
+ * @param good: the last checkpoint at which the states matched
+ * @param target: the checkpoint at which they did not
+ * @param mismatch: the description of the states at target, for a mismatch steps do not reproduce
+ */
+static std::string localize(const PDPSettings &reference, const PDPSettings &candidate, const std::vector<WORD> &image,
+                            uint64_t good, uint64_t target, const std::string &mismatch) {
+    PDPProcessor ref(reference, image);
+    PDPProcessor cand(candidate, image);
+    ref.runTo(good);
+    cand.runTo(good);
+    const PDPState &r = ref.machineState();
+    const PDPState &c = cand.machineState();
+
+    while (c.running && c.retired < target) {
+        uint64_t before = c.retired;
+        cand.step();
+
+        // bring the reference level one instruction at a time, noting what it ran
+        std::vector<std::pair<unsigned int, uint32_t>> ran;
+        while (r.running && r.retired < c.retired) {
+            if (ran.size() < COSIM_LISTING) ran.emplace_back(r.pc.value, r.cm[r.pc.value].value);
+            ref.runTo(r.retired + 1);
+        }
+        if (stateDigest(r) == stateDigest(c)) continue;
+
+        std::ostringstream os;
+        uint64_t span = c.retired - before;
+        if (span <= 1 && !ran.empty()) {
+            os << "after " << before << " instructions, " << listing(ran[0].first, ran[0].second) << "\n";
+        } else if (ran.empty()) {
+            os << "after " << before << " instructions, the reference had stopped\n";
+        } else {
+            os << "in a step of " << span << " instructions after " << before << ", which the reference ran as\n";
+            for (const auto &[pc, instr] : ran) os << "    " << listing(pc, instr) << "\n";
+        }
+        return os.str() + describe(r, c);
+    }
+
+    return "between " + std::to_string(good) + " and " + std::to_string(target) +
+           " instructions, only when run in whole chunks (e.g. a fast-forwarded idle loop)\n" + mismatch;
+}
+
+PDPCosimResult cosimulate(const PDPSettings &settings, const std::vector<WORD> &image, uint64_t every) {
+    PDPSettings reference = settings;
+    reference.engine = PDPEngine::INTERPRETER;
+    reference.fastForward = false;
+    uint64_t budget = settings.maxInstructions ? settings.maxInstructions : UINT64_MAX;
+
+    PDPCosimResult result;
+    PDPProcessor ref(reference, image);
+    PDPProcessor cand(settings, image);
+    const PDPState &r = ref.machineState();
+    const PDPState &c = cand.machineState();
+
+    uint64_t good = 0;
+    while (true) {
+        uint64_t target = good + std::min(every, budget - good);
+        ref.runTo(target);
+        cand.runTo(target);
+
+        if (stateDigest(r) != stateDigest(c)) {
+            result.diverged = true;
+            result.instructions = r.retired;
+            result.halt = r.halt;
+            result.report = localize(reference, settings, image, good, target, describe(r, c));
+            return result;
+        }
+        if (!r.running || target == budget) break;
+        good = target;
+    }
+
+    result.instructions = r.retired;
+    result.halt = r.running ? PDPHaltReason::BUDGET : r.halt;
+    return result;
+}
+
+std::string compareLanes(const PDPSettings &settings, const std::vector<WORD> &image, unsigned int lanes) {
+    // batch jobs attach no devices
+    PDPSettings job = settings;
+    job.clockPeriod = 0;
+
+    PDPEnsemble ensemble(job, lanes, image);
+    for (unsigned int lane = 0; lane < lanes; ++lane) ensemble.setSenseSwitches(lane, 011 * lane);
+    ensemble.run();
+
+    for (unsigned int lane = 0; lane < lanes; ++lane) {
+        PDPSettings single = job;
+        single.senseSwitches = 011 * lane;
+        PDPProcessor proc(single, image);
+        proc.run();
+
+        std::ostringstream alone, together;
+        proc.writeSummaryFields(alone);
+        ensemble.writeSummaryFields(lane, together);
+        if (alone.str() != together.str()) {
+            return "lane " + std::to_string(lane) + " of " + std::to_string(lanes) + "\n"
+                 + "  alone     " + alone.str() + "\n"
+                 + "  ensemble  " + together.str() + "\n";
+        }
+    }
+    return "";
+}
+
+// one's complement values at the edges of add, sub, idx, isp, mul and div: +0, -0, +1, -1, the largest
+// positive and negative numbers and their neighbours
+static const uint32_t EDGE_VALUES[] = {0, 0777777, 1, 0777776, 0377777, 0400000, 0377776, 0400001};
+
+// every memory reference instruction
+static const unsigned int MEMORY_OPCODES[] = {
+    002, 004, 006, 010, 016, 020, 022, 024, 026, 030, 032, 034,
+    040, 042, 044, 046, 050, 052, 054, 056, 060, 062
+};
+
+static const unsigned int SHIFT_OPCODES[] = {
+    0661, 0662, 0663, 0665, 0666, 0667, 0671, 0672, 0673, 0675, 0676, 0677
+};
+
+// nop, cli, lap, cma, cla
+static const unsigned int OPERATE_CODES[] = {00000, 04000, 00100, 01000, 00200};
+
+// lsm, esm, cbs
+static const unsigned int BREAK_IOTS[] = {0720054, 0720055, 0720056};
+
+template <class T, size_t N>
+static T pick(std::mt19937_64 &rng, const T (&values)[N]) {
+    return values[rng() % N];
+}
+
+static uint32_t randomInstruction(std::mt19937_64 &rng) {
+    uint32_t indirect = rng() % 8 == 0 ? 0010000 : 0;
+    unsigned int roll = rng() % 100;
+
+    if (roll < 60) {
+        unsigned int opcode = pick(rng, MEMORY_OPCODES);
+        // jumps and xct go to code, most other references to data, the rest anywhere
+        unsigned int y = opcode == 060 || opcode == 062 || opcode == 010 ? rng() % COSIM_CODE_WORDS
+                       : rng() % 4 ? COSIM_CODE_WORDS + rng() % (COSIM_PROGRAM_WORDS - COSIM_CODE_WORDS)
+                       : rng() % COSIM_PROGRAM_WORDS;
+        return opcode << 12 | indirect | y;
+    }
+    if (roll < 70) return 0640000 | (rng() % 2 ? 0010000 : 0) | (rng() & 07777);
+    if (roll < 80) return pick(rng, SHIFT_OPCODES) << 9 | (rng() & 0777);
+    if (roll < 86) return 0760000 | pick(rng, OPERATE_CODES);
+    // stf / clf
+    if (roll < 88) return 0760000 | (rng() % 2 ? 010 : 0) | (1 + rng() % 7);
+    if (roll < 96) return 0700000 | indirect | (rng() & 07777);
+    if (roll < 98) return pick(rng, BREAK_IOTS);
+    return 0760400;
+}
+
+std::vector<WORD> randomProgram(std::mt19937_64 &rng) {
+    std::vector<WORD> image(COSIM_PROGRAM_WORDS);
+    for (unsigned int a = 0; a < COSIM_PROGRAM_WORDS; ++a) {
+        WORD &w = image[a];
+        unsigned int roll = rng() % 100;
+        if (a < COSIM_CODE_WORDS) w = randomInstruction(rng);
+        else if (roll < 50) w = pick(rng, EDGE_VALUES);
+        else if (roll < 70) w = randomInstruction(rng);
+        else w = rng() & MINUS_ZERO;
+    }
+    return image;
+}
@@ -0,0 +1,84 @@
+//
+// PDP-1 Simulator
+// Engine Co-Simulation
+//
+
+#pragma once
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "PDPSettings.hpp"
+#include "PDPState.hpp"
+#include "PDPWord.hpp"
+
+// default instructions between state comparisons
+#define COSIM_EVERY 4096
+
+// random programs are this many words, placed at address 0: code, then data (and pointers)
+#define COSIM_PROGRAM_WORDS 256
+#define COSIM_CODE_WORDS    192
+
+// longest JIT block the divergence report lists instruction by instruction
+#define COSIM_LISTING JIT_MAX_BLOCK
+
+/**
+ * The outcome of running one program on the reference interpreter and a candidate engine.
+ */
+struct PDPCosimResult {
+    bool            diverged        = false;
+    uint64_t        instructions    = 0;    // retired by the reference
+    PDPHaltReason   halt            = PDPHaltReason::RUNNING;
+    std::string     report;                 // what differed and where, if diverged
+};
+
+/**
+ * 64-bit digest of the architectural state: PC, AC, IO, program flags, overflow, extend mode,
+ * the sequence break flags, the instruction and cycle counts, whether and why the machine
+ * stopped, and core memory. Memory is hashed a word at a time in four independent lanes, so a
+ * checkpoint costs about a cycle per word.
+ */
+uint64_t stateDigest(const PDPState &state);
+
+/**
+ * Runs image on the reference interpreter (no fast-forwarding) and on the engine in settings side
+ * by side, comparing stateDigest every `every` instructions until both stop or settings'
+ * instruction budget is spent.
+ *
+ * On a mismatch, both machines are rebuilt and run to the last matching checkpoint, then the
+ * candidate is stepped on its own (one instruction, or one translated block with the JIT) and the
+ * reference brought level after each step, until their states differ. The report names that
+ * instruction (or block, listing the instructions the reference ran in it) with both machines'
+ * registers and the first differing memory word. A mismatch that does not show up step by step
+ * comes from the run loop itself (e.g. a fast-forwarded idle loop) and is reported as the span
+ * between the two checkpoints.
+ *
+ * @param settings: candidate settings; the reference uses the same ones with the interpreter
+ * @param image: words to place at address 0 onwards
+ * @param every: instructions between comparisons
+ * @throws TapeFormatError if the image does not fit in memory
+ */
+PDPCosimResult cosimulate(const PDPSettings &settings, const std::vector<WORD> &image, uint64_t every);
+
+/**
+ * Runs image as the lanes of one PDPEnsemble, lane k with sense switches 011 * k, and each lane's
+ * job again on a PDPProcessor of its own, as batch --lanes N and --lanes 1 would, comparing their
+ * summary fields. Like batch jobs, neither has a clock.
+ * @param settings: settings shared by every lane (engine, memory size, budget, extend mode)
+ * @param image: words to place at address 0 onwards
+ * @param lanes: number of lanes
+ * @return the first lane whose summaries differ and both summaries, or an empty string if all match
+ * @throws TapeFormatError if the image does not fit in memory
+ */
+std::string compareLanes(const PDPSettings &settings, const std::vector<WORD> &image, unsigned int lanes);
+
+/**
+ * Generates a random program of COSIM_PROGRAM_WORDS words. The code is mostly memory reference,
+ * skip, shift, operate and law instructions, with a few halts and sequence break IOTs; jumps land
+ * in the code and most other operands in the data, which is biased towards the one's complement
+ * edge cases (+0, -0, +-1 and the largest magnitudes) that add, sub, idx, isp, mul and div treat
+ * specially, with some instruction words for indirect chains and xct.
+ */
+std::vector<WORD> randomProgram(std::mt19937_64 &rng);
@@ -0,0 +1,112 @@
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <string>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "PDPDevices.hpp"
+
+// how long the feed and drain threads sleep when there is nothing to do
+#define DEVICE_IDLE_MS 1
+
+PDPHostInput::PDPHostInput(const std::string &filename) : ring(DEVICE_RING_SIZE) {
+    fd = filename == "-" ? STDIN_FILENO : open(filename.c_str(), O_RDONLY);
+    if (fd < 0) throw DeviceError{filename + ": " + std::strerror(errno)};
+
+    struct stat st;
+    file = fstat(fd, &st) == 0 && S_ISREG(st.st_mode);
+
+    feeder = std::thread(&PDPHostInput::feed, this);
+}
+
+PDPHostInput::~PDPHostInput() {
+    closing.store(true, std::memory_order_release);
+    feeder.join();
+    if (fd != STDIN_FILENO) close(fd);
+}
+
+void PDPHostInput::feed() {
+    while (!closing.load(std::memory_order_acquire)) {
+        uint64_t h = head.load(std::memory_order_relaxed);
+        uint64_t space = DEVICE_RING_SIZE - (h - tail.load(std::memory_order_acquire));
+        if (space == 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(DEVICE_IDLE_MS));
+            continue;
+        }
+
+        // wait with a timeout, so a quiet terminal does not hold up the destructor
+        pollfd p {fd, POLLIN, 0};
+        if (::poll(&p, 1, DEVICE_IDLE_MS) == 0) continue;
+
+        // fill up to the end of the ring, without wrapping
+        size_t at = h & (DEVICE_RING_SIZE - 1);
+        size_t room = std::min<uint64_t>(space, DEVICE_RING_SIZE - at);
+        ssize_t got = read(fd, ring.data() + at, room);
+        if (got < 0 && errno == EINTR) continue;
+        if (got <= 0) break;
+        head.store(h + got, std::memory_order_release);
+    }
+    ended.store(true, std::memory_order_release);
+}
+
+bool PDPHostInput::poll(uint8_t &byte) {
+    uint64_t t = tail.load(std::memory_order_relaxed);
+    if (t == head.load(std::memory_order_acquire)) return false;
+    byte = ring[t & (DEVICE_RING_SIZE - 1)];
+    tail.store(t + 1, std::memory_order_release);
+    return true;
+}
+
+bool PDPHostInput::take(uint8_t &byte) {
+    while (!poll(byte)) {
+        // read ended first: once it is set, head no longer moves
+        if (ended.load(std::memory_order_acquire)) return poll(byte);
+        std::this_thread::yield();
+    }
+    return true;
+}
+
+PDPHostOutput::PDPHostOutput(const std::string &filename) : ring(DEVICE_RING_SIZE) {
+    fd = filename == "-" ? STDOUT_FILENO : open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) throw DeviceError{filename + ": " + std::strerror(errno)};
+
+    drainer = std::thread(&PDPHostOutput::drain, this);
+}
+
+PDPHostOutput::~PDPHostOutput() {
+    closing.store(true, std::memory_order_release);
+    drainer.join();
+    if (fd != STDOUT_FILENO) close(fd);
+}
+
+void PDPHostOutput::drain() {
+    while (true) {
+        // read closing first: once it is set, head no longer moves
+        bool finishing = closing.load(std::memory_order_acquire);
+        uint64_t t = tail.load(std::memory_order_relaxed);
+        uint64_t h = head.load(std::memory_order_acquire);
+
+        if (t == h) {
+            if (finishing) break;
+            std::this_thread::sleep_for(std::chrono::milliseconds(DEVICE_IDLE_MS));
+            continue;
+        }
+
+        // write up to the end of the ring, without wrapping
+        size_t at = t & (DEVICE_RING_SIZE - 1);
+        size_t length = std::min<uint64_t>(h - t, DEVICE_RING_SIZE - at);
+        ssize_t put = write(fd, ring.data() + at, length);
+        if (put < 0 && errno == EINTR) continue;
+        // a closed pipe or full disk drops the output rather than stopping the machine
+        tail.store(t + (put > 0 ? put : length), std::memory_order_release);
+    }
+}
@@ -0,0 +1,149 @@
+//
+// PDP-1 Simulator
+// In-Out Devices
+//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "PDPTiming.hpp"
+
+// in-out transfer device codes (the low 6 bits of an IOT). With the i bit (010000) set, as in
+// the standard mnemonics rpa 730001, rpb 730002, tyo 730003, ppa 730005 and ppb 730006, the
+// processor waits for the device to finish; without it the device raises its program flag
+// and requests a sequence break when done.
+#define IOT_RPA 001     // read one paper tape line into IO
+#define IOT_RPB 002     // read one 18-bit word from three binary tape lines into IO
+#define IOT_TYO 003     // type the character in IO
+#define IOT_TYI 004     // IO = the last key struck, clearing its flag
+#define IOT_PPA 005     // punch the low 8 bits of IO as one line
+#define IOT_PPB 006     // punch IO as three binary lines
+#define IOT_RRB 030     // IO = the reader buffer, clearing its flag
+#define IOT_LSM 054     // sequence break system off
+#define IOT_ESM 055     // sequence break system on
+#define IOT_CBS 056     // clear a pending break request
+
+#define IOT_WAIT 0010000
+
+// program flags raised by the devices (numbered as for szf / stf / clf)
+#define FLAG_KEY        1   // a key was struck
+#define FLAG_READER     2   // the reader buffer holds a line or word
+#define FLAG_PUNCH      3   // the punch finished
+#define FLAG_TYPEOUT    4   // the typewriter finished
+
+// device speeds: reader 400 lines/s, punch 63 lines/s, typewriter 10 characters/s
+#define READER_CYCLES       (2500000 / CYCLE_NS)
+#define PUNCH_CYCLES        (15873000 / CYCLE_NS)
+#define TYPEWRITER_CYCLES   (100000000 / CYCLE_NS)
+
+// binary tape lines carry 6 bits of a word and a punch in the eighth hole
+#define BINARY_LINE 0200
+
+// bytes each host stream buffers ahead of (or behind) the simulator
+#define DEVICE_RING_SIZE (1 << 16)
+
+struct DeviceError {
+    std::string                error;
+};
+
+/**
+ * Bytes from a host file or stdin, read ahead by a background thread into a single-producer
+ * single-consumer ring buffer, so the simulator only ever touches memory.
+ */
+class PDPHostInput {
+
+private:
+
+    std::vector<uint8_t> ring;
+    alignas(64) std::atomic<uint64_t> head {0};     // next slot to fill, written by the feed thread
+    alignas(64) std::atomic<uint64_t> tail {0};     // next slot to read, written by the simulator
+    std::atomic<bool> ended {false};                // the feed thread reached end of file
+    std::atomic<bool> closing {false};
+
+    int fd;
+    bool file;
+    std::thread feeder;
+
+    void feed();
+
+public:
+
+    /**
+     * Opens the stream and starts the feed thread.
+     * @param filename: host file, or "-" for stdin
+     * @throws DeviceError if the file cannot be opened
+     */
+    PDPHostInput(const std::string &filename);
+
+    ~PDPHostInput();
+
+    PDPHostInput(const PDPHostInput &) = delete;
+    PDPHostInput &operator=(const PDPHostInput &) = delete;
+
+    /**
+     * @return true for a regular file, whose bytes are all there to be waited for
+     */
+    bool isFile() const { return file; }
+
+    /**
+     * Takes the next byte if one has arrived.
+     * @return false if none has (yet)
+     */
+    bool poll(uint8_t &byte);
+
+    /**
+     * Takes the next byte, waiting for the feed thread if it is behind.
+     * @return false at end of input
+     */
+    bool take(uint8_t &byte);
+
+};
+
+/**
+ * Bytes to a host file or stdout, written out by a background thread from a single-producer
+ * single-consumer ring buffer. push() only waits if the ring is full.
+ */
+class PDPHostOutput {
+
+private:
+
+    std::vector<uint8_t> ring;
+    alignas(64) std::atomic<uint64_t> head {0};     // next slot to fill, written by push()
+    alignas(64) std::atomic<uint64_t> tail {0};     // next slot to drain, written by the drain thread
+    std::atomic<bool> closing {false};
+
+    int fd;
+    std::thread drainer;
+
+    void drain();
+
+public:
+
+    /**
+     * Creates the file and starts the drain thread.
+     * @param filename: host file, or "-" for stdout
+     * @throws DeviceError if the file cannot be created
+     */
+    PDPHostOutput(const std::string &filename);
+
+    /**
+     * Writes out everything still in the ring and closes the file.
+     */
+    ~PDPHostOutput();
+
+    PDPHostOutput(const PDPHostOutput &) = delete;
+    PDPHostOutput &operator=(const PDPHostOutput &) = delete;
+
+    void push(uint8_t byte) {
+        uint64_t h = head.load(std::memory_order_relaxed);
+        while (h - tail.load(std::memory_order_acquire) == DEVICE_RING_SIZE) std::this_thread::yield();
+        ring[h & (DEVICE_RING_SIZE - 1)] = byte;
+        head.store(h + 1, std::memory_order_release);
+    }
+
+};
@@ -0,0 +1,62 @@
+
+#include <string>
+#include <string_view>
+
+#include "PDPDisassembler.hpp"
+
+#include "PDPWord.hpp"
+#include "../common_src/InstructionSet.hpp"
+
+static std::string fill(unsigned long instr) {
+    return ".fill   " + std::to_string(onesComplementToInt(WORD{instr}));
+}
+
+static std::string line(std::string_view mnemonic, const std::string &operand = "") {
+    std::string text(mnemonic);
+    if (!operand.empty()) {
+        text.resize(8, ' ');
+        text += operand;
+    }
+    return text;
+}
+
+std::string disassemble(unsigned long instr) {
+    const InstructionInfo *info = decodeInstruction(instr);
+    if (!info) return fill(instr);
+
+    std::string_view mnemonic = info->mnemonic;
+    bool indirect = instr & 0010000;
+    unsigned int y = instr & 07777;
+
+    switch (info->kind) {
+    case InstructionClass::MEMORY:
+        // cal and jda are told apart by the indirect bit
+        return line(mnemonic, (indirect && !(info->mask & 0010000) ? "&#" : "#") + std::to_string(y));
+
+    case InstructionClass::LAW:
+        return line(mnemonic, "#" + std::to_string(indirect ? -static_cast<int>(y) : static_cast<int>(y)));
+
+    case InstructionClass::SHIFT:
+        return line(mnemonic, "#" + std::to_string(__builtin_popcount(instr & 0777)));
+
+    case InstructionClass::SKIP:
+        {
+            std::string operand;
+            for (const SkipCondition &c : SKIP_CONDITIONS) {
+                if (!(y & c.bits)) continue;
+                if (!operand.empty()) operand += "|";
+                operand += c.name;
+            }
+            return line(mnemonic, operand);
+        }
+
+    case InstructionClass::SWITCH:
+        return line(mnemonic, "#" + std::to_string((y >> 3) & 07));
+
+    case InstructionClass::FLAG:
+        return line(mnemonic, "#" + std::to_string(y & 07));
+
+    default:
+        return line(mnemonic);
+    }
+}
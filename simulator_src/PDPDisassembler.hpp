@@ -0,0 +1,16 @@
+//
+// PDP-1 Simulator
+// Disassembler
+//
+
+#pragma once
+
+#include <string>
+
+/**
+ * Disassembles one instruction word into the assembler's syntax (e.g. "lac &#448", "rar #2",
+ * "skp za|pa"). Words the assembler has no mnemonic for come out as ".fill N".
+ * @param instr: 18-bit instruction word
+ * @return the instruction as a line of assembly, without a label
+ */
+std::string disassemble(unsigned long instr);
@@ -0,0 +1,191 @@
+
+#include <cerrno>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "PDPDisplay.hpp"
+
+// pixels tested at once when looking for dark parts of the screen (one uint64_t of shown)
+#define DISPLAY_GROUP 8
+
+static void writeAll(int fd, const uint8_t *data, size_t length) {
+    while (length) {
+        ssize_t put = write(fd, data, length);
+        if (put < 0 && errno == EINTR) continue;
+        // like the other host streams, a failed write drops output rather than stopping the machine
+        if (put <= 0) return;
+        data += put;
+        length -= put;
+    }
+}
+
+// a 10-bit one's complement coordinate, -511 (left / bottom) to +511 (right / top)
+static int coordinate(uint32_t bits) {
+    return (bits & 01000) ? -static_cast<int>(~bits & 0777) : static_cast<int>(bits);
+}
+
+PDPDisplay::PDPDisplay(const std::string &filename_in, unsigned int size_in, unsigned int fps)
+    : filename{filename_in}, size{size_in}, phosphor(size_in * size_in, 0), shown(size_in * size_in, 0), image(size_in * size_in * 3 + 1, 0) {
+    double frameUs = 1e6 / fps;
+    decay = static_cast<uint32_t>(std::lround(65536.0 * std::exp2(-frameUs / PHOSPHOR_HALF_LIFE_US)));
+    if (decay > 65535) decay = 65535;
+
+    // white where freshly lit, fading to green
+    for (uint32_t v = 0; v < 256; ++v) {
+        palette[v] = (v * v / 255) | (v << 8) | (((v + v * v / 255) / 2) << 16);
+    }
+
+    perFrame = filename.find('%') != std::string::npos;
+    raw = !perFrame && filename.size() >= 4 && filename.compare(filename.size() - 4, 4, ".rgb") == 0;
+
+    if (perFrame) {
+        parsePattern();
+        // check the first frame's file can be created
+        std::string name = frameName(0);
+        fd = open(name.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) throw DeviceError{name + ": " + std::strerror(errno)};
+        close(fd);
+        fd = -1;
+    } else {
+        fd = filename == "-" ? STDOUT_FILENO : open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) throw DeviceError{filename + ": " + std::strerror(errno)};
+    }
+
+    renderer = std::thread(&PDPDisplay::render, this);
+}
+
+void PDPDisplay::parsePattern() {
+    bool converted = false;
+    std::string *out = &framePrefix;
+    for (size_t i = 0; i < filename.size(); ++i) {
+        if (filename[i] != '%') {
+            *out += filename[i];
+            continue;
+        }
+        if (i + 1 < filename.size() && filename[i + 1] == '%') {
+            *out += '%';
+            ++i;
+            continue;
+        }
+        // %d or %0Nd (N from 1 to 20), once
+        size_t j = i + 1;
+        unsigned int width = 0;
+        bool padded = j < filename.size() && filename[j] == '0';
+        if (padded) {
+            for (++j; j < filename.size() && filename[j] >= '0' && filename[j] <= '9' && width <= 20; ++j) {
+                width = width * 10 + (filename[j] - '0');
+            }
+        }
+        if (converted || j >= filename.size() || filename[j] != 'd' || (padded && (width == 0 || width > 20))) {
+            throw DeviceError{filename + ": a frame pattern takes one %d or %0Nd, and %% for a literal %"};
+        }
+        converted = true;
+        frameWidth = width;
+        out = &frameSuffix;
+        i = j;
+    }
+    if (!converted) {
+        throw DeviceError{filename + ": a frame pattern takes one %d or %0Nd, and %% for a literal %"};
+    }
+}
+
+std::string PDPDisplay::frameName(uint64_t frame) const {
+    std::string number = std::to_string(frame);
+    if (number.size() < frameWidth) number.insert(0, frameWidth - number.size(), '0');
+    return framePrefix + number + frameSuffix;
+}
+
+PDPDisplay::~PDPDisplay() {
+    if (!points.empty()) endFrame();
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        closing = true;
+    }
+    changed.notify_all();
+    renderer.join();
+    if (fd >= 0 && fd != STDOUT_FILENO) close(fd);
+}
+
+void PDPDisplay::endFrame() {
+    std::unique_lock<std::mutex> guard(lock);
+    changed.wait(guard, [this] { return queue.size() < DISPLAY_QUEUE; });
+    queue.push_back(std::move(points));
+    guard.unlock();
+    changed.notify_all();
+    points.clear();
+}
+
+void PDPDisplay::render() {
+    std::vector<uint32_t> frame;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            changed.wait(guard, [this] { return closing || !queue.empty(); });
+            if (queue.empty()) return;
+            frame = std::move(queue.front());
+            queue.pop_front();
+        }
+        changed.notify_all();
+        renderFrame(frame);
+        writeFrame();
+    }
+}
+
+void PDPDisplay::renderFrame(const std::vector<uint32_t> &frame) {
+    // a plain multiply-high over 16-bit pixels, which the compiler turns into SIMD
+    for (uint16_t &glow : phosphor) glow = (glow * decay) >> 16;
+
+    for (uint32_t point : frame) {
+        unsigned int x = (coordinate(point & 01777) + 511) * size / (DISPLAY_POINTS - 1);
+        unsigned int y = (511 - coordinate((point >> 10) & 01777)) * size / (DISPLAY_POINTS - 1);
+        uint16_t level = 8191 * ((point >> 20) + 1);
+        uint16_t &glow = phosphor[y * size + x];
+        if (glow < level) glow = level;
+    }
+
+    // recolour only where something glows or did last frame: a plotted picture leaves most of the
+    // screen dark, so most groups of pixels are skipped on a single test
+    size_t pixels = phosphor.size();
+    size_t i = 0;
+    for (; i + DISPLAY_GROUP <= pixels; i += DISPLAY_GROUP) {
+        uint64_t glow[DISPLAY_GROUP / 4];
+        uint64_t was;
+        std::memcpy(glow, &phosphor[i], sizeof(glow));
+        std::memcpy(&was, &shown[i], sizeof(was));
+        uint64_t lit = 0;
+        for (uint64_t g : glow) lit |= g;
+        if (!(lit & 0xff00ff00ff00ff00ull) && !was) continue;
+        for (size_t j = i; j < i + DISPLAY_GROUP; ++j) colour(j);
+    }
+    for (; i < pixels; ++i) colour(i);
+}
+
+void PDPDisplay::colour(size_t pixel) {
+    uint8_t v = phosphor[pixel] >> 8;
+    shown[pixel] = v;
+    // the fourth (zero) byte lands on the next pixel's red, which is either recoloured after this
+    // one or dark, or is the slack byte
+    std::memcpy(&image[3 * pixel], &palette[v], 4);
+}
+
+void PDPDisplay::writeFrame() {
+    std::string header = raw ? "" : "P6\n" + std::to_string(size) + " " + std::to_string(size) + "\n255\n";
+
+    int out = fd;
+    uint64_t frame = frames++;
+    if (perFrame) {
+        out = open(frameName(frame).c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (out < 0) return;
+    }
+    writeAll(out, reinterpret_cast<const uint8_t *>(header.data()), header.size());
+    writeAll(out, image.data(), image.size() - 1);
+    if (perFrame) close(out);
+}
@@ -0,0 +1,120 @@
+//
+// PDP-1 Simulator
+// Type 30 Point-Plot Display
+//
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "PDPDevices.hpp"
+#include "PDPTiming.hpp"
+#include "PDPWord.hpp"
+
+// dpy (730007): plots the point whose X is in the top 10 bits of AC and Y in the top 10 bits of IO,
+// both one's complement with (0, 0) in the middle of the screen. Bits 6-8 of the IOT are a signed
+// intensity, from -4 (dimmest) through 0 (the standard dpy) to +3 (brightest).
+#define IOT_DPY 007
+
+// the CRT is 1024 points across and takes 50 us to plot one
+#define DISPLAY_POINTS  1024
+#define DISPLAY_CYCLES  (50000 / CYCLE_NS)
+
+// the P7 phosphor loses half its glow in this long
+#define PHOSPHOR_HALF_LIFE_US 50000
+
+// frames the renderer may fall behind by before plotting waits for it
+#define DISPLAY_QUEUE 8
+
+/**
+ * Collects plotted points into per-frame batches and renders them on a background thread: each
+ * frame decays the phosphor image, lights the frame's points and writes the result out as a
+ * binary PPM. plot() is only an append, so the processor pays next to nothing per point.
+ *
+ * Output goes to one file per frame if the filename contains a %d or %0Nd (e.g.
+ * "frame%05d.ppm", with %% for a literal %), to a raw RGB24 stream if it ends in ".rgb", and otherwise to a single stream
+ * of concatenated PPM images ("-" for stdout), which ffmpeg reads with -f image2pipe.
+ */
+class PDPDisplay {
+
+private:
+
+    std::string filename;
+    unsigned int size;          // output pixels per side
+    uint32_t decay;             // phosphor brightness kept per frame, 16.16 fixed point
+    bool perFrame;
+    bool raw;
+    int fd = -1;
+
+    // a per-frame filename split around its frame number, which is zero-padded to frameWidth
+    std::string framePrefix;
+    std::string frameSuffix;
+    unsigned int frameWidth = 0;
+
+    std::vector<uint32_t> points;   // the frame being plotted: x, y and intensity packed by plot()
+
+    std::deque<std::vector<uint32_t>> queue;
+    std::mutex lock;
+    std::condition_variable changed;
+    bool closing = false;
+    std::thread renderer;
+
+    // owned by the render thread
+    std::vector<uint16_t> phosphor;
+    std::vector<uint8_t> shown;     // the brightness each pixel of image was last coloured with
+    std::vector<uint8_t> image;     // RGB, plus one byte of slack for the 4-byte palette stores
+    uint32_t palette[256];
+    uint64_t frames = 0;
+
+    /**
+     * Splits a per-frame filename into framePrefix, frameWidth and frameSuffix.
+     * @throws DeviceError unless it holds exactly one %d or %0Nd, with %% as the only other %
+     */
+    void parsePattern();
+
+    std::string frameName(uint64_t frame) const;
+
+    void render();
+
+    void renderFrame(const std::vector<uint32_t> &frame);
+
+    void colour(size_t pixel);
+
+    void writeFrame();
+
+public:
+
+    /**
+     * Opens the output and starts the render thread.
+     * @param filename: output file, pattern or "-" (see above)
+     * @param size: pixels per side of the rendered frames
+     * @param fps: frames per second of machine time, which sets how far the phosphor decays per frame
+     * @throws DeviceError if the output cannot be created or the frame pattern is malformed
+     */
+    PDPDisplay(const std::string &filename, unsigned int size, unsigned int fps);
+
+    /**
+     * Renders the frame in progress and everything still queued, then closes the output.
+     */
+    ~PDPDisplay();
+
+    PDPDisplay(const PDPDisplay &) = delete;
+    PDPDisplay &operator=(const PDPDisplay &) = delete;
+
+    // intensity runs from 0 (dimmest) to 7
+    void plot(WORD ac, WORD io, unsigned int intensity) {
+        points.push_back(((ac.value >> 8) & 01777) | (((io.value >> 8) & 01777) << 10) | (intensity << 20));
+    }
+
+    /**
+     * Hands the points plotted since the last call to the render thread as one frame.
+     */
+    void endFrame();
+
+};
@@ -0,0 +1,849 @@
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+#include "PDPEnsemble.hpp"
+
+#include "TapeReader.hpp"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+PDPEnsemble::PDPEnsemble(const PDPSettings &settings_in, unsigned int lanes_in, const std::vector<WORD> &image)
+    : settings{settings_in}, lanes{lanes_in},
+      stride{(lanes_in + ENSEMBLE_BLOCK - 1) / ENSEMBLE_BLOCK * ENSEMBLE_BLOCK},
+      memorySize{settings_in.memory_size}, active{lanes_in} {
+    if (image.size() > memorySize) {
+        throw TapeFormatError{settings.tapeFile + ": tape does not fit in " + std::to_string(memorySize) + " words of memory"};
+    }
+
+#if defined(__x86_64__)
+    // gathers index core memory with signed 32-bit offsets
+    vectorized = settings.engine != PDPEngine::INTERPRETER && __builtin_cpu_supports("avx2")
+        && static_cast<uint64_t>(memorySize) * stride < (uint64_t{1} << 31);
+#else
+    vectorized = false;
+#endif
+
+    ac.assign(stride, 0);
+    io.assign(stride, 0);
+    pc.assign(stride, 0);
+    pf.assign(stride, 0);
+    overflow.assign(stride, 0);
+    switches.assign(stride, settings.senseSwitches.to_ulong());
+    running.assign(stride, 0);
+    std::fill(running.begin(), running.begin() + lanes, ~uint32_t{0});
+    halt.assign(stride, PDPHaltReason::RUNNING);
+    retired.assign(stride, 0);
+
+    cm.assign(static_cast<size_t>(memorySize) * stride, 0);
+    for (size_t addr = 0; addr < image.size(); ++addr) {
+        std::fill_n(cm.begin() + addr * stride, lanes, image[addr].value);
+    }
+
+    fetched.assign(stride, 0);
+    group.assign(stride, 0);
+    pending.assign(stride, 0);
+}
+
+void PDPEnsemble::stop(unsigned int lane, PDPHaltReason reason, bool fetched) {
+    running[lane] = 0;
+    halt[lane] = reason;
+    retired[lane] = fetched ? steps : steps - 1;
+    --active;
+}
+
+// scalar lanes, the same semantics as PDPProcessor::readMemory / writeMemory / executeInstruction
+
+unsigned int PDPEnsemble::effectiveAddress(unsigned int lane, unsigned int addr, bool indirect) {
+    if (!indirect) return addr;
+    unsigned int start = addr;
+    unsigned int hops = 0;
+    uint32_t w = word(lane, addr);
+    while (w & 010000) {
+        if (hops++ == settings.maxIndirection) throw IndirectChainError{start};
+        addr = w & 07777;
+        w = word(lane, addr);
+    }
+    return addr;
+}
+
+void PDPEnsemble::executeLane(unsigned int lane, unsigned long instr) {
+    unsigned long opcode6 = (instr >> 12) & 076;
+    bool indirect = (instr & 0010000);
+    unsigned int operand12 = instr & 07777;
+
+    WORD acw {ac[lane]};
+    WORD iow {io[lane]};
+    bool incPC = true;
+
+    // jsp / jda / cal return word: PC + 1 with overflow and extend in the top bits
+    WORD link {pc[lane] + 1};
+    link.set(17, overflow[lane]);
+    link.set(16, settings.extend);
+
+    switch (opcode6) {
+    case 040:
+        {
+            // add
+            WORD cy {word(lane, effectiveAddress(lane, operand12, indirect))};
+            WORD newAC = onesAdd(acw, cy);
+            if (addOverflows(acw, cy, newAC)) overflow[lane] = 1;
+            ac[lane] = newAC.value;
+            break;
+        }
+
+    case 042:
+        {
+            // sub
+            WORD cy {word(lane, effectiveAddress(lane, operand12, indirect))};
+            WORD newAC = onesSub(acw, cy);
+            if (acw.negative() != newAC.negative()) overflow[lane] = 1;
+            ac[lane] = newAC.value;
+            break;
+        }
+
+    case 054:
+        {
+            // mul
+            WordPair product = onesMul(acw, WORD{word(lane, effectiveAddress(lane, operand12, indirect))});
+            ac[lane] = product.ac.value;
+            io[lane] = product.io.value;
+            break;
+        }
+
+    case 056:
+        {
+            // div, skipping unless it overflows
+            WordPair result;
+            if (onesDiv({acw, iow}, WORD{word(lane, effectiveAddress(lane, operand12, indirect))}, result)) {
+                ac[lane] = result.ac.value;
+                io[lane] = result.io.value;
+                pc[lane] = (pc[lane] + 1) & 0177777;
+            }
+            break;
+        }
+
+    case 044:
+    case 046:
+        {
+            // idx, isp
+            unsigned int addr = effectiveAddress(lane, operand12, indirect);
+            int cy = onesComplementToInt(WORD{word(lane, addr)});
+            WORD newAC = intToOnesComplement(cy + 1);
+            ac[lane] = newAC.value;
+            word(lane, addr) = newAC.value;
+            if (opcode6 == 046 && cy + 1 >= 0) pc[lane] = (pc[lane] + 1) & 0177777;
+            break;
+        }
+
+    case 002:
+        // and
+        ac[lane] &= word(lane, effectiveAddress(lane, operand12, indirect));
+        break;
+
+    case 006:
+        // xor
+        ac[lane] ^= word(lane, effectiveAddress(lane, operand12, indirect));
+        break;
+
+    case 004:
+        // ior
+        ac[lane] |= word(lane, effectiveAddress(lane, operand12, indirect));
+        break;
+
+    case 020:
+        // lac
+        ac[lane] = word(lane, effectiveAddress(lane, operand12, indirect));
+        break;
+
+    case 024:
+        // dac
+        word(lane, effectiveAddress(lane, operand12, indirect)) = acw.value;
+        break;
+
+    case 026:
+        {
+            // dap
+            unsigned int addr = effectiveAddress(lane, operand12, indirect);
+            uint32_t cy = word(lane, addr);
+            word(lane, addr) = (cy & 0770000) | (acw.value & 07777);
+            break;
+        }
+
+    case 030:
+        {
+            // dip
+            unsigned int addr = effectiveAddress(lane, operand12, indirect);
+            uint32_t cy = word(lane, addr);
+            word(lane, addr) = (cy & 0017777) | (acw.value & 0760000);
+            break;
+        }
+
+    case 022:
+        // lio
+        io[lane] = word(lane, effectiveAddress(lane, operand12, indirect));
+        break;
+
+    case 032:
+        // dio
+        word(lane, effectiveAddress(lane, operand12, indirect)) = iow.value;
+        break;
+
+    case 034:
+        // dzm
+        word(lane, effectiveAddress(lane, operand12, indirect)) = 0;
+        break;
+
+    case 010:
+        {
+            // xct, following an xct of an xct without recursing
+            uint32_t executed = word(lane, effectiveAddress(lane, operand12, indirect));
+            unsigned int hops = 0;
+            while (((executed >> 12) & 076) == 010) {
+                if (hops++ == settings.maxIndirection) throw IndirectChainError{operand12};
+                executed = word(lane, effectiveAddress(lane, executed & 07777, executed & 0010000));
+            }
+            executeLane(lane, executed);
+            break;
+        }
+
+    case 060:
+        // jmp
+        pc[lane] = operand12;
+        incPC = false;
+        break;
+
+    case 062:
+        // jsp
+        ac[lane] = link.value;
+        pc[lane] = operand12;
+        incPC = false;
+        break;
+
+    case 016:
+        // jda (indirect) or cal
+        word(lane, indirect ? operand12 : 0100) = acw.value;
+        ac[lane] = link.value;
+        pc[lane] = indirect ? operand12 + 1 : 0101;
+        incPC = false;
+        break;
+
+    case 050:
+        // sad
+        if (word(lane, effectiveAddress(lane, operand12, indirect)) != acw.value) pc[lane] = (pc[lane] + 1) & 0177777;
+        break;
+
+    case 052:
+        // sas
+        if (word(lane, effectiveAddress(lane, operand12, indirect)) == acw.value) pc[lane] = (pc[lane] + 1) & 0177777;
+        break;
+
+    case 070:
+        // law
+        ac[lane] = intToOnesComplement((indirect?-1:1) * static_cast<int>(operand12)).value;
+        break;
+
+    case 066:
+        {
+            // shift group
+            unsigned int n = __builtin_popcount(instr & 0777);
+            switch ((instr & 0777000) >> 9) {
+            case 0671: ac[lane] = acw.rotateRight(n).value; break;
+            case 0661: ac[lane] = acw.rotateLeft(n).value; break;
+            case 0675: ac[lane] = (acw >> n).value; break;
+            case 0665: ac[lane] = (acw << n).value; break;
+            case 0672: io[lane] = iow.rotateRight(n).value; break;
+            case 0662: io[lane] = iow.rotateLeft(n).value; break;
+            case 0676: io[lane] = (iow >> n).value; break;
+            case 0666: io[lane] = (iow << n).value; break;
+            case 0673:
+                ac[lane] = ((acw >> n) | (iow << (18 - n))).value;
+                io[lane] = ((iow >> n) | (acw << (18 - n))).value;
+                break;
+            case 0663:
+                ac[lane] = ((acw << n) | (iow >> (18 - n))).value;
+                io[lane] = ((iow << n) | (acw >> (18 - n))).value;
+                break;
+            case 0677:
+                ac[lane] = (acw >> n).value;
+                io[lane] = ((iow >> n) | (acw << (18 - n))).value;
+                break;
+            case 0667:
+                ac[lane] = ((acw << n) | (iow >> (18 - n))).value;
+                io[lane] = (iow << n).value;
+                break;
+            default:
+                stop(lane, PDPHaltReason::ILLEGAL);
+                incPC = false;
+                break;
+            }
+            break;
+        }
+
+    case 064:
+        {
+            // skip group
+            bool conditionMatched = false;
+            if (operand12 & 00100) conditionMatched = conditionMatched || acw.none();
+            if (operand12 & 00200) conditionMatched = conditionMatched || !acw[17];
+            if (operand12 & 00400) conditionMatched = conditionMatched || acw[17];
+            if (operand12 & 01000) {
+                conditionMatched = conditionMatched || !overflow[lane];
+                overflow[lane] = 0;
+            }
+            if (operand12 & 02000) conditionMatched = conditionMatched || !iow[17];
+            if (operand12 & 00070) {
+                unsigned int sw = (operand12 >> 3) & 07;
+                if (sw == 7) conditionMatched = conditionMatched || switches[lane] == 077;
+                else conditionMatched = conditionMatched || ((switches[lane] >> (sw - 1)) & 1);
+            }
+            if (operand12 & 00007) {
+                unsigned int flags = operand12 & 07;
+                if (flags == 7) conditionMatched = conditionMatched || pf[lane] == 077;
+                else conditionMatched = conditionMatched || ((pf[lane] >> (flags - 1)) & 1);
+            }
+            if (conditionMatched != indirect) pc[lane] = (pc[lane] + 1) & 0177777;
+            break;
+        }
+
+    case 076:
+        {
+            // operate group
+            switch (operand12) {
+            case 04000:
+                // cli
+                io[lane] = 0;
+                break;
+            case 00100:
+                {
+                    // lap
+                    WORD newAC {pc[lane]};
+                    newAC.set(17, acw[17] || overflow[lane]);
+                    newAC.set(16, settings.extend);
+                    ac[lane] = newAC.value;
+                    break;
+                }
+            case 01000:
+                // cma
+                ac[lane] = (~acw).value;
+                break;
+            case 00400:
+                // hlt
+                stop(lane, PDPHaltReason::HALTED);
+                incPC = false;
+                break;
+            case 00200:
+                // cla
+                ac[lane] = 0;
+                break;
+            case 00000:
+                // nop
+                break;
+            default:
+                if (operand12 & 07) {
+                    bool set = operand12 & 010;
+                    unsigned int flags = operand12 & 07;
+                    PDPRegister<6> flagsReg {pf[lane]};
+                    if (flags == 7 && set) flagsReg = PDPRegister<6>::MASK;
+                    else flagsReg.set(flags - 1, set);
+                    pf[lane] = flagsReg.value;
+                    break;
+                }
+                stop(lane, PDPHaltReason::ILLEGAL);
+                incPC = false;
+                break;
+            }
+            break;
+        }
+
+    case 072:
+        // in-out transfer group: batch jobs attach no devices, so no break is ever requested and the
+        // sequence break system IOTs change nothing a lane can observe
+        switch (operand12 & 077) {
+        case IOT_LSM:
+        case IOT_ESM:
+        case IOT_CBS:
+            break;
+        default:
+            stop(lane, PDPHaltReason::ILLEGAL);
+            incPC = false;
+            break;
+        }
+        break;
+
+    default:
+        stop(lane, PDPHaltReason::ILLEGAL);
+        incPC = false;
+    }
+
+    if (incPC) pc[lane] = (pc[lane] + 1) & 0177777;
+}
+
+void PDPEnsemble::stepScalar() {
+    for (unsigned int lane = 0; lane < lanes; ++lane) {
+        if (!running[lane]) continue;
+        if (pc[lane] >= memorySize) {
+            stop(lane, PDPHaltReason::ILLEGAL, false);
+            continue;
+        }
+        runLane(lane, word(lane, pc[lane]));
+    }
+}
+
+void PDPEnsemble::runLane(unsigned int lane, unsigned long instr) {
+    try {
+        executeLane(lane, instr);
+    } catch (const IndirectChainError &) {
+        stop(lane, PDPHaltReason::INDIRECT);
+    }
+}
+
+void PDPEnsemble::executeGroup(unsigned long instr, const uint32_t *mask, unsigned int from) {
+    if (vectorized && executeGroupVector(instr, mask, from)) return;
+    for (unsigned int lane = from; lane < lanes; ++lane) {
+        if (mask[lane]) runLane(lane, instr);
+    }
+}
+
+#if defined(__x86_64__)
+
+#pragma GCC push_options
+#pragma GCC target("avx2")
+
+// vector lanes, one PDP-1 word per 32-bit element
+
+static inline __m256i load(const uint32_t *p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)); }
+
+static inline void storeMasked(uint32_t *p, __m256i mask, __m256i v) {
+    _mm256_maskstore_epi32(reinterpret_cast<int *>(p), mask, v);
+}
+
+static inline __m256i splat(uint32_t v) { return _mm256_set1_epi32(static_cast<int>(v)); }
+
+static inline __m256i vOnesAdd(__m256i a, __m256i b) {
+    __m256i sum = _mm256_add_epi32(a, b);
+    sum = _mm256_add_epi32(_mm256_and_si256(sum, splat(0777777)), _mm256_srli_epi32(sum, 18));
+    return _mm256_andnot_si256(_mm256_cmpeq_epi32(sum, splat(MINUS_ZERO)), sum);
+}
+
+// as onesSub, every -0 difference folds to +0, -0 - +0 included
+static inline __m256i vOnesSub(__m256i a, __m256i b) {
+    __m256i diff = _mm256_sub_epi32(_mm256_or_si256(a, splat(01000000)), b);
+    __m256i borrow = _mm256_xor_si256(_mm256_srli_epi32(diff, 18), splat(1));
+    diff = _mm256_and_si256(_mm256_sub_epi32(diff, borrow), splat(0777777));
+    return _mm256_andnot_si256(_mm256_cmpeq_epi32(diff, splat(MINUS_ZERO)), diff);
+}
+
+// one's complement word -> signed int, as onesComplementToInt
+static inline __m256i vToInt(__m256i w) {
+    __m256i negative = _mm256_cmpeq_epi32(_mm256_and_si256(w, splat(0400000)), splat(0400000));
+    __m256i magnitude = _mm256_blendv_epi8(w, _mm256_andnot_si256(w, splat(0377777)), negative);
+    return _mm256_sub_epi32(_mm256_xor_si256(magnitude, negative), negative);
+}
+
+// signed int -> one's complement word, as intToOnesComplement
+static inline __m256i vFromInt(__m256i x) {
+    __m256i negative = _mm256_cmpgt_epi32(_mm256_setzero_si256(), x);
+    __m256i positive = _mm256_and_si256(x, splat(0377777));
+    __m256i k = _mm256_sub_epi32(_mm256_setzero_si256(), x);
+    __m256i minus = _mm256_or_si256(_mm256_andnot_si256(k, splat(0377777)), splat(0400000));
+    return _mm256_blendv_epi8(positive, minus, negative);
+}
+
+static inline __m256i vSign(__m256i w) { return _mm256_srli_epi32(w, 17); }
+
+enum class Kernel {
+    NONE,
+    ADD, SUB, IDX, ISP, AND, XOR, IOR, LAC, DAC, DAP, DIP, LIO, DIO, DZM, SAD, SAS,
+    JMP, JSP, LAW,
+    RAR, RAL, SAR, SAL, RIR, RIL, SIR, SIL, RCR, RCL, SCR, SCL,
+    SKIP,
+    CLI, LAP, CMA, CLA, NOP, FLAG
+};
+
+/**
+ * Picks the vector kernel for an instruction word. Indirect memory references, xct, jda/cal,
+ * mul/div, hlt and illegal instructions have none and run on the scalar lanes.
+ */
+static Kernel kernelFor(unsigned long instr) {
+    bool indirect = instr & 010000;
+    unsigned int operand12 = instr & 07777;
+
+    switch ((instr >> 12) & 076) {
+    case 040: return indirect ? Kernel::NONE : Kernel::ADD;
+    case 042: return indirect ? Kernel::NONE : Kernel::SUB;
+    case 044: return indirect ? Kernel::NONE : Kernel::IDX;
+    case 046: return indirect ? Kernel::NONE : Kernel::ISP;
+    case 002: return indirect ? Kernel::NONE : Kernel::AND;
+    case 006: return indirect ? Kernel::NONE : Kernel::XOR;
+    case 004: return indirect ? Kernel::NONE : Kernel::IOR;
+    case 020: return indirect ? Kernel::NONE : Kernel::LAC;
+    case 024: return indirect ? Kernel::NONE : Kernel::DAC;
+    case 026: return indirect ? Kernel::NONE : Kernel::DAP;
+    case 030: return indirect ? Kernel::NONE : Kernel::DIP;
+    case 022: return indirect ? Kernel::NONE : Kernel::LIO;
+    case 032: return indirect ? Kernel::NONE : Kernel::DIO;
+    case 034: return indirect ? Kernel::NONE : Kernel::DZM;
+    case 050: return indirect ? Kernel::NONE : Kernel::SAD;
+    case 052: return indirect ? Kernel::NONE : Kernel::SAS;
+    case 060: return Kernel::JMP;
+    case 062: return Kernel::JSP;
+    case 070: return Kernel::LAW;
+    case 064: return Kernel::SKIP;
+    case 066:
+        switch ((instr & 0777000) >> 9) {
+        case 0671: return Kernel::RAR;
+        case 0661: return Kernel::RAL;
+        case 0675: return Kernel::SAR;
+        case 0665: return Kernel::SAL;
+        case 0672: return Kernel::RIR;
+        case 0662: return Kernel::RIL;
+        case 0676: return Kernel::SIR;
+        case 0666: return Kernel::SIL;
+        case 0673: return Kernel::RCR;
+        case 0663: return Kernel::RCL;
+        case 0677: return Kernel::SCR;
+        case 0667: return Kernel::SCL;
+        default:   return Kernel::NONE;
+        }
+    case 076:
+        switch (operand12) {
+        case 04000: return Kernel::CLI;
+        case 00100: return Kernel::LAP;
+        case 01000: return Kernel::CMA;
+        case 00200: return Kernel::CLA;
+        case 00000: return Kernel::NOP;
+        case 00400: return Kernel::NONE;
+        default:    return (operand12 & 07) ? Kernel::FLAG : Kernel::NONE;
+        }
+    default:
+        return Kernel::NONE;
+    }
+}
+
+bool PDPEnsemble::executeGroupVector(unsigned long instr, const uint32_t *mask, unsigned int from) {
+    Kernel kernel = kernelFor(instr);
+    if (kernel == Kernel::NONE) return false;
+
+    bool indirect = instr & 010000;
+    unsigned int operand12 = instr & 07777;
+    uint32_t *row = cm.data() + static_cast<size_t>(operand12) * stride;
+
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i one = splat(1);
+    const __m256i word18 = splat(0777777);
+    const __m256i low16 = splat(0177777);
+    const __m256i extendBit = splat(settings.extend ? 0200000 : 0);
+
+    unsigned int n = __builtin_popcount(instr & 0777);
+    const __m256i by = splat(n);
+    const __m256i back = splat(18 - n);
+
+    const __m256i lawValue = splat(intToOnesComplement((indirect?-1:1) * static_cast<int>(operand12)).value);
+
+    // skip group selectors
+    unsigned int sw = (operand12 >> 3) & 07;
+    unsigned int flags = operand12 & 07;
+    const __m256i swBit = splat(sw && sw != 7 ? 1u << (sw - 1) : 0);
+    const __m256i flagBit = splat(flags && flags != 7 ? 1u << (flags - 1) : 0);
+
+    // operate group flag update: pf = (pf & keep) | add
+    uint32_t keep = 077, add = 0;
+    if (flags == 7) {
+        if (operand12 & 010) add = 077;
+    } else if (flags) {
+        if (operand12 & 010) add = 1u << (flags - 1);
+        else keep &= ~(1u << (flags - 1));
+    }
+    const __m256i flagKeep = splat(keep);
+    const __m256i flagAdd = splat(add);
+
+    for (unsigned int b = from / ENSEMBLE_BLOCK * ENSEMBLE_BLOCK; b < stride; b += ENSEMBLE_BLOCK) {
+        __m256i m = load(mask + b);
+        if (_mm256_testz_si256(m, m)) continue;
+
+        __m256i vac = load(ac.data() + b);
+        __m256i vio = load(io.data() + b);
+        __m256i vpc = load(pc.data() + b);
+        __m256i vov = load(overflow.data() + b);
+        __m256i vpf = load(pf.data() + b);
+
+        __m256i nac = vac, nio = vio, nov = vov, npf = vpf;
+        __m256i inc = one;
+        bool jump = false;
+
+        switch (kernel) {
+        case Kernel::ADD:
+            {
+                __m256i cy = load(row + b);
+                nac = vOnesAdd(vac, cy);
+                __m256i sameSign = _mm256_xor_si256(_mm256_xor_si256(vSign(vac), vSign(cy)), one);
+                nov = _mm256_or_si256(vov, _mm256_and_si256(sameSign, _mm256_xor_si256(vSign(nac), vSign(vac))));
+                break;
+            }
+        case Kernel::SUB:
+            {
+                __m256i cy = load(row + b);
+                nac = vOnesSub(vac, cy);
+                nov = _mm256_or_si256(vov, _mm256_xor_si256(vSign(nac), vSign(vac)));
+                break;
+            }
+        case Kernel::IDX:
+        case Kernel::ISP:
+            {
+                __m256i next = _mm256_add_epi32(vToInt(load(row + b)), one);
+                nac = vFromInt(next);
+                storeMasked(row + b, m, nac);
+                if (kernel == Kernel::ISP) inc = _mm256_add_epi32(inc, _mm256_andnot_si256(_mm256_cmpgt_epi32(zero, next), one));
+                break;
+            }
+        case Kernel::AND: nac = _mm256_and_si256(vac, load(row + b)); break;
+        case Kernel::XOR: nac = _mm256_xor_si256(vac, load(row + b)); break;
+        case Kernel::IOR: nac = _mm256_or_si256(vac, load(row + b)); break;
+        case Kernel::LAC: nac = load(row + b); break;
+        case Kernel::LIO: nio = load(row + b); break;
+        case Kernel::DAC: storeMasked(row + b, m, vac); break;
+        case Kernel::DIO: storeMasked(row + b, m, vio); break;
+        case Kernel::DZM: storeMasked(row + b, m, zero); break;
+        case Kernel::DAP:
+            storeMasked(row + b, m, _mm256_or_si256(_mm256_and_si256(load(row + b), splat(0770000)), _mm256_and_si256(vac, splat(07777))));
+            break;
+        case Kernel::DIP:
+            storeMasked(row + b, m, _mm256_or_si256(_mm256_and_si256(load(row + b), splat(0017777)), _mm256_and_si256(vac, splat(0760000))));
+            break;
+        case Kernel::SAD:
+            inc = _mm256_add_epi32(inc, _mm256_andnot_si256(_mm256_cmpeq_epi32(load(row + b), vac), one));
+            break;
+        case Kernel::SAS:
+            inc = _mm256_add_epi32(inc, _mm256_and_si256(_mm256_cmpeq_epi32(load(row + b), vac), one));
+            break;
+        case Kernel::JMP:
+            jump = true;
+            break;
+        case Kernel::JSP:
+            nac = _mm256_or_si256(_mm256_or_si256(_mm256_and_si256(_mm256_add_epi32(vpc, one), low16), _mm256_slli_epi32(vov, 17)), extendBit);
+            jump = true;
+            break;
+        case Kernel::LAW:
+            nac = lawValue;
+            break;
+
+        case Kernel::RAR: nac = _mm256_and_si256(_mm256_or_si256(_mm256_srlv_epi32(vac, by), _mm256_sllv_epi32(vac, back)), word18); break;
+        case Kernel::RAL: nac = _mm256_and_si256(_mm256_or_si256(_mm256_sllv_epi32(vac, by), _mm256_srlv_epi32(vac, back)), word18); break;
+        case Kernel::SAR: nac = _mm256_srlv_epi32(vac, by); break;
+        case Kernel::SAL: nac = _mm256_and_si256(_mm256_sllv_epi32(vac, by), word18); break;
+        case Kernel::RIR: nio = _mm256_and_si256(_mm256_or_si256(_mm256_srlv_epi32(vio, by), _mm256_sllv_epi32(vio, back)), word18); break;
+        case Kernel::RIL: nio = _mm256_and_si256(_mm256_or_si256(_mm256_sllv_epi32(vio, by), _mm256_srlv_epi32(vio, back)), word18); break;
+        case Kernel::SIR: nio = _mm256_srlv_epi32(vio, by); break;
+        case Kernel::SIL: nio = _mm256_and_si256(_mm256_sllv_epi32(vio, by), word18); break;
+        case Kernel::RCR:
+            nac = _mm256_and_si256(_mm256_or_si256(_mm256_srlv_epi32(vac, by), _mm256_sllv_epi32(vio, back)), word18);
+            nio = _mm256_and_si256(_mm256_or_si256(_mm256_srlv_epi32(vio, by), _mm256_sllv_epi32(vac, back)), word18);
+            break;
+        case Kernel::RCL:
+            nac = _mm256_and_si256(_mm256_or_si256(_mm256_sllv_epi32(vac, by), _mm256_srlv_epi32(vio, back)), word18);
+            nio = _mm256_and_si256(_mm256_or_si256(_mm256_sllv_epi32(vio, by), _mm256_srlv_epi32(vac, back)), word18);
+            break;
+        case Kernel::SCR:
+            nac = _mm256_srlv_epi32(vac, by);
+            nio = _mm256_and_si256(_mm256_or_si256(_mm256_srlv_epi32(vio, by), _mm256_sllv_epi32(vac, back)), word18);
+            break;
+        case Kernel::SCL:
+            nac = _mm256_and_si256(_mm256_or_si256(_mm256_sllv_epi32(vac, by), _mm256_srlv_epi32(vio, back)), word18);
+            nio = _mm256_and_si256(_mm256_sllv_epi32(vio, by), word18);
+            break;
+
+        case Kernel::SKIP:
+            {
+                __m256i cond = zero;
+                if (operand12 & 00100) cond = _mm256_or_si256(cond, _mm256_cmpeq_epi32(vac, zero));
+                if (operand12 & 00200) cond = _mm256_or_si256(cond, _mm256_cmpeq_epi32(vSign(vac), zero));
+                if (operand12 & 00400) cond = _mm256_or_si256(cond, _mm256_cmpeq_epi32(vSign(vac), one));
+                if (operand12 & 01000) {
+                    cond = _mm256_or_si256(cond, _mm256_cmpeq_epi32(vov, zero));
+                    nov = zero;
+                }
+                if (operand12 & 02000) cond = _mm256_or_si256(cond, _mm256_cmpeq_epi32(vSign(vio), zero));
+                if (sw) {
+                    __m256i vsw = load(switches.data() + b);
+                    if (sw == 7) cond = _mm256_or_si256(cond, _mm256_cmpeq_epi32(vsw, splat(077)));
+                    else cond = _mm256_or_si256(cond, _mm256_cmpeq_epi32(_mm256_and_si256(vsw, swBit), swBit));
+                }
+                if (flags) {
+                    if (flags == 7) cond = _mm256_or_si256(cond, _mm256_cmpeq_epi32(vpf, splat(077)));
+                    else cond = _mm256_or_si256(cond, _mm256_cmpeq_epi32(_mm256_and_si256(vpf, flagBit), flagBit));
+                }
+                __m256i skip = indirect ? _mm256_andnot_si256(cond, one) : _mm256_and_si256(cond, one);
+                inc = _mm256_add_epi32(inc, skip);
+                break;
+            }
+
+        case Kernel::CLI: nio = zero; break;
+        case Kernel::LAP:
+            {
+                __m256i top = _mm256_slli_epi32(_mm256_or_si256(vSign(vac), vov), 17);
+                nac = _mm256_or_si256(_mm256_or_si256(_mm256_and_si256(vpc, low16), top), extendBit);
+                break;
+            }
+        case Kernel::CMA: nac = _mm256_xor_si256(vac, word18); break;
+        case Kernel::CLA: nac = zero; break;
+        case Kernel::NOP: break;
+        case Kernel::FLAG: npf = _mm256_or_si256(_mm256_and_si256(vpf, flagKeep), flagAdd); break;
+        case Kernel::NONE: break;
+        }
+
+        __m256i npc = jump ? splat(operand12) : _mm256_and_si256(_mm256_add_epi32(vpc, inc), low16);
+
+        storeMasked(ac.data() + b, m, nac);
+        storeMasked(io.data() + b, m, nio);
+        storeMasked(pc.data() + b, m, npc);
+        storeMasked(overflow.data() + b, m, nov);
+        storeMasked(pf.data() + b, m, npf);
+    }
+
+    return true;
+}
+
+void PDPEnsemble::stepVector() {
+    unsigned int first = 0;
+    while (first < lanes && !running[first]) ++first;
+    if (first == lanes) return;
+
+    // common case: every running lane is about to execute the same word at the same PC
+    uint32_t p = pc[first];
+    if (p < memorySize) {
+        uint32_t w = word(first, p);
+        const uint32_t *row = cm.data() + static_cast<size_t>(p) * stride;
+        __m256i vp = splat(p), vw = splat(w);
+        bool converged = true;
+        for (unsigned int b = 0; converged && b < stride; b += ENSEMBLE_BLOCK) {
+            __m256i same = _mm256_and_si256(_mm256_cmpeq_epi32(load(pc.data() + b), vp), _mm256_cmpeq_epi32(load(row + b), vw));
+            converged = _mm256_testc_si256(same, load(running.data() + b));
+        }
+        if (converged) {
+            executeGroup(w, running.data(), 0);
+            return;
+        }
+    }
+
+    // diverged: fetch each lane's own instruction, then run one group per distinct (PC, word)
+    const __m256i laneOffsets = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m256i vstride = splat(stride);
+    const __m256i vmemory = splat(memorySize);
+    for (unsigned int b = 0; b < stride; b += ENSEMBLE_BLOCK) {
+        __m256i r = load(running.data() + b);
+        __m256i vpc = load(pc.data() + b);
+        __m256i valid = _mm256_and_si256(r, _mm256_cmpgt_epi32(vmemory, vpc));
+        __m256i index = _mm256_add_epi32(_mm256_mullo_epi32(vpc, vstride), _mm256_add_epi32(laneOffsets, splat(b)));
+        __m256i w = _mm256_mask_i32gather_epi32(_mm256_setzero_si256(), reinterpret_cast<const int *>(cm.data()), index, valid, 4);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(fetched.data() + b), w);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(pending.data() + b), valid);
+
+        // PC ran off the end of memory
+        int outside = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_andnot_si256(valid, r)));
+        while (outside) {
+            stop(b + __builtin_ctz(outside), PDPHaltReason::ILLEGAL, false);
+            outside &= outside - 1;
+        }
+    }
+
+    for (unsigned int b = 0; b < stride; ) {
+        int bits = _mm256_movemask_ps(_mm256_castsi256_ps(load(pending.data() + b)));
+        if (!bits) {
+            b += ENSEMBLE_BLOCK;
+            continue;
+        }
+
+        unsigned int leader = b + __builtin_ctz(bits);
+        __m256i vp = splat(pc[leader]);
+        __m256i vw = splat(fetched[leader]);
+        for (unsigned int c = b; c < stride; c += ENSEMBLE_BLOCK) {
+            __m256i waiting = load(pending.data() + c);
+            __m256i same = _mm256_and_si256(_mm256_cmpeq_epi32(load(pc.data() + c), vp), _mm256_cmpeq_epi32(load(fetched.data() + c), vw));
+            __m256i members = _mm256_and_si256(waiting, same);
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(group.data() + c), members);
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(pending.data() + c), _mm256_andnot_si256(members, waiting));
+        }
+        executeGroup(fetched[leader], group.data(), b);
+    }
+}
+
+#pragma GCC pop_options
+
+#else
+
+bool PDPEnsemble::executeGroupVector(unsigned long, const uint32_t *, unsigned int) { return false; }
+
+void PDPEnsemble::stepVector() { stepScalar(); }
+
+#endif
+
+bool PDPEnsemble::step() {
+    if (!active) return false;
+
+    ++steps;
+    if (vectorized) stepVector();
+    else stepScalar();
+
+    return active;
+}
+
+void PDPEnsemble::run() {
+    auto start = std::chrono::steady_clock::now();
+    uint64_t budget = settings.maxInstructions ? settings.maxInstructions : UINT64_MAX;
+
+    while (active) {
+        if (steps >= budget) {
+            for (unsigned int lane = 0; lane < lanes; ++lane) {
+                if (running[lane]) stop(lane, PDPHaltReason::BUDGET);
+            }
+            return;
+        }
+
+        uint64_t until = steps + std::min<uint64_t>(budget - steps, ENSEMBLE_CHUNK);
+        while (active && steps < until) step();
+
+        if (active && settings.timeLimit > 0) {
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            if (elapsed.count() >= settings.timeLimit) {
+                for (unsigned int lane = 0; lane < lanes; ++lane) {
+                    if (running[lane]) stop(lane, PDPHaltReason::TIMEOUT);
+                }
+                return;
+            }
+        }
+    }
+}
+
+uint64_t PDPEnsemble::memoryDigest(unsigned int lane) const {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (size_t addr = 0; addr < memorySize; ++addr) {
+        uint32_t w = cm[addr * stride + lane];
+        for (int i = 0; i < 3; ++i) {
+            hash ^= (w >> (8 * i)) & 0xFF;
+            hash *= 0x100000001b3ULL;
+        }
+    }
+    return hash;
+}
+
+void PDPEnsemble::writeSummaryFields(unsigned int lane, std::ostream &os) const {
+    char digest[17];
+    snprintf(digest, sizeof(digest), "%016llx", static_cast<unsigned long long>(memoryDigest(lane)));
+
+    os << "\"instructions\": " << (running[lane] ? steps : retired[lane])
+       << ", \"halt\": \"" << haltReasonName(halt[lane]) << "\""
+       << ", \"pc\": " << pc[lane]
+       << ", \"ac\": " << ac[lane]
+       << ", \"io\": " << io[lane]
+       << ", \"pf\": " << pf[lane]
+       << ", \"overflow\": " << (overflow[lane] ? "true" : "false")
+       << ", \"memory_digest\": \"" << digest << "\"";
+}
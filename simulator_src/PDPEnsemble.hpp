@@ -0,0 +1,140 @@
+//
+// PDP-1 Simulator
+// Lockstep SIMD Ensemble
+//
+
+#pragma once
+
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+#include "PDPSettings.hpp"
+#include "PDPState.hpp"
+#include "PDPWord.hpp"
+
+// lanes per AVX2 vector; the lane count is padded to a multiple of this
+#define ENSEMBLE_BLOCK 8
+
+// how many lockstep steps run() takes between wall clock checks
+#define ENSEMBLE_CHUNK (1 << 14)
+
+/**
+ * Runs many copies of one program side by side, each with its own registers, sense switches and
+ * core memory. Registers are kept in structure-of-arrays form and core memory is interleaved
+ * (word a of lane l lives at cm[a * stride + l]), so while the lanes agree on the PC every
+ * direct memory reference is a single contiguous vector load or store.
+ *
+ * Every step retires one instruction on every running lane. Lanes executing the same
+ * instruction word at the same PC form a group, and each group is executed with masked AVX2
+ * kernels; lanes that diverge simply end up in different groups. Instructions without a kernel
+ * (xct, jda/cal, mul/div) and hosts without AVX2 use a scalar per-lane interpreter. Either way,
+ * each lane behaves exactly like a PDPProcessor running the same program.
+ */
+class PDPEnsemble {
+
+private:
+
+    PDPSettings settings;
+    unsigned int lanes;
+    unsigned int stride;        // lanes rounded up to ENSEMBLE_BLOCK
+    unsigned int memorySize;
+    bool vectorized;
+
+    // per-lane registers, padding lanes never run
+    std::vector<uint32_t> ac;
+    std::vector<uint32_t> io;
+    std::vector<uint32_t> pc;
+    std::vector<uint32_t> pf;
+    std::vector<uint32_t> overflow;     // 0 or 1
+    std::vector<uint32_t> switches;     // sense switch bits, bit 0 = switch 1
+    std::vector<uint32_t> running;      // 0 or ~0
+    std::vector<PDPHaltReason> halt;
+    std::vector<uint64_t> retired;      // set when a lane stops
+    unsigned int active;                // lanes still running
+
+    std::vector<uint32_t> cm;           // interleaved core memory
+
+    uint64_t steps = 0;
+
+    // scratch space for the divergent path
+    std::vector<uint32_t> fetched;
+    std::vector<uint32_t> group;
+    std::vector<uint32_t> pending;
+
+    uint32_t &word(unsigned int lane, unsigned int addr) { return cm[static_cast<size_t>(addr) * stride + lane]; }
+
+    unsigned int effectiveAddress(unsigned int lane, unsigned int addr, bool indirect);
+
+    void executeLane(unsigned int lane, unsigned long instr);
+
+    // executeLane, stopping the lane if an indirect chain is too long
+    void runLane(unsigned int lane, unsigned long instr);
+
+    // fetched is false for a lane stopped before its fetch (its PC outside memory), which, as with
+    // PDPProcessor, retires no instruction in the step that stops it
+    void stop(unsigned int lane, PDPHaltReason reason, bool fetched = true);
+
+    void stepScalar();
+
+    void stepVector();
+
+    // mask holds 0 or ~0 per lane; lanes before from are not in the group
+    void executeGroup(unsigned long instr, const uint32_t *mask, unsigned int from);
+
+    bool executeGroupVector(unsigned long instr, const uint32_t *mask, unsigned int from);
+
+public:
+
+    /**
+     * Creates the lanes, each starting from the same tape image at PC 0.
+     * @param settings: shared settings (extend mode, budget and time limit; sense switches are the
+     *                  initial switches of every lane). PDPEngine::INTERPRETER selects the scalar
+     *                  fallback even on hosts with AVX2.
+     * @param lanes: number of machines
+     * @param image: tape image loaded into every lane's memory
+     * @throws TapeFormatError if the image does not fit in memory
+     */
+    PDPEnsemble(const PDPSettings &settings, unsigned int lanes, const std::vector<WORD> &image);
+
+    /**
+     * @return true if steps run on AVX2 kernels, false if on the scalar fallback
+     */
+    bool isVectorized() const { return vectorized; }
+
+    unsigned int size() const { return lanes; }
+
+    void setSenseSwitches(unsigned int lane, std::bitset<6> senseSwitches) { switches[lane] = senseSwitches.to_ulong(); }
+
+    /**
+     * Changes one word of one lane's memory (e.g. to vary the initial memory before run()).
+     */
+    void setWord(unsigned int lane, unsigned int addr, WORD value) { word(lane, addr) = value.value; }
+
+    /**
+     * Runs one lockstep step: one instruction on every running lane.
+     * @return whether any lane is still running
+     */
+    bool step();
+
+    /**
+     * Runs until every lane has stopped, the instruction budget is spent, or the time limit
+     * passes, as PDPProcessor::run does for a single machine.
+     */
+    void run();
+
+    PDPHaltReason haltReason(unsigned int lane) const { return halt[lane]; }
+
+    /**
+     * 64-bit FNV-1a digest of one lane's core memory, as PDPProcessor::memoryDigest.
+     */
+    uint64_t memoryDigest(unsigned int lane) const;
+
+    /**
+     * Writes one lane's summary fields, in the same format as PDPProcessor::writeSummaryFields.
+     */
+    void writeSummaryFields(unsigned int lane, std::ostream &os) const;
+
+};
@@ -0,0 +1,713 @@
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <vector>
+
+#include "PDPJit.hpp"
+#include "PDPTiming.hpp"
+
+#define JIT_CODE_SIZE   (16 << 20)
+#define JIT_BLOCK_SLACK 16384   // more than the largest block JIT_MAX_BLOCK instructions can produce
+
+#define NO_BLOCK        -1
+#define UNTRANSLATABLE  -2
+
+#if defined(__x86_64__)
+
+namespace {
+
+enum Reg { RAX = 0, RCX = 1, RDX = 2, RBX = 3, RSP = 4, RBP = 5, RSI = 6, RDI = 7, R12 = 12, R13 = 13, R14 = 14, R15 = 15 };
+
+// register assignment inside translated code (all callee-saved, so helpers could be called freely)
+constexpr int CTX = RBX;
+constexpr int CM  = R12;
+constexpr int MAP = R13;
+constexpr int AC  = R14;
+constexpr int IO  = R15;
+
+// group 1 / shift opcode extensions
+enum Ext { ADD = 0, OR = 1, AND = 4, SUB = 5, XOR = 6, CMP = 7, SHL = 4, SHR = 5 };
+
+// condition codes
+enum Cond { CC_AE = 0x3, CC_E = 0x4, CC_NE = 0x5 };
+
+constexpr int32_t OFF_CM       = offsetof(PDPJitContext, cm);
+constexpr int32_t OFF_CODEMAP  = offsetof(PDPJitContext, codeMap);
+constexpr int32_t OFF_RETIRED  = offsetof(PDPJitContext, retired);
+constexpr int32_t OFF_CYCLES   = offsetof(PDPJitContext, cycles);
+constexpr int32_t OFF_LIMIT    = offsetof(PDPJitContext, limit);
+constexpr int32_t OFF_AC       = offsetof(PDPJitContext, ac);
+constexpr int32_t OFF_IO       = offsetof(PDPJitContext, io);
+constexpr int32_t OFF_PC       = offsetof(PDPJitContext, pc);
+constexpr int32_t OFF_SMC      = offsetof(PDPJitContext, smcAddr);
+constexpr int32_t OFF_OVERFLOW = offsetof(PDPJitContext, overflow);
+constexpr int32_t OFF_PF       = offsetof(PDPJitContext, pf);
+constexpr int32_t OFF_EXTEND   = offsetof(PDPJitContext, extend);
+
+/**
+ * Minimal x86-64 encoder for the handful of instruction forms the translator needs.
+ * Memory operands are always [base + disp32]; "reg" arguments double as opcode extensions.
+ */
+struct Emitter {
+    uint8_t *p;
+
+    void b(uint8_t v) { *p++ = v; }
+    void d(uint32_t v) { std::memcpy(p, &v, 4); p += 4; }
+
+    void rex(bool w, int reg, int rm) {
+        uint8_t r = 0x40 | (w ? 8 : 0) | ((reg & 8) ? 4 : 0) | ((rm & 8) ? 1 : 0);
+        if (r != 0x40) b(r);
+    }
+
+    void modrmMem(int reg, int base, int32_t disp) {
+        b(0x80 | ((reg & 7) << 3) | (base & 7));
+        if ((base & 7) == RSP) b(0x24);
+        d(disp);
+    }
+
+    // op reg, [base + disp]
+    void mem(uint8_t op, int reg, int base, int32_t disp, bool w = false) {
+        rex(w, reg, base);
+        b(op);
+        modrmMem(reg, base, disp);
+    }
+
+    // op rm, reg
+    void rr(uint8_t op, int reg, int rm, bool w = false) {
+        rex(w, reg, rm);
+        b(op);
+        b(0xC0 | ((reg & 7) << 3) | (rm & 7));
+    }
+
+    void movRegMem(int r, int base, int32_t disp, bool w = false) { mem(0x8B, r, base, disp, w); }
+    void movMemReg(int base, int32_t disp, int r) { mem(0x89, r, base, disp); }
+    void movMemImm(int base, int32_t disp, uint32_t imm) { mem(0xC7, 0, base, disp); d(imm); }
+    void movRegReg(int dst, int src) { rr(0x89, src, dst); }
+    void movRegImm(int r, uint32_t imm) { rex(false, 0, r); b(0xB8 + (r & 7)); d(imm); }
+    void movzxRegByteMem(int r, int base, int32_t disp) { rex(false, r, base); b(0x0F); b(0xB6); modrmMem(r, base, disp); }
+
+    void addRegReg(int dst, int src) { rr(0x01, src, dst); }
+    void orRegReg(int dst, int src)  { rr(0x09, src, dst); }
+    void andRegReg(int dst, int src) { rr(0x21, src, dst); }
+    void subRegReg(int dst, int src) { rr(0x29, src, dst); }
+    void xorRegReg(int dst, int src) { rr(0x31, src, dst); }
+    void testRegReg(int a, int c)    { rr(0x85, c, a); }
+    void notReg(int r)               { rr(0xF7, 2, r); }
+
+    void aluRegImm(int ext, int r, uint32_t imm) { rr(0x81, ext, r); d(imm); }
+    void testRegImm(int r, uint32_t imm) { rr(0xF7, 0, r); d(imm); }
+    void shiftImm(int ext, int r, uint8_t n) { rr(0xC1, ext, r); b(n); }
+
+    void cmov(int cc, int dst, int src) { rex(false, dst, src); b(0x0F); b(0x40 | cc); b(0xC0 | ((dst & 7) << 3) | (src & 7)); }
+
+    // only al/cl/dl/bl, which need no REX prefix
+    void setcc(int cc, int r8) { b(0x0F); b(0x90 | cc); b(0xC0 | r8); }
+    void orReg8Reg8(int dst, int src) { b(0x08); b(0xC0 | (src << 3) | dst); }
+
+    void cmpByteMemImm(int base, int32_t disp, uint8_t imm)  { mem(0x80, 7, base, disp); b(imm); }
+    void testByteMemImm(int base, int32_t disp, uint8_t imm) { mem(0xF6, 0, base, disp); b(imm); }
+    void movByteMemImm(int base, int32_t disp, uint8_t imm)  { mem(0xC6, 0, base, disp); b(imm); }
+    void orByteMemReg8(int base, int32_t disp, int r8)       { mem(0x08, r8, base, disp); }
+
+    // returns the address of the rel32 operand, to be filled in with patch()
+    uint8_t *jcc(int cc) { b(0x0F); b(0x80 | cc); uint8_t *at = p; d(0); return at; }
+    uint8_t *jmp() { b(0xE9); uint8_t *at = p; d(0); return at; }
+
+    static void patch(uint8_t *at, const uint8_t *dest) {
+        int32_t rel = static_cast<int32_t>(dest - (at + 4));
+        std::memcpy(at, &rel, 4);
+    }
+};
+
+}
+
+PDPJit::PDPJit(const PDPSettings &settings_in, unsigned int memorySize_in)
+        : settings{settings_in}, memorySize{memorySize_in},
+          blockAt(memorySize_in, NO_BLOCK), coveredBy(memorySize_in), codeMap(memorySize_in, 0) {
+    // W^X: the cache is one memfd mapped twice, writable for emitting and patching and executable
+    // for running, so no page is ever both
+    int fd = memfd_create("pdp1-jit", MFD_CLOEXEC);
+    if (fd < 0) return;
+    void *writable = MAP_FAILED;
+    void *executable = MAP_FAILED;
+    if (ftruncate(fd, JIT_CODE_SIZE) == 0) {
+        writable = mmap(nullptr, JIT_CODE_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        executable = mmap(nullptr, JIT_CODE_SIZE, PROT_READ | PROT_EXEC, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (writable == MAP_FAILED || executable == MAP_FAILED) {
+        if (writable != MAP_FAILED) munmap(writable, JIT_CODE_SIZE);
+        if (executable != MAP_FAILED) munmap(executable, JIT_CODE_SIZE);
+        return;
+    }
+
+    code = static_cast<uint8_t *>(writable);
+    execCode = static_cast<uint8_t *>(executable);
+    codeSize = JIT_CODE_SIZE;
+    emitTrampolines();
+}
+
+PDPJit::~PDPJit() {
+    if (code) {
+        munmap(code, codeSize);
+        munmap(execCode, codeSize);
+    }
+}
+
+void PDPJit::emitTrampolines() {
+    Emitter e{code};
+
+    // uint32_t enter(PDPJitContext *ctx, uint8_t *entry)
+    enterStub = e.p;
+    e.b(0x53);                      // push rbx
+    e.b(0x41); e.b(0x54);           // push r12
+    e.b(0x41); e.b(0x55);           // push r13
+    e.b(0x41); e.b(0x56);           // push r14
+    e.b(0x41); e.b(0x57);           // push r15
+    e.rr(0x89, RDI, CTX, true);     // mov rbx, rdi
+    e.movRegMem(CM, CTX, OFF_CM, true);
+    e.movRegMem(MAP, CTX, OFF_CODEMAP, true);
+    e.movRegMem(AC, CTX, OFF_AC);
+    e.movRegMem(IO, CTX, OFF_IO);
+    e.rr(0xFF, 4, RSI);             // jmp rsi
+
+    commonExit = e.p;
+    e.xorRegReg(RAX, RAX);
+
+    epilogue = e.p;
+    e.movMemReg(CTX, OFF_AC, AC);
+    e.movMemReg(CTX, OFF_IO, IO);
+    e.b(0x41); e.b(0x5F);           // pop r15
+    e.b(0x41); e.b(0x5E);           // pop r14
+    e.b(0x41); e.b(0x5D);           // pop r13
+    e.b(0x41); e.b(0x5C);           // pop r12
+    e.b(0x5B);                      // pop rbx
+    e.b(0xC3);                      // ret
+
+    blockArea = e.p;
+    flush();
+}
+
+void PDPJit::flush() {
+    blocks.clear();
+    links.clear();
+    pendingLinks.clear();
+    std::fill(begin(blockAt), end(blockAt), NO_BLOCK);
+    for (auto &v : coveredBy) v.clear();
+    std::fill(begin(codeMap), end(codeMap), 0);
+    codeEnd = blockArea;
+}
+
+void PDPJit::patchLink(const Link &link, uint8_t *dest) {
+    Emitter::patch(link.patch, dest);
+}
+
+uint8_t *PDPJit::lookup(unsigned int addr, const std::vector<WORD> &cm) {
+    if (addr >= memorySize) return nullptr;
+    int32_t id = blockAt[addr];
+    if (id == NO_BLOCK) id = translate(addr, cm);
+    if (id < 0) return nullptr;
+    return executable(blocks[id].entry);
+}
+
+uint32_t PDPJit::run(PDPJitContext &ctx, uint8_t *entry) {
+    ctx.codeMap = codeMap.data();
+    auto enter = reinterpret_cast<uint32_t (*)(PDPJitContext *, uint8_t *)>(executable(enterStub));
+    return enter(&ctx, entry);
+}
+
+int32_t PDPJit::translate(uint32_t start, const std::vector<WORD> &cm) {
+    if (codeEnd + JIT_BLOCK_SLACK > code + codeSize) flush();
+
+    struct SmcStub {
+        uint8_t    *jump;
+        uint32_t    store;
+        uint32_t    next;
+        uint32_t    retired;
+        uint32_t    cycles;
+        bool        ispSkip;
+    };
+    std::vector<SmcStub> smcStubs;
+    std::vector<std::pair<uint8_t *, uint32_t>> exits;
+
+    Emitter e{codeEnd};
+    uint8_t *entry = e.p;
+
+    uint32_t addr = start;
+    uint32_t count = 0;
+    uint32_t cycles = 0;        // taken by the first count instructions
+    uint32_t here = 0;          // taken by the instruction being translated
+    bool terminated = false;
+
+    // leave the block for target, chaining straight into its translation once one exists
+    auto exitTo = [&](uint32_t target, uint32_t retired, uint32_t taken) {
+        e.movMemImm(CTX, OFF_PC, target);
+        e.mem(0x81, ADD, CTX, OFF_RETIRED, true);
+        e.d(retired);
+        e.mem(0x81, ADD, CTX, OFF_CYCLES, true);
+        e.d(taken);
+        e.movRegMem(RAX, CTX, OFF_RETIRED, true);
+        e.mem(0x3B, RAX, CTX, OFF_LIMIT, true);
+        Emitter::patch(e.jcc(CC_AE), commonExit);
+        uint8_t *site = e.jmp();
+        Emitter::patch(site, commonExit);
+        exits.emplace_back(site, target);
+    };
+
+    // after a store to y, leave the block if y holds translated code
+    auto storeCheck = [&](uint32_t y, bool ispSkip) {
+        e.cmpByteMemImm(MAP, y, 0);
+        smcStubs.push_back({e.jcc(CC_NE), y, addr + 1, count + 1, cycles + here, ispSkip});
+    };
+
+    // dst = src shifted by n; n == 0 and n == 18 are fine since results are masked to 18 bits
+    auto part = [&](int dst, int src, int dir, uint8_t n) {
+        e.movRegReg(dst, src);
+        e.shiftImm(dir, dst, n);
+    };
+    auto orPart = [&](int dst, int src, int dir, uint8_t n) {
+        e.movRegReg(RCX, src);
+        e.shiftImm(dir, RCX, n);
+        e.orRegReg(dst, RCX);
+    };
+
+    while (!terminated && count < JIT_MAX_BLOCK && addr < memorySize) {
+        uint32_t instr = cm[addr].value;
+        uint32_t opcode6 = (instr >> 12) & 076;
+        bool indirect = instr & 0010000;
+        uint32_t y = instr & 07777;
+        int32_t ym = y * 4;
+        // translated instructions never indirect, so their timing is fixed
+        here = instructionCycles(instr);
+
+        // indirect memory references go through the interpreter's chain walk
+        bool memoryReference = opcode6 <= 056 && opcode6 != 016 && opcode6 != 010;
+        if (memoryReference && indirect) break;
+
+        bool ok = true;
+        switch (opcode6) {
+        case 020:
+            // lac
+            e.movRegMem(AC, CM, ym);
+            break;
+
+        case 022:
+            // lio
+            e.movRegMem(IO, CM, ym);
+            break;
+
+        case 024:
+            // dac
+            e.movMemReg(CM, ym, AC);
+            storeCheck(y, false);
+            break;
+
+        case 032:
+            // dio
+            e.movMemReg(CM, ym, IO);
+            storeCheck(y, false);
+            break;
+
+        case 034:
+            // dzm
+            e.movMemImm(CM, ym, 0);
+            storeCheck(y, false);
+            break;
+
+        case 026:
+        case 030:
+            {
+                // dap / dip
+                bool dap = opcode6 == 026;
+                e.movRegMem(RAX, CM, ym);
+                e.aluRegImm(AND, RAX, dap ? 0770000 : 0017777);
+                e.movRegReg(RCX, AC);
+                e.aluRegImm(AND, RCX, dap ? 0007777 : 0760000);
+                e.orRegReg(RAX, RCX);
+                e.movMemReg(CM, ym, RAX);
+                storeCheck(y, false);
+                break;
+            }
+
+        case 002:
+            // and
+            e.mem(0x23, AC, CM, ym);
+            break;
+
+        case 004:
+            // ior
+            e.mem(0x0B, AC, CM, ym);
+            break;
+
+        case 006:
+            // xor
+            e.mem(0x33, AC, CM, ym);
+            break;
+
+        case 040:
+            // add: end-around carry, fold -0 to +0, overflow on same-signed operands changing sign
+            e.movRegMem(RAX, CM, ym);
+            e.movRegReg(RDX, AC);
+            e.addRegReg(RDX, RAX);
+            e.movRegReg(RCX, RDX);
+            e.shiftImm(SHR, RCX, 18);
+            e.aluRegImm(AND, RDX, 0777777);
+            e.addRegReg(RDX, RCX);
+            e.xorRegReg(RCX, RCX);
+            e.aluRegImm(CMP, RDX, MINUS_ZERO);
+            e.cmov(CC_E, RDX, RCX);
+            e.xorRegReg(RAX, AC);
+            e.notReg(RAX);
+            e.movRegReg(RCX, AC);
+            e.xorRegReg(RCX, RDX);
+            e.andRegReg(RAX, RCX);
+            e.testRegImm(RAX, 0400000);
+            e.setcc(CC_NE, RAX);
+            e.orByteMemReg8(CTX, OFF_OVERFLOW, RAX);
+            e.movRegReg(AC, RDX);
+            break;
+
+        case 042:
+            // sub: borrow means subtract one more, fold -0 to +0, overflow when the sign changes
+            e.movRegMem(RAX, CM, ym);
+            e.movRegReg(RDX, AC);
+            e.aluRegImm(OR, RDX, 01000000);
+            e.subRegReg(RDX, RAX);
+            e.movRegReg(RCX, RDX);
+            e.shiftImm(SHR, RCX, 18);
+            e.aluRegImm(XOR, RCX, 1);
+            e.subRegReg(RDX, RCX);
+            e.aluRegImm(AND, RDX, 0777777);
+            e.xorRegReg(RCX, RCX);
+            e.aluRegImm(CMP, RDX, MINUS_ZERO);
+            e.cmov(CC_E, RDX, RCX);
+            e.movRegReg(RAX, AC);
+            e.xorRegReg(RAX, RDX);
+            e.testRegImm(RAX, 0400000);
+            e.setcc(CC_NE, RAX);
+            e.orByteMemReg8(CTX, OFF_OVERFLOW, RAX);
+            e.movRegReg(AC, RDX);
+            break;
+
+        case 044:
+        case 046:
+            {
+                // idx / isp: intToOnesComplement(onesComplementToInt(C(Y)) + 1), which is C(Y) + 1
+                // except -1 -> +0, -0 -> +1 and 0377777 -> +0
+                bool isp = opcode6 == 046;
+                e.movRegMem(RAX, CM, ym);
+                e.movRegReg(RDX, RAX);
+                e.aluRegImm(ADD, RDX, 1);
+                e.xorRegReg(RCX, RCX);
+                e.aluRegImm(CMP, RAX, 0777776);
+                e.cmov(CC_E, RDX, RCX);
+                e.aluRegImm(CMP, RAX, 0377777);
+                e.cmov(CC_E, RDX, RCX);
+                e.movRegImm(RCX, 1);
+                e.aluRegImm(CMP, RAX, MINUS_ZERO);
+                e.cmov(CC_E, RDX, RCX);
+                e.movRegReg(AC, RDX);
+                e.movMemReg(CM, ym, RDX);
+                storeCheck(y, isp);
+                if (isp) {
+                    // skip when the new value is not negative
+                    e.testRegImm(AC, 0400000);
+                    uint8_t *skip = e.jcc(CC_E);
+                    exitTo(addr + 1, count + 1, cycles + here);
+                    Emitter::patch(skip, e.p);
+                    exitTo(addr + 2, count + 1, cycles + here);
+                    terminated = true;
+                }
+                break;
+            }
+
+        case 050:
+        case 052:
+            {
+                // sad / sas
+                e.mem(0x3B, AC, CM, ym);
+                uint8_t *skip = e.jcc(opcode6 == 050 ? CC_NE : CC_E);
+                exitTo(addr + 1, count + 1, cycles + here);
+                Emitter::patch(skip, e.p);
+                exitTo(addr + 2, count + 1, cycles + here);
+                terminated = true;
+                break;
+            }
+
+        case 060:
+            // jmp; "jmp i 1" may dismiss a sequence break, which the interpreter handles
+            if (indirect && y == 1) {
+                ok = false;
+                break;
+            }
+            exitTo(y, count + 1, cycles + here);
+            terminated = true;
+            break;
+
+        case 062:
+            {
+                // jsp: AC gets the return address with overflow and extend in bits 17 and 16; extend
+                // comes from the context, as "jmp i 1" can change it after the block is translated
+                e.movzxRegByteMem(RAX, CTX, OFF_OVERFLOW);
+                e.shiftImm(SHL, RAX, 1);
+                e.movzxRegByteMem(RCX, CTX, OFF_EXTEND);
+                e.orRegReg(RAX, RCX);
+                e.shiftImm(SHL, RAX, 16);
+                e.aluRegImm(OR, RAX, (addr + 1) & 0177777);
+                e.movRegReg(AC, RAX);
+                exitTo(y, count + 1, cycles + here);
+                terminated = true;
+                break;
+            }
+
+        case 070:
+            // law
+            e.movRegImm(AC, intToOnesComplement((indirect ? -1 : 1) * static_cast<int>(y)).value);
+            break;
+
+        case 064:
+            {
+                // skip group: OR the selected conditions into al
+                e.xorRegReg(RAX, RAX);
+                if (y & 00100) {
+                    e.testRegReg(AC, AC);
+                    e.setcc(CC_E, RCX);
+                    e.orReg8Reg8(RAX, RCX);
+                }
+                if (y & 00200) {
+                    e.testRegImm(AC, 0400000);
+                    e.setcc(CC_E, RCX);
+                    e.orReg8Reg8(RAX, RCX);
+                }
+                if (y & 00400) {
+                    e.testRegImm(AC, 0400000);
+                    e.setcc(CC_NE, RCX);
+                    e.orReg8Reg8(RAX, RCX);
+                }
+                if (y & 01000) {
+                    e.cmpByteMemImm(CTX, OFF_OVERFLOW, 0);
+                    e.setcc(CC_E, RCX);
+                    e.orReg8Reg8(RAX, RCX);
+                    e.movByteMemImm(CTX, OFF_OVERFLOW, 0);
+                }
+                if (y & 02000) {
+                    e.testRegImm(IO, 0400000);
+                    e.setcc(CC_E, RCX);
+                    e.orReg8Reg8(RAX, RCX);
+                }
+                if (y & 00070) {
+                    // sense switches are fixed for the whole run
+                    unsigned int sw = (y >> 3) & 07;
+                    bool on = (sw == 7) ? settings.senseSwitches.all() : settings.senseSwitches[sw - 1];
+                    if (on) { e.b(0x0C); e.b(1); }     // or al, 1
+                }
+                if (y & 00007) {
+                    unsigned int flag = y & 07;
+                    if (flag == 7) {
+                        e.cmpByteMemImm(CTX, OFF_PF, 077);
+                        e.setcc(CC_E, RCX);
+                    } else {
+                        e.testByteMemImm(CTX, OFF_PF, 1 << (flag - 1));
+                        e.setcc(CC_NE, RCX);
+                    }
+                    e.orReg8Reg8(RAX, RCX);
+                }
+                if (indirect) { e.b(0x34); e.b(1); }   // xor al, 1
+                e.b(0x84); e.b(0xC0);                   // test al, al
+
+                uint8_t *skip = e.jcc(CC_NE);
+                exitTo(addr + 1, count + 1, cycles + here);
+                Emitter::patch(skip, e.p);
+                exitTo(addr + 2, count + 1, cycles + here);
+                terminated = true;
+                break;
+            }
+
+        case 066:
+            {
+                // shift group
+                uint8_t n = __builtin_popcount(instr & 0777);
+                uint8_t m = 18 - n;
+                bool ac = true, io = true;
+                switch ((instr >> 9) & 0777) {
+                case 0671: part(RAX, AC, SHR, n); orPart(RAX, AC, SHL, m); io = false; break;    // rar
+                case 0661: part(RAX, AC, SHL, n); orPart(RAX, AC, SHR, m); io = false; break;    // ral
+                case 0675: part(RAX, AC, SHR, n); io = false; break;                             // sar
+                case 0665: part(RAX, AC, SHL, n); io = false; break;                             // sal
+                case 0672: part(RDX, IO, SHR, n); orPart(RDX, IO, SHL, m); ac = false; break;    // rir
+                case 0662: part(RDX, IO, SHL, n); orPart(RDX, IO, SHR, m); ac = false; break;    // ril
+                case 0676: part(RDX, IO, SHR, n); ac = false; break;                             // sir
+                case 0666: part(RDX, IO, SHL, n); ac = false; break;                             // sil
+                case 0673:                                                                      // rcr
+                    part(RAX, AC, SHR, n); orPart(RAX, IO, SHL, m);
+                    part(RDX, IO, SHR, n); orPart(RDX, AC, SHL, m);
+                    break;
+                case 0663:                                                                      // rcl
+                    part(RAX, AC, SHL, n); orPart(RAX, IO, SHR, m);
+                    part(RDX, IO, SHL, n); orPart(RDX, AC, SHR, m);
+                    break;
+                case 0677:                                                                      // scr
+                    part(RAX, AC, SHR, n);
+                    part(RDX, IO, SHR, n); orPart(RDX, AC, SHL, m);
+                    break;
+                case 0667:                                                                      // scl
+                    part(RAX, AC, SHL, n); orPart(RAX, IO, SHR, m);
+                    part(RDX, IO, SHL, n);
+                    break;
+                default:
+                    ok = false;
+                    break;
+                }
+                if (!ok) break;
+                if (ac) {
+                    e.aluRegImm(AND, RAX, 0777777);
+                    e.movRegReg(AC, RAX);
+                }
+                if (io) {
+                    e.aluRegImm(AND, RDX, 0777777);
+                    e.movRegReg(IO, RDX);
+                }
+                break;
+            }
+
+        case 076:
+            // operate group; everything but these few is left to the interpreter
+            if (y == 04000) e.xorRegReg(IO, IO);                    // cli
+            else if (y == 01000) e.aluRegImm(XOR, AC, 0777777);     // cma
+            else if (y == 00200) e.xorRegReg(AC, AC);               // cla
+            else if (y != 00000) ok = false;                        // nop
+            break;
+
+        default:
+            // xct, jda/cal, mul/div, in-out transfers and anything unknown are interpreted
+            ok = false;
+            break;
+        }
+
+        if (!ok) break;
+        ++count;
+        ++addr;
+        cycles += here;
+    }
+
+    if (count == 0) {
+        // nothing to translate here; remember that until the word is written
+        blockAt[start] = UNTRANSLATABLE;
+        codeMap[start] = 1;
+        return UNTRANSLATABLE;
+    }
+
+    if (!terminated) exitTo(addr, count, cycles);
+
+    for (const SmcStub &s : smcStubs) {
+        Emitter::patch(s.jump, e.p);
+        e.movMemImm(CTX, OFF_SMC, s.store);
+        e.movMemImm(CTX, OFF_PC, s.next);
+        if (s.ispSkip) {
+            // pc += (AC is not negative)
+            e.movRegReg(RAX, AC);
+            e.shiftImm(SHR, RAX, 17);
+            e.aluRegImm(XOR, RAX, 1);
+            e.mem(0x01, RAX, CTX, OFF_PC);
+        }
+        e.mem(0x81, ADD, CTX, OFF_RETIRED, true);
+        e.d(s.retired);
+        e.mem(0x81, ADD, CTX, OFF_CYCLES, true);
+        e.d(s.cycles);
+        e.movRegImm(RAX, JIT_EXIT_SMC);
+        Emitter::patch(e.jmp(), epilogue);
+    }
+
+    codeEnd = e.p;
+
+    uint32_t id = blocks.size();
+    blocks.push_back({start, start + count, entry, true, {}});
+    blockAt[start] = id;
+    for (uint32_t a = start; a < start + count; ++a) {
+        coveredBy[a].push_back(id);
+        codeMap[a] = 1;
+    }
+
+    // chain this block's exits into existing blocks
+    for (auto &[site, target] : exits) {
+        uint32_t linkId = links.size();
+        links.push_back({site, target, id});
+        if (target < memorySize && blockAt[target] >= 0) {
+            Block &t = blocks[blockAt[target]];
+            patchLink(links[linkId], t.entry);
+            t.incoming.push_back(linkId);
+        } else {
+            pendingLinks[target].push_back(linkId);
+        }
+    }
+
+    // and chain earlier blocks' exits into this one
+    auto it = pendingLinks.find(start);
+    if (it != end(pendingLinks)) {
+        for (uint32_t linkId : it->second) {
+            if (!blocks[links[linkId].owner].alive) continue;
+            patchLink(links[linkId], entry);
+            blocks[id].incoming.push_back(linkId);
+        }
+        pendingLinks.erase(it);
+    }
+
+    return id;
+}
+
+void PDPJit::invalidate(unsigned int addr) {
+    if (blockAt[addr] == UNTRANSLATABLE) blockAt[addr] = NO_BLOCK;
+
+    std::vector<uint32_t> dead = coveredBy[addr];
+    for (uint32_t id : dead) {
+        Block &b = blocks[id];
+        b.alive = false;
+        if (blockAt[b.start] == static_cast<int32_t>(id)) blockAt[b.start] = NO_BLOCK;
+
+        // unchain everything jumping into the dead block; relink if it gets retranslated
+        for (uint32_t linkId : b.incoming) {
+            if (!blocks[links[linkId].owner].alive) continue;
+            patchLink(links[linkId], commonExit);
+            pendingLinks[b.start].push_back(linkId);
+        }
+        b.incoming.clear();
+
+        for (uint32_t a = b.start; a < b.end; ++a) {
+            auto &v = coveredBy[a];
+            v.erase(std::remove(begin(v), end(v), id), end(v));
+            codeMap[a] = !v.empty() || blockAt[a] == UNTRANSLATABLE;
+        }
+    }
+
+    codeMap[addr] = !coveredBy[addr].empty();
+}
+
+#else
+
+// no translator for this host; available() stays false and the processor falls back
+
+PDPJit::PDPJit(const PDPSettings &settings_in, unsigned int memorySize_in)
+        : settings{settings_in}, memorySize{memorySize_in} {}
+
+PDPJit::~PDPJit() {}
+
+void PDPJit::emitTrampolines() {}
+
+void PDPJit::flush() {}
+
+void PDPJit::patchLink(const Link &link, uint8_t *dest) {}
+
+int32_t PDPJit::translate(uint32_t start, const std::vector<WORD> &cm) { return UNTRANSLATABLE; }
+
+uint8_t *PDPJit::lookup(unsigned int addr, const std::vector<WORD> &cm) { return nullptr; }
+
+uint32_t PDPJit::run(PDPJitContext &ctx, uint8_t *entry) { return JIT_EXIT_NORMAL; }
+
+void PDPJit::invalidate(unsigned int addr) {}
+
+#endif
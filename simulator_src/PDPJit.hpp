@@ -0,0 +1,135 @@
+//
+// PDP-1 Simulator
+// x86-64 Dynamic Binary Translator
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "PDPSettings.hpp"
+#include "PDPWord.hpp"
+
+/**
+ * Processor state shared with translated code. Translated blocks keep AC and IO in host
+ * registers and read everything else through this struct, so its layout is part of the
+ * generated code's ABI (see the offsetof uses in PDPJit.cpp).
+ */
+struct PDPJitContext {
+    uint32_t       *cm       = nullptr;   // core memory, one packed WORD per element
+    const uint8_t  *codeMap  = nullptr;   // nonzero for addresses covered by translated code
+    uint64_t        retired  = 0;         // instructions retired so far
+    uint64_t        limit    = 0;         // blocks return to the dispatcher once retired >= limit
+    uint64_t        cycles   = 0;         // memory cycles taken so far
+    uint32_t        ac       = 0;
+    uint32_t        io       = 0;
+    uint32_t        pc       = 0;
+    uint32_t        smcAddr  = 0;         // address written when a block exits with JIT_EXIT_SMC
+    uint8_t         overflow = 0;
+    uint8_t         pf       = 0;
+    uint8_t         extend   = 0;         // extend mode, which dismissing a sequence break can change
+};
+
+static_assert(sizeof(WORD) == sizeof(uint32_t), "translated code indexes core memory as uint32_t");
+
+// longest translated block, i.e. the most instructions a block can retire past its limit check
+#define JIT_MAX_BLOCK   64
+
+#define JIT_EXIT_NORMAL 0
+#define JIT_EXIT_SMC    1
+
+class PDPJit {
+
+private:
+
+    struct Block {
+        uint32_t                start;
+        uint32_t                end;        // one past the last covered address
+        uint8_t                *entry;
+        bool                    alive;
+        std::vector<uint32_t>   incoming;   // links currently patched to jump into this block
+    };
+
+    struct Link {
+        uint8_t    *patch;      // rel32 operand of the chaining jmp
+        uint32_t    target;
+        uint32_t    owner;
+    };
+
+    PDPSettings settings;
+    unsigned int memorySize;
+
+    // the code cache's writable view; every pointer below is into it. Code runs from the same bytes
+    // through execCode, and since the two views are the same distance apart everywhere, rel32 jumps
+    // patched through one are right in the other.
+    uint8_t *code = nullptr;
+    uint8_t *execCode = nullptr;
+    size_t codeSize = 0;
+    uint8_t *codeEnd = nullptr;
+
+    uint8_t *enterStub = nullptr;
+    uint8_t *commonExit = nullptr;
+    uint8_t *epilogue = nullptr;
+    uint8_t *blockArea = nullptr;
+
+    std::vector<Block> blocks;
+    std::vector<Link> links;
+    std::vector<int32_t> blockAt;                   // block starting at address, or NO_BLOCK / UNTRANSLATABLE
+    std::vector<std::vector<uint32_t>> coveredBy;   // blocks covering each address
+    std::vector<uint8_t> codeMap;
+    std::unordered_map<uint32_t, std::vector<uint32_t>> pendingLinks;   // unchained links by target
+
+    uint8_t *executable(uint8_t *p) const { return execCode + (p - code); }
+
+    void emitTrampolines();
+
+    void flush();
+
+    void patchLink(const Link &link, uint8_t *dest);
+
+    int32_t translate(uint32_t addr, const std::vector<WORD> &cm);
+
+public:
+
+    /**
+     * Maps the code cache, once writable and once executable. If that fails, or the host is not
+     * x86-64, available() is false.
+     * @param settings: simulator settings (sense switches are folded into the code)
+     * @param memorySize: number of core memory words
+     */
+    PDPJit(const PDPSettings &settings, unsigned int memorySize);
+
+    ~PDPJit();
+
+    PDPJit(const PDPJit &) = delete;
+    PDPJit &operator=(const PDPJit &) = delete;
+
+    bool available() const { return code != nullptr; }
+
+    const uint8_t *codeMapData() const { return codeMap.data(); }
+
+    bool isCode(unsigned int addr) const { return codeMap[addr]; }
+
+    /**
+     * Returns the entry point of the translated block starting at addr, translating it first if needed.
+     * @return the block entry, in the executable view, or nullptr if the instruction at addr has to
+     *         be interpreted
+     */
+    uint8_t *lookup(unsigned int addr, const std::vector<WORD> &cm);
+
+    /**
+     * Runs translated code starting at entry until a block exit finds ctx.retired >= ctx.limit,
+     * an untranslated address is reached, or a store hits translated code.
+     * @return JIT_EXIT_NORMAL or JIT_EXIT_SMC
+     */
+    uint32_t run(PDPJitContext &ctx, uint8_t *entry);
+
+    /**
+     * Drops every translated block covering addr, unlinking any chained jumps into them.
+     */
+    void invalidate(unsigned int addr);
+
+};
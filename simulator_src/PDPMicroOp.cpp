@@ -0,0 +1,466 @@
+
+#include <iostream>
+#include <stdlib.h>
+#include <vector>
+
+#include "PDPMicroOp.hpp"
+#include "PDPState.hpp"
+#include "PDPTiming.hpp"
+
+// decoding
+
+template <class Policy>
+PDPMicroOp PDPProcessor::decode(unsigned long instr) {
+    PDPMicroOp op;
+    op.instr = instr;
+    op.indirect = (instr & 0010000);
+    op.operand = instr & 07777;
+    op.cycles = instructionCycles(instr);
+
+    unsigned long opcode6 = (instr >> 12) & 076;
+
+    switch (opcode6) {
+    case 040: op.handler = &PDPProcessor::opAdd<Policy>; break;
+    case 042: op.handler = &PDPProcessor::opSub<Policy>; break;
+    case 054: op.handler = &PDPProcessor::opMul<Policy>; break;
+    case 056: op.handler = &PDPProcessor::opDiv<Policy>; break;
+    case 044: op.handler = &PDPProcessor::opIdx<Policy>; break;
+    case 046: op.handler = &PDPProcessor::opIsp<Policy>; break;
+    case 002: op.handler = &PDPProcessor::opAnd<Policy>; break;
+    case 006: op.handler = &PDPProcessor::opXor<Policy>; break;
+    case 004: op.handler = &PDPProcessor::opIor<Policy>; break;
+    case 020: op.handler = &PDPProcessor::opLac<Policy>; break;
+    case 024: op.handler = &PDPProcessor::opDac<Policy>; break;
+    case 026: op.handler = &PDPProcessor::opDap<Policy>; break;
+    case 030: op.handler = &PDPProcessor::opDip<Policy>; break;
+    case 022: op.handler = &PDPProcessor::opLio<Policy>; break;
+    case 032: op.handler = &PDPProcessor::opDio<Policy>; break;
+    case 034: op.handler = &PDPProcessor::opDzm<Policy>; break;
+    case 010: op.handler = &PDPProcessor::opXct<Policy>; break;
+    case 060: op.handler = (op.indirect && op.operand == 1) ? &PDPProcessor::opDismiss : &PDPProcessor::opJmp; break;
+    case 062: op.handler = &PDPProcessor::opJsp; break;
+    case 016: op.handler = op.indirect ? &PDPProcessor::opJda<Policy> : &PDPProcessor::opCal<Policy>; break;
+    case 050: op.handler = &PDPProcessor::opSad<Policy>; break;
+    case 052: op.handler = &PDPProcessor::opSas<Policy>; break;
+
+    case 070:
+        // law: the new AC value is known at decode time
+        op.handler = &PDPProcessor::opLaw;
+        op.operand = intToOnesComplement((op.indirect ? -1 : 1) * static_cast<int>(instr & 07777)).value;
+        break;
+
+    case 066:
+        {
+            // shift group: count the shift amount once
+            unsigned int operand9 = instr & 0777;
+            while (operand9) {
+                op.shift += operand9 & 1;
+                operand9 >>= 1;
+            }
+
+            switch ((instr & 0777000) >> 9) {
+            case 0671: op.handler = &PDPProcessor::opRar; break;
+            case 0661: op.handler = &PDPProcessor::opRal; break;
+            case 0675: op.handler = &PDPProcessor::opSar; break;
+            case 0665: op.handler = &PDPProcessor::opSal; break;
+            case 0672: op.handler = &PDPProcessor::opRir; break;
+            case 0662: op.handler = &PDPProcessor::opRil; break;
+            case 0676: op.handler = &PDPProcessor::opSir; break;
+            case 0666: op.handler = &PDPProcessor::opSil; break;
+            case 0673: op.handler = &PDPProcessor::opRcr; break;
+            case 0663: op.handler = &PDPProcessor::opRcl; break;
+            case 0677: op.handler = &PDPProcessor::opScr; break;
+            case 0667: op.handler = &PDPProcessor::opScl; break;
+            default:   op.handler = &PDPProcessor::opIllegal; break;
+            }
+            break;
+        }
+
+    case 064:
+        // skip group: split the condition bits once
+        op.handler = &PDPProcessor::opSkip<Policy>;
+        op.skipMask = op.operand & 03700;
+        op.skipSw = (op.operand >> 3) & 07;
+        op.skipFlag = op.operand & 07;
+        break;
+
+    case 072: op.handler = &PDPProcessor::opIot; break;
+
+    case 076:
+        switch (op.operand) {
+        case 04000: op.handler = &PDPProcessor::opCli; break;
+        case 00100: op.handler = &PDPProcessor::opLap; break;
+        case 01000: op.handler = &PDPProcessor::opCma; break;
+        case 00400: op.handler = &PDPProcessor::opHlt; break;
+        case 00200: op.handler = &PDPProcessor::opCla; break;
+        case 00000: op.handler = &PDPProcessor::opNop; break;
+        default:
+            op.handler = (op.operand & 07) ? &PDPProcessor::opFlag : &PDPProcessor::opIllegal;
+            break;
+        }
+        break;
+
+    default:
+        op.handler = &PDPProcessor::opIllegal;
+        break;
+    }
+
+    return op;
+}
+
+// memory reference instructions
+
+template <class Policy>
+bool PDPProcessor::opAdd(const PDPMicroOp &op) {
+    WORD memoryContents = readMemory<Policy>(op.operand, op.indirect);
+    WORD newAC = onesAdd(state.ac, memoryContents);
+    if (addOverflows(state.ac, memoryContents, newAC)) state.overflow = true;
+    state.ac = newAC;
+    return true;
+}
+
+template <class Policy>
+bool PDPProcessor::opSub(const PDPMicroOp &op) {
+    WORD newAC = onesSub(state.ac, readMemory<Policy>(op.operand, op.indirect));
+    if (state.ac.negative() != newAC.negative()) state.overflow = true;
+    state.ac = newAC;
+    return true;
+}
+
+template <class Policy>
+bool PDPProcessor::opMul(const PDPMicroOp &op) {
+    WordPair product = onesMul(state.ac, readMemory<Policy>(op.operand, op.indirect));
+    state.ac = product.ac;
+    state.io = product.io;
+    return true;
+}
+
+template <class Policy>
+bool PDPProcessor::opDiv(const PDPMicroOp &op) {
+    WordPair result;
+    if (onesDiv({state.ac, state.io}, readMemory<Policy>(op.operand, op.indirect), result)) {
+        state.ac = result.ac;
+        state.io = result.io;
+        skip<Policy>();
+    }
+    return true;
+}
+
+template <class Policy>
+bool PDPProcessor::opIdx(const PDPMicroOp &op) {
+    unsigned int y = effectiveAddress<Policy>(op.operand, op.indirect);
+    int cy = onesComplementToInt(readMemory<Policy>(y, false));
+    state.ac = intToOnesComplement(cy + 1);
+    writeMemory<Policy>(y, false, state.ac);
+    return true;
+}
+
+template <class Policy>
+bool PDPProcessor::opIsp(const PDPMicroOp &op) {
+    unsigned int y = effectiveAddress<Policy>(op.operand, op.indirect);
+    int cy = onesComplementToInt(readMemory<Policy>(y, false));
+    state.ac = intToOnesComplement(cy + 1);
+    writeMemory<Policy>(y, false, state.ac);
+    if (cy + 1 >= 0) skip<Policy>();
+    return true;
+}
+
+template <class Policy>
+bool PDPProcessor::opAnd(const PDPMicroOp &op) {
+    state.ac &= readMemory<Policy>(op.operand, op.indirect);
+    return true;
+}
+
+template <class Policy>
+bool PDPProcessor::opXor(const PDPMicroOp &op) {
+    state.ac ^= readMemory<Policy>(op.operand, op.indirect);
+    return true;
+}
+
+template <class Policy>
+bool PDPProcessor::opIor(const PDPMicroOp &op) {
+    state.ac |= readMemory<Policy>(op.operand, op.indirect);
+    return true;
+}
+
+template <class Policy>
+bool PDPProcessor::opLac(const PDPMicroOp &op) {
+    state.ac = readMemory<Policy>(op.operand, op.indirect);
+    return true;
+}
+
+template <class Policy>
+bool PDPProcessor::opDac(const PDPMicroOp &op) {
+    writeMemory<Policy>(op.operand, op.indirect, state.ac);
+    return true;
+}
+
+template <class Policy>
+bool PDPProcessor::opDap(const PDPMicroOp &op) {
+    WORD ap {state.ac.value & 07777};
+    unsigned int y = effectiveAddress<Policy>(op.operand, op.indirect);
+    WORD cy = readMemory<Policy>(y, false);
+    writeMemory<Policy>(y, false, (cy & WORD{0770000}) | ap);
+    return true;
+}
+
+template <class Policy>
+bool PDPProcessor::opDip(const PDPMicroOp &op) {
+    WORD ip {state.ac.value & 0760000};
+    unsigned int y = effectiveAddress<Policy>(op.operand, op.indirect);
+    WORD cy = readMemory<Policy>(y, false);
+    writeMemory<Policy>(y, false, (cy & WORD{0017777}) | ip);
+    return true;
+}
+
+template <class Policy>
+bool PDPProcessor::opLio(const PDPMicroOp &op) {
+    state.io = readMemory<Policy>(op.operand, op.indirect);
+    return true;
+}
+
+template <class Policy>
+bool PDPProcessor::opDio(const PDPMicroOp &op) {
+    writeMemory<Policy>(op.operand, op.indirect, state.io);
+    return true;
+}
+
+template <class Policy>
+bool PDPProcessor::opDzm(const PDPMicroOp &op) {
+    writeMemory<Policy>(op.operand, op.indirect, WORD{0});
+    return true;
+}
+
+template <class Policy>
+bool PDPProcessor::opXct(const PDPMicroOp &op) {
+    unsigned long toRun = readExecuted<Policy>(op.operand, op.indirect).value;
+    state.cycles += instructionCycles(toRun);
+    executeInstruction<Policy>(toRun);
+    return true;
+}
+
+bool PDPProcessor::opJmp(const PDPMicroOp &op) {
+    state.pc = op.operand;
+    return false;
+}
+
+bool PDPProcessor::opDismiss(const PDPMicroOp &op) {
+    // otherwise jmp ignores the indirect bit
+    if (state.inBreak) dismissBreak();
+    else state.pc = op.operand;
+    return false;
+}
+
+bool PDPProcessor::opJsp(const PDPMicroOp &op) {
+    WORD newAC = {state.pc.value + 1};
+    newAC.set(17, state.overflow);
+    newAC.set(16, state.extend);
+    state.ac = newAC;
+    state.pc = op.operand;
+    return false;
+}
+
+template <class Policy>
+bool PDPProcessor::opJda(const PDPMicroOp &op) {
+    writeMemory<Policy>(op.operand, false, state.ac);
+
+    WORD newAC = {state.pc.value + 1};
+    newAC.set(17, state.overflow);
+    newAC.set(16, state.extend);
+    state.ac = newAC;
+    state.pc = op.operand + 1;
+    return false;
+}
+
+template <class Policy>
+bool PDPProcessor::opCal(const PDPMicroOp &op) {
+    writeMemory<Policy>(0100, false, state.ac);
+
+    WORD newAC = {state.pc.value + 1};
+    newAC.set(17, state.overflow);
+    newAC.set(16, state.extend);
+    state.ac = newAC;
+    state.pc = 0101;
+    return false;
+}
+
+template <class Policy>
+bool PDPProcessor::opSad(const PDPMicroOp &op) {
+    if (readMemory<Policy>(op.operand, op.indirect) != state.ac) skip<Policy>();
+    return true;
+}
+
+template <class Policy>
+bool PDPProcessor::opSas(const PDPMicroOp &op) {
+    if (readMemory<Policy>(op.operand, op.indirect) == state.ac) skip<Policy>();
+    return true;
+}
+
+bool PDPProcessor::opLaw(const PDPMicroOp &op) {
+    state.ac = op.operand;
+    return true;
+}
+
+// shift group
+
+bool PDPProcessor::opRar(const PDPMicroOp &op) {
+    state.ac = state.ac.rotateRight(op.shift);
+    return true;
+}
+
+bool PDPProcessor::opRal(const PDPMicroOp &op) {
+    state.ac = state.ac.rotateLeft(op.shift);
+    return true;
+}
+
+bool PDPProcessor::opSar(const PDPMicroOp &op) {
+    state.ac >>= op.shift;
+    return true;
+}
+
+bool PDPProcessor::opSal(const PDPMicroOp &op) {
+    state.ac <<= op.shift;
+    return true;
+}
+
+bool PDPProcessor::opRir(const PDPMicroOp &op) {
+    state.io = state.io.rotateRight(op.shift);
+    return true;
+}
+
+bool PDPProcessor::opRil(const PDPMicroOp &op) {
+    state.io = state.io.rotateLeft(op.shift);
+    return true;
+}
+
+bool PDPProcessor::opSir(const PDPMicroOp &op) {
+    state.io >>= op.shift;
+    return true;
+}
+
+bool PDPProcessor::opSil(const PDPMicroOp &op) {
+    state.io <<= op.shift;
+    return true;
+}
+
+bool PDPProcessor::opRcr(const PDPMicroOp &op) {
+    WORD newAC = (state.ac >> op.shift) | (state.io << (18 - op.shift));
+    WORD newIO = (state.io >> op.shift) | (state.ac << (18 - op.shift));
+    state.ac = newAC;
+    state.io = newIO;
+    return true;
+}
+
+bool PDPProcessor::opRcl(const PDPMicroOp &op) {
+    WORD newAC = (state.ac << op.shift) | (state.io >> (18 - op.shift));
+    WORD newIO = (state.io << op.shift) | (state.ac >> (18 - op.shift));
+    state.ac = newAC;
+    state.io = newIO;
+    return true;
+}
+
+bool PDPProcessor::opScr(const PDPMicroOp &op) {
+    WORD newAC = state.ac >> op.shift;
+    WORD newIO = (state.io >> op.shift) | (state.ac << (18 - op.shift));
+    state.ac = newAC;
+    state.io = newIO;
+    return true;
+}
+
+bool PDPProcessor::opScl(const PDPMicroOp &op) {
+    WORD newAC = (state.ac << op.shift) | (state.io >> (18 - op.shift));
+    WORD newIO = state.io << op.shift;
+    state.ac = newAC;
+    state.io = newIO;
+    return true;
+}
+
+// skip group
+
+bool PDPProcessor::skipCondition(const PDPMicroOp &op) const {
+    bool conditionMatched = false;
+    if (op.skipMask & 00100) conditionMatched = conditionMatched || state.ac.none();
+    if (op.skipMask & 00200) conditionMatched = conditionMatched || !state.ac.negative();
+    if (op.skipMask & 00400) conditionMatched = conditionMatched || state.ac.negative();
+    if (op.skipMask & 01000) conditionMatched = conditionMatched || !state.overflow;
+    if (op.skipMask & 02000) conditionMatched = conditionMatched || !state.io.negative();
+    if (op.skipSw) {
+        if (op.skipSw == 7) conditionMatched = conditionMatched || settings.senseSwitches.all();
+        else conditionMatched = conditionMatched || settings.senseSwitches[op.skipSw - 1];
+    }
+    if (op.skipFlag) {
+        if (op.skipFlag == 7) conditionMatched = conditionMatched || state.pf.all();
+        else conditionMatched = conditionMatched || state.pf[op.skipFlag - 1];
+    }
+    return conditionMatched != op.indirect;
+}
+
+template <class Policy>
+bool PDPProcessor::opSkip(const PDPMicroOp &op) {
+    bool skipping = skipCondition(op);
+    if (op.skipMask & 01000) state.overflow = false;
+    if (skipping) skip<Policy>();
+    return true;
+}
+
+// operate group
+
+bool PDPProcessor::opCli(const PDPMicroOp &op) {
+    state.io = {0};
+    return true;
+}
+
+bool PDPProcessor::opLap(const PDPMicroOp &op) {
+    WORD newAC = {state.pc.value};
+    newAC.set(17, state.ac[17] || state.overflow);
+    newAC.set(16, state.extend);
+    state.ac = newAC;
+    return true;
+}
+
+bool PDPProcessor::opCma(const PDPMicroOp &op) {
+    state.ac = ~state.ac;
+    return true;
+}
+
+bool PDPProcessor::opHlt(const PDPMicroOp &op) {
+    state.running = false;
+    state.halt = PDPHaltReason::HALTED;
+    return false;
+}
+
+bool PDPProcessor::opCla(const PDPMicroOp &op) {
+    state.ac = {0};
+    return true;
+}
+
+bool PDPProcessor::opNop(const PDPMicroOp &op) {
+    return true;
+}
+
+bool PDPProcessor::opFlag(const PDPMicroOp &op) {
+    bool set = op.operand & 010;
+    unsigned int flags = op.operand & 07;
+    if (flags == 7 && set) {
+        state.pf = PDPRegister<6>::MASK;
+    } else {
+        state.pf.set(flags - 1, set);
+    }
+    return true;
+}
+
+// in-out transfer group
+
+bool PDPProcessor::opIot(const PDPMicroOp &op) {
+    return executeIot(op.operand | (op.indirect ? IOT_WAIT : 0));
+}
+
+bool PDPProcessor::opIllegal(const PDPMicroOp &op) {
+    HALT_AND_CATCH_FIRE;
+    return false;
+}
+
+// instantiations (the handlers are instantiated through the addresses decode takes)
+
+#define INSTANTIATE_DECODE(POLICY) template PDPMicroOp PDPProcessor::decode<POLICY>(unsigned long instr);
+PDP_POLICIES(INSTANTIATE_DECODE)
@@ -0,0 +1,28 @@
+//
+// PDP-1 Simulator
+// Predecoded Micro-Ops
+//
+
+#pragma once
+
+class PDPProcessor;
+struct PDPMicroOp;
+
+using PDPHandler = bool (PDPProcessor::*)(const PDPMicroOp &);
+
+/**
+ * A core memory word decoded once into everything executeInstruction would otherwise
+ * re-extract on every step. The decode cache holds one of these per core memory address;
+ * a null handler marks an entry that has not been decoded yet (or was invalidated by a write).
+ */
+struct PDPMicroOp {
+    PDPHandler      handler   = nullptr;    // returns true if the PC should be incremented
+    unsigned long   instr     = 0;          // raw instruction word (used by xct and illegal ops)
+    unsigned int    operand   = 0;          // 12-bit address, law immediate, or operate group bits
+    bool            indirect  = false;
+    unsigned char   cycles    = 0;          // memory cycles, not counting indirection (see PDPTiming.hpp)
+    unsigned char   shift     = 0;          // shift group: number of positions
+    unsigned short  skipMask  = 0;          // skip group: za/pa/ma/zo/pi condition bits
+    unsigned char   skipSw    = 0;          // skip group: sense switch selector (0 = none)
+    unsigned char   skipFlag  = 0;          // skip group: program flag selector (0 = none)
+};
@@ -0,0 +1,202 @@
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "PDPMonitor.hpp"
+
+#include "PDPDisassembler.hpp"
+
+static uint32_t parseOctal(const std::string &token, uint32_t limit) {
+    size_t used = 0;
+    unsigned long value = 0;
+    try {
+        value = std::stoul(token, &used, 8);
+    } catch (const std::exception &) {
+        used = 0;
+    }
+    if (token.empty() || used != token.size() || value >= limit) {
+        throw MonitorError{"bad octal number " + token};
+    }
+    return value;
+}
+
+static unsigned long parseCount(const std::string &token) {
+    size_t used = 0;
+    unsigned long value = 0;
+    try {
+        value = std::stoul(token, &used, 10);
+    } catch (const std::exception &) {
+        used = 0;
+    }
+    if (token.empty() || used != token.size()) throw MonitorError{"bad count " + token};
+    return value;
+}
+
+PDPMonitor::PDPMonitor(PDPProcessor &proc_in, const PDPSettings &settings) : proc(proc_in), in(&std::cin), prompt(true), startStopped(!settings.commandFile.empty()) {
+    if (!settings.commandFile.empty() && settings.commandFile != "-") {
+        script.open(settings.commandFile);
+        if (!script) throw MonitorError{settings.commandFile + ": could not open command script"};
+        in = &script;
+        prompt = false;
+    }
+
+    for (const std::string &spec : settings.breakSpecs) {
+        std::istringstream args(spec);
+        addBreak(args);
+    }
+    for (const std::string &spec : settings.watchSpecs) {
+        std::istringstream args(spec);
+        addWatch(args);
+    }
+}
+
+unsigned int PDPMonitor::parseAddress(const std::string &token) const {
+    return parseOctal(token, proc.memorySize());
+}
+
+void PDPMonitor::addBreak(std::istringstream &args) {
+    std::string addr, keyword;
+    if (!(args >> addr)) throw MonitorError{"break: missing address"};
+    unsigned int address = parseAddress(addr);
+
+    PDPBreakCondition condition;
+    if (args >> keyword) {
+        if (keyword != "if") throw MonitorError{"break: expected \"if\" after the address"};
+
+        // the condition may be written with or without spaces: "ac == 5", "ac==5"
+        std::string rest, token;
+        while (args >> token) rest += token;
+
+        size_t op = rest.find_first_of("=!");
+        if (op == std::string::npos || op + 1 >= rest.size() || rest[op + 1] != '=') {
+            throw MonitorError{"break: conditions are REG == VALUE or REG != VALUE"};
+        }
+        std::string reg = rest.substr(0, op);
+        if (reg == "ac") condition.reg = PDPBreakRegister::AC;
+        else if (reg == "io") condition.reg = PDPBreakRegister::IO;
+        else if (reg == "pf") condition.reg = PDPBreakRegister::PF;
+        else throw MonitorError{"break: unknown register " + reg + " (ac, io or pf)"};
+        condition.equal = rest[op] == '=';
+        condition.value = parseOctal(rest.substr(op + 2), condition.reg == PDPBreakRegister::PF ? 0100 : 01000000);
+    }
+
+    proc.setBreakpoint(address, condition);
+}
+
+void PDPMonitor::addWatch(std::istringstream &args) {
+    std::string addr, mode = "rw";
+    if (!(args >> addr)) throw MonitorError{"watch: missing address"};
+    unsigned int address = parseAddress(addr);
+    args >> mode;
+
+    uint8_t mask = 0;
+    if (mode == "r") mask = BREAK_READ;
+    else if (mode == "w") mask = BREAK_WRITE;
+    else if (mode == "rw") mask = BREAK_READ | BREAK_WRITE;
+    else throw MonitorError{"watch: mode is r, w or rw"};
+
+    proc.setWatchpoint(address, mask);
+}
+
+void PDPMonitor::examine(std::istringstream &args) const {
+    std::string addr, count = "1";
+    if (!(args >> addr)) throw MonitorError{"x: missing address"};
+    args >> count;
+    unsigned int address = parseAddress(addr);
+    unsigned long n = parseCount(count);
+
+    char line[96];
+    for (unsigned int a = address; a < std::min<unsigned long>(proc.memorySize(), address + n); ++a) {
+        uint32_t word = proc.memory(a).value;
+        snprintf(line, sizeof(line), "  %06o  %06o  %s\n", a, word, disassemble(word).c_str());
+        std::cout << line;
+    }
+}
+
+void PDPMonitor::report() const {
+    const PDPBreakHit &hit = proc.breakHit();
+    char line[96];
+    if (hit.kind == BREAK_EXEC) {
+        snprintf(line, sizeof(line), "breakpoint at %06o\n", hit.addr);
+    } else {
+        snprintf(line, sizeof(line), "watchpoint: %06o %s by the instruction at %06o\n", hit.addr,
+                 hit.kind == BREAK_READ ? "read" : "written", hit.pc);
+    }
+    std::cout << line;
+    proc.printState();
+}
+
+void PDPMonitor::commandMode() {
+    std::string line;
+    while (!exhausted && !quitting) {
+        if (prompt) std::cout << "(pdp) " << std::flush;
+        if (!std::getline(*in, line)) {
+            exhausted = true;
+            return;
+        }
+        try {
+            if (execute(line)) return;
+        } catch (const MonitorError &e) {
+            std::cout << e.error << std::endl;
+        }
+    }
+}
+
+bool PDPMonitor::execute(const std::string &line) {
+    std::istringstream args(line);
+    std::string command;
+    if (!(args >> command) || command[0] == '#') return false;
+
+    if (command == "break" || command == "b") {
+        addBreak(args);
+    } else if (command == "watch" || command == "w") {
+        addWatch(args);
+    } else if (command == "delete" || command == "d") {
+        std::string addr;
+        if (args >> addr) proc.clearBreakpoints(parseAddress(addr));
+        else proc.clearAllBreakpoints();
+    } else if (command == "info" || command == "i") {
+        proc.listBreakpoints(std::cout);
+    } else if (command == "step" || command == "s") {
+        std::string count = "1";
+        args >> count;
+        unsigned long n = parseCount(count);
+        for (unsigned long i = 0; i < n && proc.step(); ++i) {
+            if (proc.stopped()) {
+                report();
+                return false;
+            }
+        }
+        proc.printState();
+    } else if (command == "continue" || command == "c") {
+        return true;
+    } else if (command == "print" || command == "p") {
+        proc.printState();
+    } else if (command == "x") {
+        examine(args);
+    } else if (command == "quit" || command == "q") {
+        quitting = true;
+        return true;
+    } else if (command == "help" || command == "h") {
+        std::cout << "break ADDR [if ac|io|pf ==|!= VALUE], watch ADDR [r|w|rw], delete [ADDR], info,\n"
+                  << "step [N], continue, print, x ADDR [N], quit (numbers in octal)\n";
+    } else {
+        throw MonitorError{"unknown command " + command + " (try help)"};
+    }
+    return false;
+}
+
+void PDPMonitor::run() {
+    if (startStopped) commandMode();
+
+    while (!quitting) {
+        proc.run();
+        if (!proc.stopped()) return;
+        report();
+        commandMode();
+    }
+}
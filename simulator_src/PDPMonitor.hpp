@@ -0,0 +1,71 @@
+//
+// PDP-1 Simulator
+// Breakpoint Command Mode
+//
+
+#pragma once
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "PDPSettings.hpp"
+#include "PDPState.hpp"
+
+struct MonitorError {
+    std::string error;
+};
+
+/**
+ * Runs a processor under breakpoints and watchpoints. The machine runs at full speed until one
+ * fires, then the monitor reads commands (from stdin or a script) until told to carry on.
+ * Addresses and values are octal. See simulator.cpp for the command list.
+ */
+class PDPMonitor {
+
+private:
+
+    PDPProcessor &proc;
+
+    std::ifstream script;
+    std::istream *in;
+    bool prompt;            // reading from stdin
+    bool startStopped;      // enter command mode before the first instruction (--commands)
+    bool exhausted = false; // out of commands: report stops and keep going
+    bool quitting = false;
+
+    unsigned int parseAddress(const std::string &token) const;
+
+    void addBreak(std::istringstream &args);
+
+    void addWatch(std::istringstream &args);
+
+    void examine(std::istringstream &args) const;
+
+    void report() const;
+
+    void commandMode();
+
+    /**
+     * Executes one command line.
+     * @return true if the command resumes the machine (continue, quit)
+     * @throws MonitorError on a bad command or argument
+     */
+    bool execute(const std::string &line);
+
+public:
+
+    /**
+     * Arms the breakpoints and watchpoints given on the command line (--break, --watch) and opens
+     * the command script (--commands).
+     * @throws MonitorError if a breakpoint is malformed or the script cannot be read
+     */
+    PDPMonitor(PDPProcessor &proc, const PDPSettings &settings);
+
+    /**
+     * Runs the machine to the end of the run, stopping for commands at every breakpoint.
+     */
+    void run();
+
+};
@@ -0,0 +1,57 @@
+//
+// PDP-1 Simulator
+// Instrumentation Policies
+//
+
+#pragma once
+
+// The interpreter, the micro-op handlers and the memory accessors are templates over one of these
+// policies, which says which instrumentation hooks are compiled in. PDPProcessor picks the policy
+// once at startup from the settings, so the plain variant carries no instrumentation at all and
+// the instrumented ones live in the same binary.
+
+/**
+ * No instrumentation: the default for every run without --debug, --profile, --trace or breakpoints.
+ */
+struct PDPPlainPolicy {
+    static constexpr bool LOG         = false;  // print each instruction's working (--debug)
+    static constexpr bool PROFILE     = false;  // count executions, reads, writes, hops and skips (--profile)
+    static constexpr bool TRACE       = false;  // note each instruction's effective address (--trace)
+    static constexpr bool BREAKPOINTS = false;  // check breakpoints and watchpoints (PDPBreakpoints.hpp)
+};
+
+struct PDPDebugPolicy : PDPPlainPolicy {
+    static constexpr bool LOG = true;
+};
+
+struct PDPProfilePolicy : PDPPlainPolicy {
+    static constexpr bool PROFILE = true;
+};
+
+struct PDPTracePolicy : PDPPlainPolicy {
+    static constexpr bool TRACE = true;
+};
+
+struct PDPBreakpointPolicy : PDPPlainPolicy {
+    static constexpr bool BREAKPOINTS = true;
+};
+
+/**
+ * Every hook compiled in, for runs combining several of the above. Each hook still checks at run
+ * time whether its feature was asked for.
+ */
+struct PDPFullPolicy {
+    static constexpr bool LOG         = true;
+    static constexpr bool PROFILE     = true;
+    static constexpr bool TRACE       = true;
+    static constexpr bool BREAKPOINTS = true;
+};
+
+// applies X to every policy, for explicit instantiations
+#define PDP_POLICIES(X) \
+    X(PDPPlainPolicy) \
+    X(PDPDebugPolicy) \
+    X(PDPProfilePolicy) \
+    X(PDPTracePolicy) \
+    X(PDPBreakpointPolicy) \
+    X(PDPFullPolicy)
@@ -0,0 +1,63 @@
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdio.h>
+
+#include "PDPProfile.hpp"
+
+bool PDPSymbols::load(const std::string &filename) {
+    std::ifstream is(filename);
+    if (!is) return false;
+
+    std::string line;
+    while (std::getline(is, line)) {
+        std::istringstream fields(line);
+        unsigned int addr;
+        std::string label;
+        if (fields >> std::oct >> addr >> label) symbols.emplace_back(addr, label);
+    }
+    std::stable_sort(symbols.begin(), symbols.end(),
+                     [](const auto &a, const auto &b) { return a.first < b.first; });
+    return true;
+}
+
+std::string PDPSymbols::name(unsigned int addr) const {
+    auto it = std::upper_bound(symbols.begin(), symbols.end(), addr,
+                               [](unsigned int a, const auto &s) { return a < s.first; });
+    if (it == symbols.begin()) return "";
+    --it;
+
+    // several labels on one address: use the first one listed
+    while (it != symbols.begin() && std::prev(it)->first == it->first) --it;
+
+    if (it->first == addr) return it->second;
+    std::ostringstream os;
+    os << it->second << "+" << std::oct << (addr - it->first);
+    return os.str();
+}
+
+void PDPProfile::writeReport(std::ostream &os, const PDPSymbols &symbols, uint64_t retired) const {
+    std::vector<unsigned int> hot;
+    for (unsigned int addr = 0; addr < executed.size(); ++addr) {
+        if (executed[addr] || reads[addr] || writes[addr] || hops[addr] || skips[addr]) hot.push_back(addr);
+    }
+    std::stable_sort(hot.begin(), hot.end(), [this](unsigned int a, unsigned int b) {
+        if (executed[a] != executed[b]) return executed[a] > executed[b];
+        return reads[a] + writes[a] > reads[b] + writes[b];
+    });
+
+    os << "# " << retired << " instructions retired\n";
+    os << "# address  symbol             executed       %         cycles          reads         writes           hops          skips\n";
+    for (unsigned int addr : hot) {
+        char line[192];
+        double percent = retired ? 100.0 * executed[addr] / retired : 0.0;
+        snprintf(line, sizeof(line), "  %06o   %-16s %10llu %6.2f%% %14llu %14llu %14llu %14llu %14llu\n",
+                 addr, symbols.name(addr).substr(0, 16).c_str(),
+                 static_cast<unsigned long long>(executed[addr]), percent, static_cast<unsigned long long>(cycles[addr]),
+                 static_cast<unsigned long long>(reads[addr]), static_cast<unsigned long long>(writes[addr]),
+                 static_cast<unsigned long long>(hops[addr]), static_cast<unsigned long long>(skips[addr]));
+        os << line;
+    }
+}
@@ -0,0 +1,62 @@
+//
+// PDP-1 Simulator
+// Execution Profiler
+//
+
+#pragma once
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * Labels from an assembler symbol map (assembler --symbols), used to name addresses in reports.
+ */
+class PDPSymbols {
+
+private:
+
+    std::vector<std::pair<unsigned int, std::string>> symbols;   // sorted by address
+
+public:
+
+    /**
+     * Reads a symbol map: one "<octal address> <label>" pair per line.
+     * @return false if the file cannot be read
+     */
+    bool load(const std::string &filename);
+
+    bool empty() const { return symbols.empty(); }
+
+    /**
+     * @return the closest label at or before addr, as "label" or "label+offset" (offset in octal),
+     *         or an empty string if there is none
+     */
+    std::string name(unsigned int addr) const;
+
+};
+
+/**
+ * Per-address execution counters, one flat array per counter, indexed by core memory address.
+ */
+struct PDPProfile {
+    std::vector<uint64_t> executed;     // instructions executed at this address
+    std::vector<uint64_t> cycles;       // memory cycles taken by the instruction at this address
+    std::vector<uint64_t> reads;        // operand reads from this address (after indirection)
+    std::vector<uint64_t> writes;       // operand writes to this address (after indirection)
+    std::vector<uint64_t> hops;         // indirect-chain hops taken by the instruction at this address
+    std::vector<uint64_t> skips;        // skips taken by the instruction at this address
+
+    PDPProfile(unsigned int memorySize)
+        : executed(memorySize), cycles(memorySize), reads(memorySize), writes(memorySize), hops(memorySize), skips(memorySize) {}
+
+    /**
+     * Writes the hot-spot report: every address with a nonzero counter, most executed first.
+     * @param os: output stream
+     * @param symbols: labels for the symbol column (may be empty)
+     * @param retired: total instructions retired, for the percentage column
+     */
+    void writeReport(std::ostream &os, const PDPSymbols &symbols, uint64_t retired) const;
+};
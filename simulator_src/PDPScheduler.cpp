@@ -0,0 +1,24 @@
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "PDPScheduler.hpp"
+
+// heap order: the top is the earliest due, then the earliest scheduled
+static bool later(const PDPEvent &a, const PDPEvent &b) {
+    return a.due != b.due ? a.due > b.due : a.seq > b.seq;
+}
+
+void PDPScheduler::schedule(uint64_t due, PDPEventKind kind, uint32_t data) {
+    heap.push_back({due, seq++, kind, data});
+    std::push_heap(heap.begin(), heap.end(), later);
+}
+
+bool PDPScheduler::popDue(uint64_t now, PDPEvent &event) {
+    if (heap.empty() || heap.front().due > now) return false;
+    std::pop_heap(heap.begin(), heap.end(), later);
+    event = heap.back();
+    heap.pop_back();
+    return true;
+}
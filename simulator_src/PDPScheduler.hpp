@@ -0,0 +1,54 @@
+//
+// PDP-1 Simulator
+// Device Event Scheduler
+//
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+enum class PDPEventKind {
+    CLOCK,      // interval clock tick (--clock): requests a sequence break
+    READER,     // the tape reader has a line or word (data) for rrb
+    PUNCH,      // the punch finished
+    TYPEOUT,    // the typewriter finished typing
+    KEY,        // time for the next key from the typewriter keyboard
+    FRAME       // the display's frame period is up
+};
+
+struct PDPEvent {
+    uint64_t        due;        // machine cycle the event happens at
+    uint64_t        seq;        // scheduling order, so events due at the same cycle run first-come first-served
+    PDPEventKind    kind;
+    uint32_t        data;       // device-specific
+};
+
+/**
+ * Device events in a binary heap ordered by the cycle they are due at. The processor only compares
+ * its cycle count with nextDue() after each instruction, however many devices are waiting.
+ */
+class PDPScheduler {
+
+private:
+
+    std::vector<PDPEvent> heap;
+    uint64_t seq = 0;
+
+public:
+
+    uint64_t nextDue() const { return heap.empty() ? UINT64_MAX : heap.front().due; }
+
+    bool empty() const { return heap.empty(); }
+
+    void schedule(uint64_t due, PDPEventKind kind, uint32_t data = 0);
+
+    /**
+     * Removes the earliest event if it is due by now.
+     * @return false if nothing is due
+     */
+    bool popDue(uint64_t now, PDPEvent &event);
+
+    void clear() { heap.clear(); }
+
+};
@@ -1,9 +1,70 @@
 
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
 #include <getopt.h>
+#include <iostream>
+#include <optional>
 #include <string>
 
 #include "PDPSettings.hpp"
 
+std::optional<unsigned int> parseMemorySize(const std::string &arg) {
+    if (arg == "1x" || arg == "4K" || arg == "4096") {
+        return 4096;
+    }
+    else if (arg == "2x" || arg == "8K" || arg == "8192") {
+        return 8192;
+    }
+    else if (arg == "4x" || arg == "16K" || arg == "16384") {
+        return 16384;
+    }
+    else if (arg == "8x" || arg == "32K" || arg == "32768") {
+        return 32768;
+    }
+    return {};
+}
+
+std::optional<uint64_t> parseNumber(const std::string &arg, uint64_t max) {
+    // strtoull would skip leading spaces and negate a leading '-'
+    if (arg.empty() || arg[0] < '0' || arg[0] > '9') return {};
+    char *end = nullptr;
+    errno = 0;
+    uint64_t value = std::strtoull(arg.c_str(), &end, 0);
+    if (*end != '\0' || errno == ERANGE || value > max) return {};
+    return value;
+}
+
+std::optional<double> parseSeconds(const std::string &arg) {
+    if (arg.empty() || !((arg[0] >= '0' && arg[0] <= '9') || arg[0] == '.')) return {};
+    char *end = nullptr;
+    errno = 0;
+    double value = std::strtod(arg.c_str(), &end);
+    if (*end != '\0' || errno == ERANGE || !std::isfinite(value)) return {};
+    return value;
+}
+
+uint64_t numberOption(const char *option, const char *arg, uint64_t min, uint64_t max) {
+    std::optional<uint64_t> value = parseNumber(arg, max);
+    if (!value || value.value() < min) {
+        std::cerr << "--" << option << ": expected a whole number";
+        if (max != UINT64_MAX) std::cerr << " from " << min << " to " << max;
+        else if (min != 0) std::cerr << " of at least " << min;
+        std::cerr << ", not \"" << arg << "\"" << std::endl;
+        exit(1);
+    }
+    return value.value();
+}
+
+double secondsOption(const char *option, const char *arg) {
+    std::optional<double> value = parseSeconds(arg);
+    if (!value) {
+        std::cerr << "--" << option << ": expected a number of seconds, not \"" << arg << "\"" << std::endl;
+        exit(1);
+    }
+    return value.value();
+}
+
 PDPSettings parseSettings(int argc, char** argv) {
     opterr = true;
 
@@ -19,6 +80,35 @@ PDPSettings parseSettings(int argc, char** argv) {
     //       "2x" / "8K" / "8192":    8192 words
     //       "4x" / "16K" / "16384":  16384 words
     //       "8x" / "32K" / "32768":  32768 words
+    //   --engine <E>: selects the execution engine
+    //     Available settings:
+    //       "interp": reference interpreter
+    //       "cached": predecoded micro-op cache (default)
+    //       "jit":    x86-64 dynamic binary translator
+    //   --batch: only print the final state
+    //   --max-instructions <N>: stop after N instructions
+    //   --time-limit <S>: stop after S seconds of wall-clock time
+    //   --summary <FILE>: write a machine-readable run summary to FILE ("-" for stdout)
+    //   --real-time: run no faster than a real PDP-1 (5 us per memory cycle)
+    //   --no-fast-forward: step through idle loops instead of skipping ahead
+    //   --max-indirection <N>: stop on indirect address or xct chains longer than N hops (default 4096)
+    //   --save-at <N>: write a snapshot once N instructions have been executed
+    //   --snapshot-file <FILE>: where --save-at writes its snapshot (default "pdp1.snap")
+    //   --restore <FILE>: start from a snapshot instead of a tape
+    //   --profile <FILE>: write a per-address hot-spot report to FILE ("-" for stdout)
+    //   --symbols <FILE>: label the profile with an assembler symbol map
+    //   --trace <FILE>: record every executed instruction to a binary trace FILE (read it with tracedump)
+    //   --break <SPEC>: stop at a breakpoint, "ADDR [if REG ==|!= VALUE]" (repeatable)
+    //   --watch <SPEC>: stop when an address is read or written, "ADDR [r|w|rw]" (repeatable)
+    //   --commands <FILE>: start in command mode, reading commands from FILE ("-" for stdin)
+    //   --clock <US>: request a sequence break every US microseconds of machine time
+    //   --reader <FILE>: load FILE into the paper tape reader ("-" for stdin)
+    //   --punch <FILE>: punch paper tape into FILE ("-" for stdout)
+    //   --typewriter <FILE>: type into FILE ("-" for stdout)
+    //   --keys <FILE>: take typewriter keys from FILE ("-" for stdin)
+    //   --display <FILE>: render the Type 30 display to FILE (a PPM stream, raw RGB or one PPM per frame)
+    //   --display-rate <FPS>: display frames per second of machine time (default 30)
+    //   --display-size <N>: display frames are N by N pixels, N up to 1024 (default 512)
 
     option long_options[] = {
         {"debug", no_argument, nullptr, 'd'},
@@ -30,11 +120,36 @@ PDPSettings parseSettings(int argc, char** argv) {
         {"sense5", no_argument, nullptr, '5'},
         {"sense6", no_argument, nullptr, '6'},
         {"mem", required_argument, nullptr, 'm'},
+        {"engine", required_argument, nullptr, 'E'},
+        {"batch", no_argument, nullptr, 'b'},
+        {"max-instructions", required_argument, nullptr, 'n'},
+        {"time-limit", required_argument, nullptr, 't'},
+        {"summary", required_argument, nullptr, 's'},
+        {"real-time", no_argument, nullptr, 'R'},
+        {"no-fast-forward", no_argument, nullptr, 'F'},
+        {"max-indirection", required_argument, nullptr, 'I'},
+        {"save-at", required_argument, nullptr, 'a'},
+        {"snapshot-file", required_argument, nullptr, 'f'},
+        {"restore", required_argument, nullptr, 'r'},
+        {"profile", required_argument, nullptr, 'p'},
+        {"symbols", required_argument, nullptr, 'y'},
+        {"trace", required_argument, nullptr, 'T'},
+        {"break", required_argument, nullptr, 'B'},
+        {"watch", required_argument, nullptr, 'W'},
+        {"commands", required_argument, nullptr, 'C'},
+        {"clock", required_argument, nullptr, 'k'},
+        {"reader", required_argument, nullptr, 'i'},
+        {"punch", required_argument, nullptr, 'o'},
+        {"typewriter", required_argument, nullptr, 'Y'},
+        {"keys", required_argument, nullptr, 'K'},
+        {"display", required_argument, nullptr, 'D'},
+        {"display-rate", required_argument, nullptr, 'H'},
+        {"display-size", required_argument, nullptr, 'Z'},
         {nullptr, 0, nullptr, 0}
     };
 
     int c;
-    while ((c = getopt_long(argc, argv, "de1:2:3:4:5:6:m:", long_options, nullptr)) != -1) {
+    while ((c = getopt_long(argc, argv, "de1:2:3:4:5:6:m:E:bn:t:s:RFI:a:f:r:p:y:T:B:W:C:k:i:o:Y:K:D:H:Z:", long_options, nullptr)) != -1) {
         switch (c) {
         case 'd':
             settings.debug = true;
@@ -61,31 +176,108 @@ PDPSettings parseSettings(int argc, char** argv) {
             settings.senseSwitches[5] = true;
             break;
         case 'm':
+            {
+                std::optional<unsigned int> size = parseMemorySize(optarg);
+                if (!size) exit(1);
+                settings.memory_size = size.value();
+                break;
+            }
+        case 'E':
             {
                 std::string arg = optarg;
-                if (arg == "1x" || arg == "4K" || arg == "4096") {
-                    settings.memory_size = 4096;
-                }
-                else if (arg == "2x" || arg == "8K" || arg == "8192") {
-                    settings.memory_size = 8192;
+                if (arg == "interp") {
+                    settings.engine = PDPEngine::INTERPRETER;
                 }
-                else if (arg == "4x" || arg == "16K" || arg == "16384") {
-                    settings.memory_size = 16384;
+                else if (arg == "cached") {
+                    settings.engine = PDPEngine::DECODED;
                 }
-                else if (arg == "8x" || arg == "32K" || arg == "32768") {
-                    settings.memory_size = 32768;
+                else if (arg == "jit") {
+                    settings.engine = PDPEngine::JIT;
                 }
                 else {
                     exit(1);
                 }
                 break;
             }
+        case 'b':
+            settings.batch = true;
+            break;
+        case 'n':
+            settings.maxInstructions = numberOption("max-instructions", optarg);
+            break;
+        case 't':
+            settings.timeLimit = secondsOption("time-limit", optarg);
+            break;
+        case 's':
+            settings.summaryFile = optarg;
+            break;
+        case 'R':
+            settings.realTime = true;
+            break;
+        case 'F':
+            settings.fastForward = false;
+            break;
+        case 'I':
+            settings.maxIndirection = numberOption("max-indirection", optarg, 0, UINT32_MAX);
+            break;
+        case 'a':
+            settings.saveAt = numberOption("save-at", optarg);
+            break;
+        case 'f':
+            settings.snapshotFile = optarg;
+            break;
+        case 'r':
+            settings.restoreFile = optarg;
+            break;
+        case 'p':
+            settings.profileFile = optarg;
+            break;
+        case 'y':
+            settings.symbolFile = optarg;
+            break;
+        case 'T':
+            settings.traceFile = optarg;
+            break;
+        case 'B':
+            settings.breakSpecs.push_back(optarg);
+            break;
+        case 'W':
+            settings.watchSpecs.push_back(optarg);
+            break;
+        case 'C':
+            settings.commandFile = optarg;
+            break;
+        case 'k':
+            settings.clockPeriod = numberOption("clock", optarg, 0, UINT32_MAX);
+            break;
+        case 'i':
+            settings.readerFile = optarg;
+            break;
+        case 'o':
+            settings.punchFile = optarg;
+            break;
+        case 'Y':
+            settings.typewriterFile = optarg;
+            break;
+        case 'K':
+            settings.keysFile = optarg;
+            break;
+        case 'D':
+            settings.displayFile = optarg;
+            break;
+        case 'H':
+            settings.displayRate = numberOption("display-rate", optarg, 1, UINT32_MAX);
+            break;
+        case 'Z':
+            settings.displaySize = numberOption("display-size", optarg, 1, 1024);
+            break;
         default:
             exit(1);
         }
     }
 
-    settings.tapeFile = argv[argc - 1];
+    // a restored snapshot needs no tape
+    if (optind < argc || settings.restoreFile.empty()) settings.tapeFile = argv[argc - 1];
 
     return settings;
 }
@@ -7,15 +7,93 @@
 #pragma once
 
 #include <bitset>
+#include <cstdint>
+#include <optional>
 #include <string>
+#include <vector>
+
+enum class PDPEngine {
+    INTERPRETER,    // reference interpreter, decodes every instruction as it runs
+    DECODED,        // predecoded micro-op cache
+    JIT             // x86-64 translation of straight-line blocks, interpreter for the rest
+};
 
 struct PDPSettings {
+    PDPEngine       engine        = PDPEngine::DECODED;
     bool            debug         = false;
     bool            extend        = false;
     unsigned int    memory_size   = 4096;
     std::bitset<6>  senseSwitches;
     std::string     tapeFile;
+
+    // batch mode
+    bool            batch           = false;
+    uint64_t        maxInstructions = 0;    // 0 = no budget
+    double          timeLimit       = 0;    // seconds, 0 = no limit
+    std::string     summaryFile;            // empty = no summary, "-" = stdout
+    bool            realTime        = false;  // pace machine time against the host clock
+    bool            fastForward     = true;   // skip ahead through idle loops
+    unsigned int    maxIndirection  = 4096;   // longest indirect chain, in hops
+
+    // snapshots
+    uint64_t        saveAt          = 0;    // instruction count to snapshot at, 0 = never
+    std::string     snapshotFile    = "pdp1.snap";
+    std::string     restoreFile;            // empty = load tapeFile instead
+
+    // profiling
+    std::string     profileFile;            // empty = no profile, "-" = stdout
+    std::string     symbolFile;             // assembler symbol map used to label the profile
+
+    // tracing
+    std::string     traceFile;              // empty = no trace
+
+    // breakpoints (PDPMonitor)
+    std::vector<std::string> breakSpecs;    // "ADDR [if REG ==|!= VALUE]", as for the break command
+    std::vector<std::string> watchSpecs;    // "ADDR [r|w|rw]", as for the watch command
+    std::string     commandFile;            // command script, "-" = stdin; empty = stdin, only once stopped
+
+    // devices
+    unsigned int    clockPeriod     = 0;    // microseconds between sequence break requests, 0 = no clock
+    std::string     readerFile;             // paper tape for the reader, one byte per line; empty = no reader
+    std::string     punchFile;              // where the punch writes, one byte per line; empty = no punch
+    std::string     typewriterFile;         // typewriter output, "-" = stdout; empty = no typewriter
+    std::string     keysFile;               // typewriter keyboard input, "-" = stdin; empty = no keyboard
+    std::string     displayFile;            // rendered display frames (see PDPDisplay); empty = no display
+    unsigned int    displayRate     = 30;   // display frames per second of machine time
+    unsigned int    displaySize     = 512;  // pixels per side of the display frames
 };
 
+// largest memory size the simulator supports
+#define MAX_MEMORY_SIZE 32768
+
+/**
+ * Parses a memory size as accepted by --mem ("1x" / "4K" / "4096" ... "8x" / "32K" / "32768").
+ * @return the number of words, or nothing if arg is not a supported size
+ */
+std::optional<unsigned int> parseMemorySize(const std::string &arg);
+
+/**
+ * Parses an unsigned whole number: decimal, 0x hex or 0 octal, with no sign, spaces or trailing
+ * characters.
+ * @return the number, or nothing if arg is not one or is above max
+ */
+std::optional<uint64_t> parseNumber(const std::string &arg, uint64_t max = UINT64_MAX);
+
+/**
+ * Parses a finite, non-negative number of seconds, such as "2" or "0.5".
+ * @return the number, or nothing if arg is not one
+ */
+std::optional<double> parseSeconds(const std::string &arg);
+
+/**
+ * The argument of a numeric command line option, from min to max. Prints what was wrong and exits
+ * with status 1 if it is not one.
+ * @param option: the option's long name, for the message
+ */
+uint64_t numberOption(const char *option, const char *arg, uint64_t min = 0, uint64_t max = UINT64_MAX);
+
+// as numberOption, for a number of seconds
+double secondsOption(const char *option, const char *arg);
+
 PDPSettings parseSettings(int argc, char** argv);
 
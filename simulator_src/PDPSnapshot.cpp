@@ -0,0 +1,132 @@
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+#include "PDPSnapshot.hpp"
+
+#include "PDPState.hpp"
+
+void PDPProcessor::saveSnapshot(const std::string &filename) const {
+    PDPSnapshotHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, SNAPSHOT_MAGIC, SNAPSHOT_MAGIC_SIZE);
+    header.version = SNAPSHOT_VERSION;
+    header.headerSize = sizeof(header);
+    header.retired = state.retired;
+    header.cycles = state.cycles;
+    header.memorySize = static_cast<uint32_t>(state.cm.size());
+    header.pc = state.pc.value;
+    header.ma = state.ma.value;
+    header.ir = state.ir.value;
+    header.pf = state.pf.value;
+    header.mb = state.mb.value;
+    header.ac = state.ac.value;
+    header.io = state.io.value;
+    header.overflow = state.overflow;
+    header.extend = state.extend;
+    header.senseSwitches = static_cast<uint8_t>(settings.senseSwitches.to_ulong());
+    header.running = state.running;
+    header.halt = static_cast<uint32_t>(state.halt);
+    header.sequenceBreak = (state.sequenceBreak ? SNAPSHOT_SBS_ENABLED : 0)
+                         | (state.breakRequest ? SNAPSHOT_SBS_REQUEST : 0)
+                         | (state.inBreak ? SNAPSHOT_SBS_ACTIVE : 0);
+
+    std::ofstream os(filename, std::ios::binary | std::ios::trunc);
+    os.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    os.write(reinterpret_cast<const char *>(state.cm.data()), state.cm.size() * sizeof(WORD));
+    os.close();
+    if (!os) throw SnapshotError{filename + ": could not write snapshot"};
+}
+
+/**
+ * Checks a mapped snapshot file.
+ * @return an error message, or an empty string if the header and image are usable
+ */
+static std::string validateSnapshot(const PDPSnapshotHeader &header, size_t length) {
+    if (std::memcmp(header.magic, SNAPSHOT_MAGIC, SNAPSHOT_MAGIC_SIZE) != 0) return "not a snapshot";
+    if (header.version != SNAPSHOT_VERSION) return "unsupported snapshot version " + std::to_string(header.version);
+    if (header.headerSize < sizeof(PDPSnapshotHeader) || header.headerSize % sizeof(WORD)) return "malformed snapshot header";
+
+    switch (header.memorySize) {
+    case 4096: case 8192: case 16384: case 32768:
+        break;
+    default:
+        return "unsupported memory size " + std::to_string(header.memorySize);
+    }
+
+    if (length < header.headerSize + static_cast<size_t>(header.memorySize) * sizeof(WORD)) return "truncated snapshot";
+    if (header.pc >= header.memorySize) return "program counter outside memory";
+    if (header.halt > static_cast<uint32_t>(PDPHaltReason::INDIRECT)) return "malformed snapshot header";
+    if (header.sequenceBreak & ~(SNAPSHOT_SBS_ENABLED | SNAPSHOT_SBS_REQUEST | SNAPSHOT_SBS_ACTIVE)) return "malformed snapshot header";
+    return "";
+}
+
+void PDPProcessor::restoreSnapshot(const std::string &filename) {
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) throw SnapshotError{filename + ": " + std::strerror(errno)};
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(PDPSnapshotHeader)) {
+        close(fd);
+        throw SnapshotError{filename + ": not a snapshot"};
+    }
+
+    size_t length = static_cast<size_t>(st.st_size);
+    void *mapped = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) throw SnapshotError{filename + ": " + std::strerror(errno)};
+
+    PDPSnapshotHeader header;
+    std::memcpy(&header, mapped, sizeof(header));
+    std::string error = validateSnapshot(header, length);
+
+    // the image is checked in full before it replaces core memory, so a rejected snapshot leaves the
+    // machine as it was
+    std::vector<WORD> cm;
+    if (error.empty()) {
+        const uint8_t *image = static_cast<const uint8_t *>(mapped) + header.headerSize;
+        cm.resize(header.memorySize);
+        std::memcpy(static_cast<void *>(cm.data()), image, header.memorySize * sizeof(WORD));
+
+        uint32_t stray = 0;
+        for (WORD w : cm) stray |= w.value;
+        if (stray & ~WORD::MASK) error = "core memory word wider than 18 bits";
+    }
+    munmap(mapped, length);
+    if (!error.empty()) throw SnapshotError{filename + ": " + error};
+
+    state.cm = std::move(cm);
+
+    settings.memory_size = header.memorySize;
+    settings.extend = header.extend;
+    // sense switches given on the command line take precedence over the saved ones
+    if (settings.senseSwitches.none()) settings.senseSwitches = header.senseSwitches;
+
+    state.retired = header.retired;
+    state.cycles = header.cycles;
+    state.pc = header.pc;
+    state.ma = header.ma;
+    state.ir = header.ir;
+    state.pf = header.pf;
+    state.mb = header.mb;
+    state.ac = header.ac;
+    state.io = header.io;
+    state.overflow = header.overflow;
+    state.extend = header.extend;
+    state.running = header.running;
+    state.halt = static_cast<PDPHaltReason>(header.halt);
+    state.sequenceBreak = header.sequenceBreak & SNAPSHOT_SBS_ENABLED;
+    state.breakRequest = header.sequenceBreak & SNAPSHOT_SBS_REQUEST;
+    state.inBreak = header.sequenceBreak & SNAPSHOT_SBS_ACTIVE;
+
+    decoded.assign(header.memorySize, PDPMicroOp{});
+}
@@ -0,0 +1,52 @@
+//
+// PDP-1 Simulator
+// Processor Snapshots
+//
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// Snapshot files are a fixed PDPSnapshotHeader followed by core memory, one uint32_t per word
+// (the in-memory WORD layout), so restoring is a single block copy out of the mapped file.
+// Fields are in host byte order; a snapshot from a host of the other endianness fails the
+// version check.
+
+#define SNAPSHOT_MAGIC      "PDP1SNAP"
+#define SNAPSHOT_MAGIC_SIZE 8
+#define SNAPSHOT_VERSION    3
+
+// PDPSnapshotHeader::sequenceBreak bits
+#define SNAPSHOT_SBS_ENABLED    1
+#define SNAPSHOT_SBS_REQUEST    2
+#define SNAPSHOT_SBS_ACTIVE     4
+
+struct PDPSnapshotHeader {
+    char        magic[SNAPSHOT_MAGIC_SIZE];
+    uint32_t    version;
+    uint32_t    headerSize;         // offset of the core memory image
+    uint64_t    retired;
+    uint64_t    cycles;
+    uint32_t    memorySize;         // words in the core memory image
+    uint32_t    pc;
+    uint32_t    ma;
+    uint32_t    ir;
+    uint32_t    pf;
+    uint32_t    mb;
+    uint32_t    ac;
+    uint32_t    io;
+    uint8_t     overflow;
+    uint8_t     extend;
+    uint8_t     senseSwitches;      // bit i = sense switch i+1
+    uint8_t     running;
+    uint32_t    halt;               // PDPHaltReason
+    uint8_t     sequenceBreak;      // SNAPSHOT_SBS_* bits
+    uint8_t     reserved[7];
+};
+
+static_assert(sizeof(PDPSnapshotHeader) == 80, "snapshot header layout is part of the file format");
+
+struct SnapshotError {
+    std::string                error;
+};
@@ -1,9 +1,14 @@
 
+#include <algorithm>
 #include <array>
-#include <bitset>
+#include <chrono>
+#include <cstdint>
 #include <iostream>
 #include <optional>
+#include <string>
+#include <stdio.h>
 #include <stdlib.h>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -12,69 +17,179 @@
 #include "TapeReader.hpp"
 
 #ifdef DEBUG
-#define DEBUG_PRINT(x) std::cout << x << std::endl;
+// the _debug builds print the tape and every instruction's working on every run
+#define LOG_WORKING true
 #else
-#define DEBUG_PRINT(x)
+// otherwise only Debugging Mode (--debug) does
+#define LOG_WORKING settings.debug
 #endif
 
-#define MINUS_ZERO 0777777
+// only compiled into the policies that log
+#define DEBUG_PRINT(x) if constexpr (Policy::LOG) { if (LOG_WORKING) std::cout << x << std::endl; }
 
-// had to do it
-#define HALT_AND_CATCH_FIRE exit(1);
+template <class Policy>
+unsigned int PDPProcessor::resolveChain(unsigned int addr) {
+    unsigned int start = addr;
+    unsigned int hops = 0;
 
-WORD PDPProcessor::readMemory(unsigned int addr, bool indirect) {
-    if (!indirect) return state.cm[addr];
-    WORD w = state.cm[addr];
-    indirect = w[12];
-    while (indirect) {
-        addr = w.to_ulong() & 07777;
-        w = state.cm[addr];
-        indirect = w[12];
+    // translated code stores without going through writeMemory, so the JIT walks every time
+    PDPChain &chain = chains[start];
+    if (!jit && chain.epoch == chainEpoch) {
+        addr = chain.target;
+        hops = chain.hops;
+    } else {
+        WORD w = state.cm[addr];
+        while (w[12]) {
+            if (hops == settings.maxIndirection) throw IndirectChainError{start};
+            chainWords[addr] = chainEpoch;
+            addr = w.value & 07777;
+            w = state.cm[addr];
+            ++hops;
+        }
+        if (!jit) {
+            // the final word is on the chain too: making it indirect would extend the chain
+            chainWords[addr] = chainEpoch;
+            chain = {chainEpoch, addr, hops};
+        }
     }
-    return w;
+
+    state.cycles += hops;
+    if (Policy::PROFILE && profile) profile->hops[state.pc.value] += hops;
+    return addr;
 }
 
-void PDPProcessor::writeMemory(unsigned int addr, bool indirect, WORD word) {
-    if (!indirect) {
-        state.cm[addr] = word;
-        return;
-    }
-    WORD w = state.cm[addr];
-    indirect = w[12];
-    while (indirect) {
-        addr = w.to_ulong() & 07777;
-        w = state.cm[addr];
-        indirect = w[12];
+void PDPProcessor::forgetChains() {
+    if (++chainEpoch == 0) {
+        // stamps from the previous round of epochs would look current again
+        std::fill(chains.begin(), chains.end(), PDPChain{});
+        std::fill(chainWords.begin(), chainWords.end(), 0);
+        chainEpoch = 1;
     }
-    state.cm[addr] = word;
 }
 
-int onesComplementToInt(const WORD &oc) {
-    if (oc[17]) {
-        return -((~static_cast<int>(oc.to_ulong())) & 0377777);
+PDPProcessor::PDPProcessor(const PDPSettings &settings_in) : settings{settings_in}, state {settings_in.memory_size}, decoded(settings_in.memory_size) {
+    if (!settings.restoreFile.empty()) {
+        restoreSnapshot(settings.restoreFile);
     } else {
-        return static_cast<int>(oc.to_ulong());
+        state.extend = settings.extend;
+
+        size_t words = loadTape(settings.tapeFile, state.cm.data(), state.cm.size());
+        if (LOG_WORKING) {
+            for (size_t i = 0; i < words; ++i) std::cout << "Read memory word " << i << " = " << state.cm[i] << std::endl;
+        }
     }
+
+    startEngine();
 }
 
-WORD intToOnesComplement(int val) {
-    if (val < 0) {
-        return {static_cast<unsigned long>(((~-val) & 0377777) | 0400000)};
-    } else {
-        return {static_cast<unsigned long>(val & 0377777)};
+PDPProcessor::PDPProcessor(const PDPSettings &settings_in, const std::vector<WORD> &image) : settings{settings_in}, state {settings_in.memory_size}, decoded(settings_in.memory_size) {
+    if (image.size() > state.cm.size()) {
+        throw TapeFormatError{settings.tapeFile + ": tape does not fit in " + std::to_string(state.cm.size()) + " words of memory"};
     }
+    state.extend = settings.extend;
+    std::copy(image.begin(), image.end(), state.cm.begin());
+
+    startEngine();
 }
 
-PDPProcessor::PDPProcessor(const PDPSettings &settings_in) : settings{settings_in}, state {settings_in.memory_size} {
-    state.extend = settings.extend;
+void PDPProcessor::startEngine() {
+    chains.assign(state.cm.size(), PDPChain{});
+    chainWords.assign(state.cm.size(), 0);
+
+    if (!settings.profileFile.empty()) {
+        profile = std::make_unique<PDPProfile>(state.cm.size());
+        if (!settings.symbolFile.empty() && !symbols.load(settings.symbolFile)) {
+            std::cerr << "cannot read symbol map " << settings.symbolFile << ", reporting bare addresses" << std::endl;
+        }
+    }
+    if (!settings.traceFile.empty()) {
+        trace = std::make_unique<PDPTraceWriter>(settings.traceFile);
+    }
+
+    if (profile || trace) {
+        // skipped loop iterations would not be counted or recorded either
+        settings.fastForward = false;
+        if (settings.engine == PDPEngine::JIT) {
+            // translated code only reports back at block exits
+            std::cerr << (profile ? "profiling" : "tracing") << " with the micro-op cache instead of the JIT" << std::endl;
+            settings.engine = PDPEngine::DECODED;
+        }
+    }
+    if (LOG_WORKING) {
+        // the working is printed by executeInstruction
+        settings.engine = PDPEngine::INTERPRETER;
+    }
+
+    breakpoints.resize(state.cm.size());
+
+    if (settings.clockPeriod) {
+        clockPeriod = std::max<uint64_t>(1, static_cast<uint64_t>(settings.clockPeriod) * 1000 / CYCLE_NS);
+        post(nextTick(clockPeriod), PDPEventKind::CLOCK);
+    }
+    attachDevices();
+    // a restored machine may have a break pending
+    attention = 0;
+
+    if (settings.engine == PDPEngine::JIT) {
+        jit = std::make_unique<PDPJit>(settings, settings.memory_size);
+        if (!jit->available()) {
+            std::cerr << "JIT unavailable on this host, using the micro-op cache" << std::endl;
+            jit.reset();
+            settings.engine = PDPEngine::DECODED;
+        }
+        jitContext.cm = reinterpret_cast<uint32_t *>(state.cm.data());
+    }
+
+    selectPolicy();
+}
 
-    std::optional<std::bitset<18>> line;
-    TapeReader tr(settings.tapeFile);
-    unsigned int i = 0;
-    while ((line = tr.readWord())) {
-        DEBUG_PRINT("Read memory word " << i << " = " << line.value());
-        state.cm[i++] = line.value();
+void PDPProcessor::selectPolicy() {
+    bool armed = breakpoints.armed();
+    if (armed && jit) {
+        // translated code does not check the flags; its stores also bypassed the chain cache
+        std::cerr << "breakpoints use the micro-op cache instead of the JIT" << std::endl;
+        jit.reset();
+        settings.engine = PDPEngine::DECODED;
+        forgetChains();
     }
+    std::fill(decoded.begin(), decoded.end(), PDPMicroOp{});
+
+    switch (LOG_WORKING + (profile != nullptr) + (trace != nullptr) + armed) {
+    case 0:
+        usePolicy<PDPPlainPolicy>();
+        break;
+    case 1:
+        if (LOG_WORKING) usePolicy<PDPDebugPolicy>();
+        else if (profile) usePolicy<PDPProfilePolicy>();
+        else if (trace) usePolicy<PDPTracePolicy>();
+        else usePolicy<PDPBreakpointPolicy>();
+        break;
+    default:
+        usePolicy<PDPFullPolicy>();
+        break;
+    }
+}
+
+void PDPProcessor::setBreakpoint(unsigned int addr, const PDPBreakCondition &condition) {
+    bool wasArmed = breakpoints.armed();
+    breakpoints.setBreak(addr, condition);
+    if (!wasArmed) selectPolicy();
+}
+
+void PDPProcessor::setWatchpoint(unsigned int addr, uint8_t mask) {
+    bool wasArmed = breakpoints.armed();
+    breakpoints.setWatch(addr, mask);
+    if (!wasArmed) selectPolicy();
+}
+
+void PDPProcessor::clearBreakpoints(unsigned int addr) {
+    breakpoints.clear(addr);
+    if (!breakpoints.armed()) selectPolicy();
+}
+
+void PDPProcessor::clearAllBreakpoints() {
+    breakpoints.clearAll();
+    selectPolicy();
 }
 
 // printState
@@ -82,22 +197,496 @@ PDPProcessor::PDPProcessor(const PDPSettings &settings_in) : settings{settings_i
 void PDPProcessor::printState() const {
     std::cout << "\n";
     std::cout << "PC:      " << state.pc << "\n";
-    std::cout << "INSTR: " << state.cm[state.pc.to_ulong()] << "\n";
+    std::cout << "INSTR: " << (state.pc.value < state.cm.size() ? state.cm[state.pc.value] : WORD{}) << "\n";
     std::cout << "AC:    " << state.ac << "\n";
     std::cout << "IO:    " << state.io << "\n";
     std::cout << "SW:                " << settings.senseSwitches << "\n";
-    std::cout << "PF:                " << state.pf << "\n" << std::endl;
+    std::cout << "PF:                " << state.pf << "\n";
+    std::cout << "CYC:   " << state.cycles << " (" << state.cycles * CYCLE_NS / 1000 << " us)\n" << std::endl;
 }
 
 // execution logic
 
-bool PDPProcessor::step() {
-    if (!state.running) return false;
+template <class Policy>
+bool PDPProcessor::stepWith() {
+    if (!state.running || !pcInMemory()) return false;
+
+    unsigned long pc = state.pc.value;
+    uint64_t cycles = state.cycles;
+    uint32_t instr = state.cm[pc].value;
+    if (Policy::TRACE) lastAddress = TRACE_NO_ADDRESS;
+
+    if (Policy::BREAKPOINTS) {
+        // carrying on from an execute breakpoint runs the instruction it stopped before
+        bool resuming = hit.kind == BREAK_EXEC && hit.pc == pc;
+        hit = {};
+        if ((breakpoints.at(pc) & BREAK_EXEC) && !resuming && breakpoints.conditionHolds(pc, state.ac, state.io, state.pf)) {
+            hit = {BREAK_EXEC, static_cast<unsigned int>(pc), static_cast<unsigned int>(pc)};
+            return state.running;
+        }
+    }
+    try {
+        if (settings.engine == PDPEngine::JIT) {
+            if ((!savePending() || settings.saveAt - state.retired > JIT_MAX_BLOCK)
+                && (!settings.maxInstructions || settings.maxInstructions - state.retired > JIT_MAX_BLOCK)
+                && quietInstructions() > JIT_MAX_BLOCK) {
+                stepJit<Policy>(state.retired + 1);
+            } else {
+                // a whole block could step past the snapshot point, the instruction budget or a device event
+                interpret<Policy>(state.cm[pc].value);
+            }
+        } else if (settings.engine == PDPEngine::INTERPRETER) {
+            interpret<Policy>(state.cm[pc].value);
+        } else {
+            ++state.retired;
+            PDPMicroOp &op = decoded[pc];
+            if (!op.handler) op = decode<Policy>(state.cm[pc].value);
+            state.cycles += op.cycles;
+            if ((this->*op.handler)(op)) state.pc = state.pc.value + 1;
+        }
+    } catch (const IndirectChainError &) {
+        HALT_ON_INDIRECT_CHAIN
+    }
 
-    unsigned long instr = state.cm[state.pc.to_ulong()].to_ulong();
-    return executeInstruction(instr);
+    if (Policy::PROFILE && profile) {
+        ++profile->executed[pc];
+        profile->cycles[pc] += state.cycles - cycles;
+    }
+    if (Policy::TRACE && trace) {
+        trace->push({static_cast<uint16_t>(pc), static_cast<uint16_t>(lastAddress), instr, state.ac.value, state.io.value});
+    }
+    if (state.cycles >= attention) service();
+    saveIfDue();
+    return state.running;
+}
+
+void PDPProcessor::saveIfDue() const {
+    if (settings.saveAt && state.retired == settings.saveAt) saveSnapshot(settings.snapshotFile);
 }
 
+template <class Policy>
+bool PDPProcessor::stepJit(uint64_t limit) {
+    unsigned int pc = state.pc.value;
+    uint8_t *entry = jit->lookup(pc, state.cm);
+    if (!entry) {
+        return interpret<Policy>(state.cm[pc].value);
+    }
+
+    jitContext.ac = state.ac.value;
+    jitContext.io = state.io.value;
+    jitContext.pc = pc;
+    jitContext.overflow = state.overflow;
+    jitContext.pf = state.pf.value;
+    jitContext.extend = state.extend;
+    jitContext.retired = state.retired;
+    jitContext.cycles = state.cycles;
+    jitContext.limit = limit;
+
+    uint32_t reason = jit->run(jitContext, entry);
+
+    state.ac = jitContext.ac;
+    state.io = jitContext.io;
+    state.pc = jitContext.pc;
+    state.overflow = jitContext.overflow;
+    state.retired = jitContext.retired;
+    state.cycles = jitContext.cycles;
+
+    if (reason == JIT_EXIT_SMC) jit->invalidate(jitContext.smcAddr);
+
+    return state.running;
+}
+
+template <class Policy>
+void PDPProcessor::runUntil(uint64_t limit) {
+    if (savePending() && settings.saveAt < limit) {
+        runUntil<Policy>(settings.saveAt);
+        if (state.retired < settings.saveAt) return;
+    }
+
+    if (settings.engine != PDPEngine::JIT) {
+        while (state.running && state.retired < limit) {
+            if (Policy::BREAKPOINTS) {
+                // an idle loop may hold a breakpoint or touch a watched word
+                stepWith<Policy>();
+                if (stopped()) return;
+            } else if (!fastForward(limit)) {
+                stepWith<Policy>();
+            }
+        }
+        return;
+    }
+
+    while (state.running && state.retired < limit) {
+        if (!pcInMemory()) break;
+        if (fastForward(limit)) continue;
+        // translated instructions never take more than maxInstructionCycles(), so none of them
+        // reaches attention before safe
+        uint64_t safe = state.retired + std::min(limit - state.retired, quietInstructions());
+        try {
+            if (state.retired + JIT_MAX_BLOCK < safe) {
+                // a block can retire up to JIT_MAX_BLOCK instructions past its limit check
+                stepJit<Policy>(safe - JIT_MAX_BLOCK);
+            } else {
+                // finish the budget, or approach the next event, one interpreted instruction at a time
+                interpret<Policy>(state.cm[state.pc.value].value);
+            }
+        } catch (const IndirectChainError &) {
+            // as in stepWith, the events the instruction's hops ran past still happen
+            HALT_ON_INDIRECT_CHAIN
+        }
+        if (state.cycles >= attention) service();
+    }
+
+    // the other engines save from step()
+    if (limit == settings.saveAt) saveIfDue();
+}
+
+bool PDPProcessor::fastForward(uint64_t limit) {
+    if (!settings.fastForward) return false;
+
+    unsigned int pc = state.pc.value;
+    if (pc >= state.cm.size()) return false;
+    unsigned long instr = state.cm[pc].value;
+    unsigned long opcode6 = (instr >> 12) & 076;
+    if (!((IDLE_LOOP_OPCODES >> opcode6) & 1)) return false;
+
+    // leave the last instruction before limit to the engine
+    uint64_t room = limit - state.retired - 1;
+    // and the instruction that reaches the next device event or sequence break
+    uint64_t quiet = attention > state.cycles ? attention - state.cycles - 1 : 0;
+
+    if (opcode6 == 060) {
+        // jmp to itself (an indirect one at 1 would dismiss a break instead)
+        if ((instr & 07777) != pc || (instr & 0010000)) return false;
+        room = std::min<uint64_t>(room, quiet / instructionCycles(instr));
+        if (room == 0) return false;
+        state.retired += room;
+        state.cycles += room * instructionCycles(instr);
+        return true;
+    }
+
+    // the rest are two-instruction loops closed by a jmp back to the first
+    if (pc + 1 >= state.cm.size()) return false;
+    unsigned long back = state.cm[pc + 1].value;
+    if (((back >> 12) & 076) != 060 || (back & 07777) != pc || (back & 0010000)) return false;
+
+    PDPMicroOp op = decode<PDPPlainPolicy>(instr);
+    uint64_t iterations = std::min<uint64_t>(room / 2, quiet / (instructionCycles(instr) + instructionCycles(back)));
+
+    if (opcode6 == 046) {
+        // isp: every pass but the one reaching zero falls through to the jmp
+        if (op.indirect || op.operand == pc || op.operand == pc + 1) return false;
+        int cy = onesComplementToInt(state.cm[op.operand]);
+        if (cy + 1 >= 0) return false;
+        iterations = std::min<uint64_t>(iterations, -(cy + 1));
+        if (iterations == 0) return false;
+        state.ac = intToOnesComplement(cy + static_cast<int>(iterations));
+        // fast-forwarding is off whenever there is instrumentation to feed
+        writeMemory<PDPPlainPolicy>(op.operand, false, state.ac);
+    } else {
+        bool skipping;
+        if (opcode6 == 064) {
+            // zo clears overflow on the first pass, so only later passes repeat exactly
+            if ((op.skipMask & 01000) && state.overflow) return false;
+            skipping = skipCondition(op);
+        } else {
+            // sad / sas; the chain walk of an indirect operand would add cycles
+            if (op.indirect) return false;
+            skipping = (state.cm[op.operand] == state.ac) == (opcode6 == 052);
+        }
+        if (skipping || iterations == 0) return false;
+    }
+
+    state.retired += 2 * iterations;
+    state.cycles += iterations * (instructionCycles(instr) + instructionCycles(back));
+    return true;
+}
+
+// sequence breaks and devices
+
+void PDPProcessor::service() {
+    PDPEvent event;
+    while (scheduler.popDue(state.cycles, event)) {
+        switch (event.kind) {
+        case PDPEventKind::CLOCK:
+            state.breakRequest = true;
+            scheduler.schedule(event.due + clockPeriod, PDPEventKind::CLOCK);
+            break;
+
+        case PDPEventKind::READER:
+            readerBuffer = event.data;
+            raiseFlag(FLAG_READER);
+            break;
+
+        case PDPEventKind::PUNCH:
+            raiseFlag(FLAG_PUNCH);
+            break;
+
+        case PDPEventKind::TYPEOUT:
+            raiseFlag(FLAG_TYPEOUT);
+            break;
+
+        case PDPEventKind::KEY:
+            {
+                // keys from a file arrive one per character time, deterministically; from a
+                // terminal or pipe, whenever the host delivers them
+                uint8_t key;
+                bool struck = keys->isFile() ? keys->take(key) : keys->poll(key);
+                if (struck) {
+                    keyBuffer = key;
+                    raiseFlag(FLAG_KEY);
+                }
+                if (struck || !keys->isFile()) scheduler.schedule(event.due + TYPEWRITER_CYCLES, PDPEventKind::KEY);
+                break;
+            }
+
+        case PDPEventKind::FRAME:
+            display->endFrame();
+            scheduler.schedule(event.due + framePeriod, PDPEventKind::FRAME);
+            break;
+        }
+    }
+    if (state.breakRequest && state.sequenceBreak && !state.inBreak) takeBreak();
+    attention = scheduler.nextDue();
+}
+
+void PDPProcessor::takeBreak() {
+    WORD link = {state.pc.value};
+    // bit numbering is LSB-first, PDP numbering is reversed
+    link.set(17, state.overflow);
+    link.set(16, state.extend);
+
+    // fast-forwarding is off whenever there is instrumentation to feed, so plain stores do
+    writeMemory<PDPPlainPolicy>(0, false, state.ac);
+    writeMemory<PDPPlainPolicy>(1, false, link);
+    writeMemory<PDPPlainPolicy>(2, false, state.io);
+
+    state.pc = BREAK_ENTRY;
+    state.cycles += BREAK_CYCLES;
+    state.breakRequest = false;
+    state.inBreak = true;
+}
+
+void PDPProcessor::dismissBreak() {
+    WORD link = state.cm[1];
+    state.pc = link.value & 0177777;
+    state.overflow = link[17];
+    state.extend = link[16];
+    state.inBreak = false;
+    // the indirect fetch of location 1
+    ++state.cycles;
+    // a break requested meanwhile can be taken now
+    attention = 0;
+}
+
+void PDPProcessor::attachDevices() {
+    if (!settings.readerFile.empty()) reader = std::make_unique<PDPHostInput>(settings.readerFile);
+    if (!settings.punchFile.empty()) punch = std::make_unique<PDPHostOutput>(settings.punchFile);
+    if (!settings.typewriterFile.empty()) typewriter = std::make_unique<PDPHostOutput>(settings.typewriterFile);
+    if (!settings.keysFile.empty()) {
+        keys = std::make_unique<PDPHostInput>(settings.keysFile);
+        // like the clock, on whole multiples of the character time
+        post(nextTick(TYPEWRITER_CYCLES), PDPEventKind::KEY);
+    }
+    if (!settings.displayFile.empty()) {
+        display = std::make_unique<PDPDisplay>(settings.displayFile, settings.displaySize, settings.displayRate);
+        framePeriod = std::max<uint64_t>(1, 1000000000ULL / (static_cast<uint64_t>(settings.displayRate) * CYCLE_NS));
+        post(nextTick(framePeriod), PDPEventKind::FRAME);
+    }
+}
+
+uint64_t PDPProcessor::startDevice(uint64_t &busy, uint64_t cycles) {
+    busy = std::max(busy, state.cycles) + cycles;
+    return busy;
+}
+
+void PDPProcessor::completeIot(bool wait, uint64_t done, PDPEventKind kind, uint32_t data) {
+    if (wait) {
+        // in-out halt: the processor stops until the device is done
+        state.cycles = done;
+        if (kind == PDPEventKind::READER) state.io = data;
+    } else {
+        post(done, kind, data);
+    }
+}
+
+WORD PDPProcessor::readTape(bool binary, unsigned int &lines) {
+    lines = 0;
+    unsigned long word = 0;
+    unsigned int frames = 0;
+    while (frames < (binary ? 3 : 1)) {
+        uint8_t line;
+        if (!reader->take(line)) line = binary ? BINARY_LINE : 0;
+        ++lines;
+        // the binary reader passes over lines without the eighth hole
+        if (binary && !(line & BINARY_LINE)) continue;
+        word = binary ? (word << 6) | (line & 077) : line;
+        ++frames;
+    }
+    return WORD{word};
+}
+
+bool PDPProcessor::executeIot(unsigned long instr) {
+    bool wait = instr & IOT_WAIT;
+    unsigned int device = instr & 077;
+
+    switch (device) {
+    case IOT_RPA:
+    case IOT_RPB:
+        {
+            if (!reader) break;
+            unsigned int lines;
+            WORD word = readTape(device == IOT_RPB, lines);
+            completeIot(wait, startDevice(readerBusy, lines * READER_CYCLES), PDPEventKind::READER, word.value);
+            return true;
+        }
+
+    case IOT_RRB:
+        if (!reader) break;
+        state.io = readerBuffer;
+        state.pf.set(FLAG_READER - 1, false);
+        return true;
+
+    case IOT_PPA:
+    case IOT_PPB:
+        {
+            if (!punch) break;
+            if (device == IOT_PPA) {
+                punch->push(state.io.value & 0377);
+            } else {
+                for (int shift = 12; shift >= 0; shift -= 6) punch->push(BINARY_LINE | ((state.io.value >> shift) & 077));
+            }
+            unsigned int lines = device == IOT_PPA ? 1 : 3;
+            completeIot(wait, startDevice(punchBusy, lines * PUNCH_CYCLES), PDPEventKind::PUNCH);
+            return true;
+        }
+
+    case IOT_TYO:
+        if (!typewriter) break;
+        typewriter->push(state.io.value & 0177);
+        completeIot(wait, startDevice(typewriterBusy, TYPEWRITER_CYCLES), PDPEventKind::TYPEOUT);
+        return true;
+
+    case IOT_DPY:
+        {
+            if (!display) break;
+            // the signed intensity in bits 6-8, moved to run from 0 (-4) to 7 (+3)
+            display->plot(state.ac, state.io, ((instr >> 6) + 4) & 07);
+            uint64_t done = startDevice(displayBusy, DISPLAY_CYCLES);
+            if (wait) state.cycles = done;
+            return true;
+        }
+
+    case IOT_TYI:
+        if (!keys) break;
+        state.io = keyBuffer;
+        state.pf.set(FLAG_KEY - 1, false);
+        return true;
+
+    case IOT_LSM:
+        state.sequenceBreak = false;
+        return true;
+
+    case IOT_ESM:
+        state.sequenceBreak = true;
+        attention = 0;
+        return true;
+
+    case IOT_CBS:
+        state.breakRequest = false;
+        return true;
+    }
+
+    // no such device, or nothing attached to it
+    HALT_AND_CATCH_FIRE;
+    return false;
+}
+
+bool PDPProcessor::limitReached(std::chrono::steady_clock::time_point start) {
+    if (settings.maxInstructions && state.retired >= settings.maxInstructions) {
+        state.halt = PDPHaltReason::BUDGET;
+        return true;
+    }
+    if (settings.timeLimit > 0) {
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        if (elapsed.count() >= settings.timeLimit) {
+            state.halt = PDPHaltReason::TIMEOUT;
+            return true;
+        }
+    }
+    return false;
+}
+
+void PDPProcessor::run() {
+    auto start = std::chrono::steady_clock::now();
+    uint64_t budget = settings.maxInstructions ? settings.maxInstructions : UINT64_MAX;
+    uint64_t chunk = settings.realTime ? REALTIME_CHUNK : RUN_CHUNK;
+    uint64_t startCycles = state.cycles;
+
+    while (state.running && !limitReached(start)) {
+        (this->*runVariant)(state.retired + std::min<uint64_t>(budget - state.retired, chunk));
+        if (stopped()) return;
+
+        if (settings.realTime) {
+            std::this_thread::sleep_until(start + std::chrono::nanoseconds((state.cycles - startCycles) * CYCLE_NS));
+        }
+    }
+}
+
+void PDPProcessor::runTo(uint64_t target) {
+    if (state.running && state.retired < target) (this->*runVariant)(target);
+}
+
+// batch summaries
+
+const char *haltReasonName(PDPHaltReason reason) {
+    switch (reason) {
+    case PDPHaltReason::RUNNING: return "running";
+    case PDPHaltReason::HALTED:  return "hlt";
+    case PDPHaltReason::ILLEGAL: return "illegal";
+    case PDPHaltReason::BUDGET:  return "budget";
+    case PDPHaltReason::TIMEOUT: return "timeout";
+    case PDPHaltReason::INDIRECT: return "indirect";
+    }
+    return "unknown";
+}
+
+uint64_t PDPProcessor::memoryDigest() const {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (WORD w : state.cm) {
+        for (int i = 0; i < 3; ++i) {
+            hash ^= (w.value >> (8 * i)) & 0xFF;
+            hash *= 0x100000001b3ULL;
+        }
+    }
+    return hash;
+}
+
+void PDPProcessor::writeSummary(std::ostream &os) const {
+    os << "{";
+    writeSummaryFields(os);
+    os << "}\n";
+}
+
+void PDPProcessor::writeSummaryFields(std::ostream &os) const {
+    char digest[17];
+    snprintf(digest, sizeof(digest), "%016llx", static_cast<unsigned long long>(memoryDigest()));
+
+    os << "\"instructions\": " << state.retired
+       << ", \"halt\": \"" << haltReasonName(state.halt) << "\""
+       << ", \"pc\": " << state.pc.value
+       << ", \"ac\": " << state.ac.value
+       << ", \"io\": " << state.io.value
+       << ", \"pf\": " << state.pf.value
+       << ", \"overflow\": " << (state.overflow ? "true" : "false")
+       << ", \"memory_digest\": \"" << digest << "\"";
+}
+
+void PDPProcessor::writeProfile(std::ostream &os) const {
+    profile->writeReport(os, symbols, state.retired);
+}
+
+template <class Policy>
 bool PDPProcessor::executeInstruction(unsigned long instr) {
     unsigned long opcode6 = (instr >> 12) & 076;
     bool indirect = (instr & 0010000);
@@ -113,34 +702,20 @@ bool PDPProcessor::executeInstruction(unsigned long instr) {
         {
             // add
             DEBUG_PRINT("add " << operand12);
-            WORD memoryContents = readMemory(operand12, indirect);
-            unsigned long ac = state.ac.to_ulong();
-            unsigned long cy = memoryContents.to_ulong();
-            DEBUG_PRINT("C(Y)     = " << memoryContents << " (" << cy << ")");
-            DEBUG_PRINT("ac       = " << state.ac << " (" << ac << ")");
-
-            // one's complement addition
-            unsigned long sum = ac + cy;
-            if (sum & 01000000) sum = (sum & 0777777) + 1;
-
-            // minus zero stuff
-            if (sum == MINUS_ZERO) {
-                DEBUG_PRINT("converting -0 to +0");
-                sum = 0;
-            }
+            WORD memoryContents = readMemory<Policy>(operand12, indirect);
+            DEBUG_PRINT("C(Y)     = " << memoryContents << " (" << memoryContents.value << ")");
+            DEBUG_PRINT("ac       = " << state.ac << " (" << state.ac.value << ")");
 
-            WORD newAC {sum};
+            // one's complement addition, -0 folded to +0
+            WORD newAC = onesAdd(state.ac, memoryContents);
 
             // check signs to set overflow
-            if (state.ac[17] == memoryContents[17]) {
-                DEBUG_PRINT("ac and C(Y) have same sign");
-                if (newAC[17] != state.ac[17]) {
-                    DEBUG_PRINT("add resulted in overflow");
-                    state.overflow = true;
-                }
+            if (addOverflows(state.ac, memoryContents, newAC)) {
+                DEBUG_PRINT("add resulted in overflow");
+                state.overflow = true;
             }
 
-            DEBUG_PRINT("new ac   = " << newAC << " (" << sum << ")");
+            DEBUG_PRINT("new ac   = " << newAC << " (" << newAC.value << ")");
             state.ac = newAC;
 
             break;
@@ -150,53 +725,68 @@ bool PDPProcessor::executeInstruction(unsigned long instr) {
         {
             // sub
             DEBUG_PRINT("sub " << operand12);
-            WORD memoryContents = readMemory(operand12, indirect);
-            unsigned long ac = state.ac.to_ulong();
-            unsigned long cy = memoryContents.to_ulong();
-            DEBUG_PRINT("C(Y)       = " << memoryContents << " (" << cy << ")");
-            DEBUG_PRINT("ac         = " << state.ac << " (" << ac << ")");
-
-            // one's complement subtraction with hacky bit stuff
-            ac |= 01000000;
-            unsigned long diff = ac - cy;
-            if (!(diff & 01000000)) diff -= 1;
-            else diff &= 0777777;
-
-            // minus zero shenanigans
-            if (diff == MINUS_ZERO && !(ac == MINUS_ZERO && cy == 0)) {
-                DEBUG_PRINT("converting -0 to +0");
-                diff = 0;
-            }
+            WORD memoryContents = readMemory<Policy>(operand12, indirect);
+            DEBUG_PRINT("C(Y)       = " << memoryContents << " (" << memoryContents.value << ")");
+            DEBUG_PRINT("ac         = " << state.ac << " (" << state.ac.value << ")");
 
-            WORD newAC {diff};
+            // one's complement subtraction, -0 folded to +0
+            WORD newAC = onesSub(state.ac, memoryContents);
 
             // check signs to set overflow
-            if (state.ac[17] != newAC[17]) {
+            if (state.ac.negative() != newAC.negative()) {
                 DEBUG_PRINT("sub resulted in overflow");
                 state.overflow = true;
             }
 
-            DEBUG_PRINT("new ac     = " << newAC << " (" << diff << ")");
+            DEBUG_PRINT("new ac     = " << newAC << " (" << newAC.value << ")");
             state.ac = newAC;
 
             break;
         }
 
     case 054:
-        // mul
-        std::cerr << "TODO: mul" << std::endl;
-        break;
+        {
+            // mul
+            DEBUG_PRINT("mul " << operand12);
+            WORD memoryContents = readMemory<Policy>(operand12, indirect);
+            DEBUG_PRINT("C(Y)     = " << memoryContents << " (" << memoryContents.value << ")");
+            DEBUG_PRINT("ac       = " << state.ac << " (" << state.ac.value << ")");
+
+            WordPair product = onesMul(state.ac, memoryContents);
+            DEBUG_PRINT("new ac   = " << product.ac << " (" << product.ac.value << ")");
+            DEBUG_PRINT("new io   = " << product.io << " (" << product.io.value << ")");
+            state.ac = product.ac;
+            state.io = product.io;
+            break;
+        }
 
     case 056:
-        // div
-        std::cerr << "TODO: div" << std::endl;
-        break;
+        {
+            // div
+            DEBUG_PRINT("div " << operand12);
+            WORD memoryContents = readMemory<Policy>(operand12, indirect);
+            DEBUG_PRINT("C(Y)     = " << memoryContents << " (" << memoryContents.value << ")");
+            DEBUG_PRINT("ac io    = " << state.ac << " " << state.io);
+
+            WordPair result;
+            if (onesDiv({state.ac, state.io}, memoryContents, result)) {
+                DEBUG_PRINT("new ac   = " << result.ac << " (" << result.ac.value << ")");
+                DEBUG_PRINT("new io   = " << result.io << " (" << result.io.value << ")");
+                state.ac = result.ac;
+                state.io = result.io;
+                skip<Policy>();
+            } else {
+                DEBUG_PRINT("divide overflow, not skipping");
+            }
+            break;
+        }
 
     case 044:
         {
             // idx
             DEBUG_PRINT("idx " << operand12);
-            WORD memoryContents = readMemory(operand12, indirect);
+            unsigned int y = effectiveAddress<Policy>(operand12, indirect);
+            WORD memoryContents = readMemory<Policy>(y, false);
             int cy = onesComplementToInt(memoryContents);
             DEBUG_PRINT("C(Y)     = " << memoryContents << " (" << cy << ")");
 
@@ -204,7 +794,7 @@ bool PDPProcessor::executeInstruction(unsigned long instr) {
             DEBUG_PRINT("new ac   = " << newAC << " (" << cy + 1 << ")");
             DEBUG_PRINT("new C(Y) = " << newAC << " (" << cy + 1 << ")");
             state.ac = newAC;
-            writeMemory(operand12, indirect, newAC);
+            writeMemory<Policy>(y, false, newAC);
             break;
         }
 
@@ -212,7 +802,8 @@ bool PDPProcessor::executeInstruction(unsigned long instr) {
         {
             // isp
             DEBUG_PRINT("isp " << operand12);
-            WORD memoryContents = readMemory(operand12, indirect);
+            unsigned int y = effectiveAddress<Policy>(operand12, indirect);
+            WORD memoryContents = readMemory<Policy>(y, false);
             int cy = onesComplementToInt(memoryContents);
             DEBUG_PRINT("C(Y)     = " << memoryContents << " (" << cy << ")");
 
@@ -220,10 +811,10 @@ bool PDPProcessor::executeInstruction(unsigned long instr) {
             DEBUG_PRINT("new ac   = " << newAC << " (" << cy + 1 << ")");
             DEBUG_PRINT("new C(Y) = " << newAC << " (" << cy + 1 << ")");
             state.ac = newAC;
-            writeMemory(operand12, indirect, newAC);
+            writeMemory<Policy>(y, false, newAC);
             if (cy + 1 >= 0) {
                 DEBUG_PRINT("isp skipping");
-                state.pc = (state.pc.to_ulong() + 1);
+                skip<Policy>();
             }
             break;
         }
@@ -232,7 +823,7 @@ bool PDPProcessor::executeInstruction(unsigned long instr) {
         {
             // and
             DEBUG_PRINT("and " << operand12);
-            WORD cy = readMemory(operand12, indirect);
+            WORD cy = readMemory<Policy>(operand12, indirect);
             DEBUG_PRINT("C(Y)     = " << cy);
             DEBUG_PRINT("ac       = " << state.ac);
             WORD newAC = cy & state.ac;
@@ -245,7 +836,7 @@ bool PDPProcessor::executeInstruction(unsigned long instr) {
         {
             // xor
             DEBUG_PRINT("xor " << operand12);
-            WORD cy = readMemory(operand12, indirect);
+            WORD cy = readMemory<Policy>(operand12, indirect);
             DEBUG_PRINT("C(Y)     = " << cy);
             DEBUG_PRINT("ac       = " << state.ac);
             WORD newAC = cy ^ state.ac;
@@ -258,7 +849,7 @@ bool PDPProcessor::executeInstruction(unsigned long instr) {
         {
             // ior
             DEBUG_PRINT("ior " << operand12);
-            WORD cy = readMemory(operand12, indirect);
+            WORD cy = readMemory<Policy>(operand12, indirect);
             DEBUG_PRINT("C(Y)     = " << cy);
             DEBUG_PRINT("ac       = " << state.ac);
             WORD newAC = cy | state.ac;
@@ -271,7 +862,7 @@ bool PDPProcessor::executeInstruction(unsigned long instr) {
         {
             // lac
             DEBUG_PRINT("lac " << operand12);
-            WORD cy = readMemory(operand12, indirect);
+            WORD cy = readMemory<Policy>(operand12, indirect);
             DEBUG_PRINT("C(Y)     = " << cy);
             DEBUG_PRINT("new ac   = " << cy);
             state.ac = cy;
@@ -284,7 +875,7 @@ bool PDPProcessor::executeInstruction(unsigned long instr) {
             DEBUG_PRINT("dac " << operand12);
             DEBUG_PRINT("ac       = " << state.ac);
             DEBUG_PRINT("new C(Y) = " << state.ac);
-            writeMemory(operand12, indirect, state.ac);
+            writeMemory<Policy>(operand12, indirect, state.ac);
             break;
         }
 
@@ -293,14 +884,15 @@ bool PDPProcessor::executeInstruction(unsigned long instr) {
             // dap
             DEBUG_PRINT("dap " << operand12);
             DEBUG_PRINT("ac       = " << state.ac);
-            unsigned int acLow12 = state.ac.to_ulong() & 07777;
+            unsigned int acLow12 = state.ac.value & 07777;
             WORD ap {acLow12};
             DEBUG_PRINT("ap       = " << ap);
-            WORD cy = readMemory(operand12, indirect);
+            unsigned int y = effectiveAddress<Policy>(operand12, indirect);
+            WORD cy = readMemory<Policy>(y, false);
             DEBUG_PRINT("C(Y)     = " << cy);
             WORD newCY = (cy & WORD{0770000}) | ap;
             DEBUG_PRINT("new C(Y) = " << newCY);
-            writeMemory(operand12, indirect, newCY);
+            writeMemory<Policy>(y, false, newCY);
             break;
         }
 
@@ -309,14 +901,15 @@ bool PDPProcessor::executeInstruction(unsigned long instr) {
             // dip
             DEBUG_PRINT("dip " << operand12);
             DEBUG_PRINT("ac       = " << state.ac);
-            unsigned int acHigh5 = state.ac.to_ulong() & 0760000;
+            unsigned int acHigh5 = state.ac.value & 0760000;
             WORD ip {acHigh5};
             DEBUG_PRINT("ip       = " << ip);
-            WORD cy = readMemory(operand12, indirect);
+            unsigned int y = effectiveAddress<Policy>(operand12, indirect);
+            WORD cy = readMemory<Policy>(y, false);
             DEBUG_PRINT("C(Y)     = " << cy);
             WORD newCY = (cy & WORD{0017777}) | ip;
             DEBUG_PRINT("new C(Y) = " << newCY);
-            writeMemory(operand12, indirect, newCY);
+            writeMemory<Policy>(y, false, newCY);
             break;
         }
 
@@ -324,7 +917,7 @@ bool PDPProcessor::executeInstruction(unsigned long instr) {
         {
             // lio
             DEBUG_PRINT("lio " << operand12);
-            WORD cy = readMemory(operand12, indirect);
+            WORD cy = readMemory<Policy>(operand12, indirect);
             DEBUG_PRINT("C(Y)     = " << cy);
             DEBUG_PRINT("new io   = " << cy);
             state.io = cy;
@@ -337,7 +930,7 @@ bool PDPProcessor::executeInstruction(unsigned long instr) {
             DEBUG_PRINT("dio " << operand12);
             DEBUG_PRINT("io       = " << state.io);
             DEBUG_PRINT("new C(Y) = " << state.io);
-            writeMemory(operand12, indirect, state.io);
+            writeMemory<Policy>(operand12, indirect, state.io);
             break;
         }
 
@@ -346,7 +939,7 @@ bool PDPProcessor::executeInstruction(unsigned long instr) {
             // dzm
             DEBUG_PRINT("dzm " << operand12);
             DEBUG_PRINT("new C(Y) = 0");
-            writeMemory(operand12, indirect, WORD{0});
+            writeMemory<Policy>(operand12, indirect, WORD{0});
             break;
         }
 
@@ -354,15 +947,23 @@ bool PDPProcessor::executeInstruction(unsigned long instr) {
         {
             // xct
             DEBUG_PRINT("xct " << operand12);
-            WORD cy = readMemory(operand12, indirect);
-            unsigned long toRun = cy.to_ulong();
-            executeInstruction(toRun);
+            WORD cy = readExecuted<Policy>(operand12, indirect);
+            unsigned long toRun = cy.value;
+            state.cycles += instructionCycles(toRun);
+            executeInstruction<Policy>(toRun);
             break;
         }
 
     case 060:
         {
             // jmp
+            if (indirect && operand12 == 1 && state.inBreak) {
+                DEBUG_PRINT("jmp i 1, dismissing the sequence break");
+                dismissBreak();
+                DEBUG_PRINT("new pc   = " << state.pc);
+                incPC = false;
+                break;
+            }
             DEBUG_PRINT("jmp " << operand12);
             DEBUG_PRINT("new pc   = " << operand12);
             state.pc = {operand12};
@@ -374,8 +975,8 @@ bool PDPProcessor::executeInstruction(unsigned long instr) {
         {
             // jsp
             DEBUG_PRINT("jsp " << operand12);
-            WORD newAC = {state.pc.to_ulong() + 1};
-            // bitset and PDP bit orderings are reversed
+            WORD newAC = {state.pc.value + 1};
+            // bit numbering is LSB-first, PDP numbering is reversed
             newAC.set(17, state.overflow);
             newAC.set(16, state.extend);
             DEBUG_PRINT("new ac   = " << newAC);
@@ -393,10 +994,10 @@ bool PDPProcessor::executeInstruction(unsigned long instr) {
                 DEBUG_PRINT("jda " << operand12);
 
                 DEBUG_PRINT("C(Y)     = " << state.ac << "( " << onesComplementToInt(state.ac) << ")");
-                writeMemory(operand12, false, state.ac);
+                writeMemory<Policy>(operand12, false, state.ac);
 
-                WORD newAC = {state.pc.to_ulong() + 1};
-                // bitset and PDP bit orderings are reversed
+                WORD newAC = {state.pc.value + 1};
+                // bit numbering is LSB-first, PDP numbering is reversed
                 newAC.set(17, state.overflow);
                 newAC.set(16, state.extend);
                 DEBUG_PRINT("new ac   = " << newAC);
@@ -410,10 +1011,10 @@ bool PDPProcessor::executeInstruction(unsigned long instr) {
                 // cal
                 DEBUG_PRINT("cal");
                 DEBUG_PRINT("C(0o100) = " << state.ac);
-                writeMemory(0100, false, state.ac);
+                writeMemory<Policy>(0100, false, state.ac);
 
-                WORD newAC = {state.pc.to_ulong() + 1};
-                // bitset and PDP bit orderings are reversed
+                WORD newAC = {state.pc.value + 1};
+                // bit numbering is LSB-first, PDP numbering is reversed
                 newAC.set(17, state.overflow);
                 newAC.set(16, state.extend);
                 DEBUG_PRINT("new ac   = " << newAC);
@@ -431,12 +1032,12 @@ bool PDPProcessor::executeInstruction(unsigned long instr) {
         {
             // sad
             DEBUG_PRINT("sad " << operand12);
-            WORD cy = readMemory(operand12, indirect);
+            WORD cy = readMemory<Policy>(operand12, indirect);
             DEBUG_PRINT("C(Y)     = " << cy);
             DEBUG_PRINT("ac       = " << state.ac);
             if (cy != state.ac) {
                 DEBUG_PRINT("C(Y) and ac differ, skipping");
-                state.pc = {state.pc.to_ulong() + 1};
+                skip<Policy>();
             }
             break;
         }
@@ -445,12 +1046,12 @@ bool PDPProcessor::executeInstruction(unsigned long instr) {
         {
             // sas
             DEBUG_PRINT("sas " << operand12);
-            WORD cy = readMemory(operand12, indirect);
+            WORD cy = readMemory<Policy>(operand12, indirect);
             DEBUG_PRINT("C(Y)     = " << cy);
             DEBUG_PRINT("ac       = " << state.ac);
             if (cy == state.ac) {
                 DEBUG_PRINT("C(Y) and ac differ, skipping");
-                state.pc = {state.pc.to_ulong() + 1};
+                skip<Policy>();
             }
             break;
         }
@@ -461,6 +1062,7 @@ bool PDPProcessor::executeInstruction(unsigned long instr) {
             DEBUG_PRINT("law " << (indirect ? "-" : "") << operand12);
             WORD newAC = intToOnesComplement((indirect?-1:1) * static_cast<int>(operand12));
             DEBUG_PRINT("new ac   = " << newAC << "(" << (indirect ? "-" : "") << operand12 << ")");
+            state.ac = newAC;
             break;
         }
 
@@ -482,7 +1084,7 @@ bool PDPProcessor::executeInstruction(unsigned long instr) {
                     // rar
                     DEBUG_PRINT("rar " << shiftAmount);
                     DEBUG_PRINT("ac       = " << state.ac);
-                    WORD newAC = (state.ac >> shiftAmount) | (state.ac << (18 - shiftAmount));
+                    WORD newAC = state.ac.rotateRight(shiftAmount);
                     DEBUG_PRINT("new ac   = " << newAC);
                     state.ac = newAC;
                     break;
@@ -492,7 +1094,7 @@ bool PDPProcessor::executeInstruction(unsigned long instr) {
                     // ral
                     DEBUG_PRINT("ral " << shiftAmount);
                     DEBUG_PRINT("ac       = " << state.ac);
-                    WORD newAC = (state.ac << shiftAmount) | (state.ac >> (18 - shiftAmount));
+                    WORD newAC = state.ac.rotateLeft(shiftAmount);
                     DEBUG_PRINT("new ac   = " << newAC);
                     state.ac = newAC;
                     break;
@@ -523,7 +1125,7 @@ bool PDPProcessor::executeInstruction(unsigned long instr) {
                     // rar
                     DEBUG_PRINT("rir " << shiftAmount);
                     DEBUG_PRINT("io       = " << state.io);
-                    WORD newIO = (state.io >> shiftAmount) | (state.io << (18 - shiftAmount));
+                    WORD newIO = state.io.rotateRight(shiftAmount);
                     DEBUG_PRINT("new io   = " << newIO);
                     state.io = newIO;
                     break;
@@ -533,7 +1135,7 @@ bool PDPProcessor::executeInstruction(unsigned long instr) {
                     // ril
                     DEBUG_PRINT("ril " << shiftAmount);
                     DEBUG_PRINT("io       = " << state.io);
-                    WORD newIO = (state.io << shiftAmount) | (state.io >> (18 - shiftAmount));
+                    WORD newIO = state.io.rotateLeft(shiftAmount);
                     DEBUG_PRINT("new ac   = " << newIO);
                     state.io = newIO;
                     break;
@@ -619,6 +1221,7 @@ bool PDPProcessor::executeInstruction(unsigned long instr) {
             default:
                 DEBUG_PRINT("idk shift");
                 HALT_AND_CATCH_FIRE;
+                incPC = false;
                 break;
             }
             break;
@@ -674,11 +1277,20 @@ bool PDPProcessor::executeInstruction(unsigned long instr) {
 
             if (conditionMatched != indirect) {
                 DEBUG_PRINT("skipping");
-                state.pc = {state.pc.to_ulong() + 1};
+                skip<Policy>();
             }
             break;
         }
 
+    case 072:
+        // in-out transfer group
+        DEBUG_PRINT("iot " << (instr & 07777));
+        if (!executeIot(instr)) {
+            DEBUG_PRINT("no such device");
+            incPC = false;
+        }
+        break;
+
     case 076:
         {
             // operate group
@@ -699,9 +1311,9 @@ bool PDPProcessor::executeInstruction(unsigned long instr) {
                     DEBUG_PRINT("ac       = " << state.ac);
                     DEBUG_PRINT("pc       = " << state.pc);
 
-                    WORD newAC = {state.pc.to_ulong()};
-                    newAC[17] = state.ac[17] || state.overflow;
-                    newAC[16] = state.extend;
+                    WORD newAC = {state.pc.value};
+                    newAC.set(17, state.ac[17] || state.overflow);
+                    newAC.set(16, state.extend);
 
                     DEBUG_PRINT("new ac   = " << newAC);
                     state.ac = newAC;
@@ -724,6 +1336,7 @@ bool PDPProcessor::executeInstruction(unsigned long instr) {
                 // hlt
                 DEBUG_PRINT("hlt");
                 state.running = false;
+                state.halt = PDPHaltReason::HALTED;
                 incPC = false;
                 break;
 
@@ -744,15 +1357,16 @@ bool PDPProcessor::executeInstruction(unsigned long instr) {
                         bool set = address & 010;
                         unsigned int flags = address & 07;
                         if (flags == 7 && set) {
-                            state.pf.set();
+                            state.pf = PDPRegister<6>::MASK;
                         } else {
-                            state.pf[flags - 1] = set;
+                            state.pf.set(flags - 1, set);
                         }
                         break;
                     }
 
                     DEBUG_PRINT("idk op");
                     HALT_AND_CATCH_FIRE;
+                    incPC = false;
                     break;
                 }
             }
@@ -762,10 +1376,18 @@ bool PDPProcessor::executeInstruction(unsigned long instr) {
     default:
         DEBUG_PRINT("idk");
         HALT_AND_CATCH_FIRE;
+        incPC = false;
 
     }
 
-    if (incPC) state.pc = state.pc.to_ulong() + 1;
+    if (incPC) state.pc = state.pc.value + 1;
 
     return state.running;
 }
+
+// instantiations (opXct in PDPMicroOp.cpp calls executeInstruction for every policy)
+
+#define INSTANTIATE_POLICY(POLICY) \
+    template bool PDPProcessor::executeInstruction<POLICY>(unsigned long instr); \
+    template unsigned int PDPProcessor::resolveChain<POLICY>(unsigned int addr);
+PDP_POLICIES(INSTANTIATE_POLICY)
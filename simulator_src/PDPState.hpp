@@ -6,21 +6,81 @@
 
 #pragma once
 
+#include <algorithm>
 #include <array>
-#include <bitset>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
 #include <utility>
 #include <vector>
 
+#include "PDPBreakpoints.hpp"
+#include "PDPDevices.hpp"
+#include "PDPDisplay.hpp"
+#include "PDPJit.hpp"
+#include "PDPMicroOp.hpp"
+#include "PDPPolicy.hpp"
+#include "PDPProfile.hpp"
+#include "PDPScheduler.hpp"
 #include "PDPSettings.hpp"
+#include "PDPSnapshot.hpp"
+#include "PDPTiming.hpp"
+#include "PDPTrace.hpp"
+#include "PDPWord.hpp"
 
-#define WORD std::bitset<18>
+// had to do it
+#define HALT_AND_CATCH_FIRE { state.running = false; state.halt = PDPHaltReason::ILLEGAL; }
+#define HALT_ON_INDIRECT_CHAIN { state.running = false; state.halt = PDPHaltReason::INDIRECT; }
+
+// how often run() checks the wall clock
+#define RUN_CHUNK (1 << 20)
+
+// opcodes that can start an idle loop: jmp, isp, sad, sas and the skip group
+#define IDLE_LOOP_OPCODES ((1ULL << 060) | (1ULL << 046) | (1ULL << 050) | (1ULL << 052) | (1ULL << 064))
+
+// how often run() sleeps to keep pace with a real PDP-1 (--real-time), ~10 ms of machine time
+#define REALTIME_CHUNK 1024
+
+// taking a sequence break stores AC, PC and IO in locations 0 to 2 and continues at 3
+#define BREAK_CYCLES 3
+#define BREAK_ENTRY  3
+
+enum class PDPHaltReason {
+    RUNNING,
+    HALTED,     // hlt
+    ILLEGAL,    // unknown instruction
+    BUDGET,     // --max-instructions reached
+    TIMEOUT,    // --time-limit reached
+    INDIRECT    // indirect address or xct chain longer than --max-indirection (e.g. a pointer to itself)
+};
+
+/**
+ * Thrown by the indirect chain walk when a chain exceeds the hop limit. The instruction is abandoned
+ * and the machine stops with PDPHaltReason::INDIRECT, leaving the PC on the instruction.
+ */
+struct IndirectChainError {
+    unsigned int addr;      // where the chain starts
+};
+
+/**
+ * A resolved indirect chain: the effective address reached from one starting word.
+ */
+struct PDPChain {
+    uint32_t epoch  = 0;    // valid while equal to the processor's chainEpoch
+    uint32_t target = 0;
+    uint32_t hops   = 0;
+};
+
+const char *haltReasonName(PDPHaltReason reason);
 
 struct PDPState {
-    std::bitset<16> pc = 0; // including extended PC
-    std::bitset<12> ma = 0;
-    std::bitset<5>  ir = 0;
+    PDPRegister<16> pc = 0; // including extended PC
+    PDPRegister<12> ma = 0;
+    PDPRegister<5>  ir = 0;
 
-    std::bitset<6>  pf = 0;
+    PDPRegister<6>  pf = 0;
 
     bool overflow = false;
     bool extend   = false;
@@ -32,6 +92,15 @@ struct PDPState {
     std::vector<WORD> cm;
 
     bool running = true;
+    PDPHaltReason halt = PDPHaltReason::RUNNING;
+
+    // sequence break system: enabled by esm, requested by a device, in progress until "jmp i 1"
+    bool sequenceBreak = false;
+    bool breakRequest  = false;
+    bool inBreak       = false;
+
+    uint64_t retired = 0;   // instructions executed so far
+    uint64_t cycles  = 0;   // memory cycles taken so far (see PDPTiming.hpp)
 
     PDPState(unsigned int size) : cm(size, {0}) {}
 };
@@ -43,21 +112,415 @@ private:
     PDPSettings settings;
     PDPState state;
 
-    WORD readMemory(unsigned int addr, bool indirect);
+    // decode cache, parallel to state.cm
+    std::vector<PDPMicroOp> decoded;
+
+    // translated code cache, only present with PDPEngine::JIT
+    std::unique_ptr<PDPJit> jit;
+    PDPJitContext jitContext;
+
+    // indirect chain cache, by starting address. Writing any word of a cached chain (chainWords
+    // holds the epoch each word was last seen on a chain) starts a new epoch, dropping every entry.
+    std::vector<PDPChain> chains;
+    std::vector<uint32_t> chainWords;
+    uint32_t chainEpoch = 1;
+
+    // per-address counters, only present with --profile
+    std::unique_ptr<PDPProfile> profile;
+    PDPSymbols symbols;
+
+    // execution trace, only present with --trace
+    std::unique_ptr<PDPTraceWriter> trace;
+    unsigned int lastAddress = TRACE_NO_ADDRESS;    // effective address of the last memory access
+
+    // breakpoints and watchpoints, and what stopped the machine last (see stopped())
+    PDPBreakpoints breakpoints;
+    PDPBreakHit hit;
+
+    // device events (PDPScheduler.hpp); the period of the --clock device in cycles, 0 without one
+    PDPScheduler scheduler;
+    uint64_t clockPeriod = 0;
+
+    // in-out devices, only present when attached to a host stream (see PDPDevices.hpp), the cycle
+    // each is busy until, and the words waiting for rrb and tyi
+    std::unique_ptr<PDPHostInput> reader;
+    std::unique_ptr<PDPHostOutput> punch;
+    std::unique_ptr<PDPHostOutput> typewriter;
+    std::unique_ptr<PDPHostInput> keys;
+    uint64_t readerBusy = 0;
+    uint64_t punchBusy = 0;
+    uint64_t typewriterBusy = 0;
+    WORD readerBuffer = 0;
+    WORD keyBuffer = 0;
 
-    void writeMemory(unsigned int addr, bool indirect, WORD word);
+    // Type 30 display, only present with --display; frames end every framePeriod cycles
+    std::unique_ptr<PDPDisplay> display;
+    uint64_t framePeriod = 0;
+    uint64_t displayBusy = 0;
 
+    // the only cycle count the engines compare with between instructions: the next device event,
+    // or 0 while a sequence break may be taken (see service())
+    uint64_t attention = UINT64_MAX;
+
+    // the instantiations of stepWith and runUntil for the policy chosen by selectPolicy
+    bool (PDPProcessor::*stepVariant)() = nullptr;
+    void (PDPProcessor::*runVariant)(uint64_t) = nullptr;
+
+    /**
+     * Follows the indirect chain starting at addr (whose word has bit 12 set) to the first word
+     * without it, counting a cycle per hop.
+     * @return the effective address
+     * @throws IndirectChainError if the chain is longer than settings.maxIndirection hops
+     */
+    template <class Policy>
+    unsigned int resolveChain(unsigned int addr);
+
+    void forgetChains();
+
+    /**
+     * The address an operand refers to: addr itself, or the end of its indirect chain. Instructions
+     * that read and then write their operand resolve it once with this and pass indirect = false to
+     * readMemory / writeMemory, so the chain is walked (and its cycles counted) only once.
+     */
+    template <class Policy>
+    unsigned int effectiveAddress(unsigned int addr, bool indirect) {
+        return indirect && state.cm[addr][12] ? resolveChain<Policy>(addr) : addr;
+    }
+
+    template <class Policy>
+    WORD readMemory(unsigned int addr, bool indirect) {
+        if (indirect && state.cm[addr][12]) addr = resolveChain<Policy>(addr);
+        if (Policy::TRACE) lastAddress = addr;
+        if (Policy::PROFILE && profile) ++profile->reads[addr];
+        if (Policy::BREAKPOINTS && (breakpoints.at(addr) & BREAK_READ)) hit = {BREAK_READ, state.pc.value, addr};
+        return state.cm[addr];
+    }
+
+    template <class Policy>
+    void writeMemory(unsigned int addr, bool indirect, WORD word) {
+        if (indirect && state.cm[addr][12]) addr = resolveChain<Policy>(addr);
+        if (Policy::TRACE) lastAddress = addr;
+        if (Policy::PROFILE && profile) ++profile->writes[addr];
+        if (Policy::BREAKPOINTS && (breakpoints.at(addr) & BREAK_WRITE)) hit = {BREAK_WRITE, state.pc.value, addr};
+        if (chainWords[addr] == chainEpoch) forgetChains();
+        state.cm[addr] = word;
+        decoded[addr].handler = nullptr;
+        if (jit && jit->isCode(addr)) jit->invalidate(addr);
+    }
+
+    /**
+     * Reads the instruction an xct at addr executes, following an xct of an xct (counting its
+     * cycles) on to the first word that is not one, so that a chain of them cannot recurse.
+     * @throws IndirectChainError if the chain is longer than settings.maxIndirection hops
+     */
+    template <class Policy>
+    WORD readExecuted(unsigned int addr, bool indirect) {
+        WORD executed = readMemory<Policy>(addr, indirect);
+        unsigned int hops = 0;
+        while (((executed.value >> 12) & 076) == 010) {
+            if (hops++ == settings.maxIndirection) throw IndirectChainError{addr};
+            state.cycles += instructionCycles(executed.value);
+            executed = readMemory<Policy>(executed.value & 07777, executed.value & 0010000);
+        }
+        return executed;
+    }
+
+    template <class Policy>
     bool executeInstruction(unsigned long instr);
 
+    /**
+     * Executes an in-out transfer instruction (opcode 72), shared by every engine. Leaves the PC alone.
+     * @return false if the device is not attached (the machine stops with PDPHaltReason::ILLEGAL)
+     */
+    bool executeIot(unsigned long instr);
+
+    /**
+     * Runs every device event due by now, takes a requested sequence break if the system is
+     * enabled and no break is in progress, then sets attention for the next check.
+     */
+    void service();
+
+    void takeBreak();
+
+    // "jmp i 1" while a break is in progress: restores PC, overflow and extend mode from location 1
+    void dismissBreak();
+
+    // schedules a device event, bringing attention forward to it
+    void post(uint64_t due, PDPEventKind kind, uint32_t data = 0) {
+        scheduler.schedule(due, kind, data);
+        attention = std::min(attention, due);
+    }
+
+    // the first multiple of period after the current cycle
+    uint64_t nextTick(uint64_t period) const { return (state.cycles / period + 1) * period; }
+
+    void attachDevices();
+
+    /**
+     * Queues an operation taking the given cycles on a device, after any it is already busy with.
+     * @return the cycle the operation completes at
+     */
+    uint64_t startDevice(uint64_t &busy, uint64_t cycles);
+
+    /**
+     * Ends an IOT: waits for the device (the i bit) or leaves flag to be raised by an event.
+     */
+    void completeIot(bool wait, uint64_t done, PDPEventKind kind, uint32_t data = 0);
+
+    /**
+     * Reads the next paper tape line, or (binary) the next three lines punched in the eighth
+     * hole as one word. Blank tape is read past the end of the file.
+     * @param lines: set to the number of lines the reader moved over
+     */
+    WORD readTape(bool binary, unsigned int &lines);
+
+    void raiseFlag(unsigned int flag) {
+        state.pf.set(flag - 1, true);
+        state.breakRequest = true;
+    }
+
+    // instructions that can certainly retire before the cycle count reaches attention
+    uint64_t quietInstructions() const {
+        if (attention == UINT64_MAX) return UINT64_MAX;
+        return attention > state.cycles ? (attention - state.cycles - 1) / maxInstructionCycles() : 0;
+    }
+
+    // retires instr through the interpreter, for engines that fall back to it
+    template <class Policy>
+    bool interpret(unsigned long instr) {
+        ++state.retired;
+        state.cycles += instructionCycles(instr);
+        return executeInstruction<Policy>(instr);
+    }
+
+    // a jda to the last word of core memory, or a skip over it, leaves the PC past the end: the
+    // machine stops there, as on an illegal instruction, rather than fetch from outside memory
+    bool pcInMemory() {
+        if (state.pc.value < state.cm.size()) return true;
+        HALT_AND_CATCH_FIRE;
+        return false;
+    }
+
+    template <class Policy>
+    void skip() {
+        if (Policy::PROFILE && profile) ++profile->skips[state.pc.value];
+        state.pc = state.pc.value + 1;
+    }
+
+    /**
+     * Decodes instr into a micro-op whose handler is instantiated for Policy.
+     */
+    template <class Policy>
+    static PDPMicroOp decode(unsigned long instr);
+
+    template <class Policy>
+    bool stepWith();
+
+    template <class Policy>
+    bool stepJit(uint64_t limit);
+
+    template <class Policy>
+    void runUntil(uint64_t limit);
+
+    // points stepVariant and runVariant at the Policy instantiations
+    template <class Policy>
+    void usePolicy() {
+        stepVariant = &PDPProcessor::stepWith<Policy>;
+        runVariant = &PDPProcessor::runUntil<Policy>;
+    }
+
+    /**
+     * Picks the policy for the instrumentation in use, dropping the decode cache (whose handlers
+     * belong to the old policy). Arming breakpoints moves a JIT run onto the micro-op cache.
+     */
+    void selectPolicy();
+
+    /**
+     * Recognizes an idle loop at the PC and applies as many whole iterations as fit before limit at
+     * once, leaving the machine exactly as stepping through them would. The loops are: jmp to
+     * itself; "isp Y / jmp .-1" counting Y up to zero; and "skip / jmp .-1" where the skip is a
+     * skip group instruction, sad or sas whose condition nothing in the loop can change.
+     * Always stops before limit, so the last instructions of a run go through the engine.
+     * @return true if it moved the machine forward
+     */
+    bool fastForward(uint64_t limit);
+
+    void startEngine();
+
+    bool savePending() const { return settings.saveAt > state.retired; }
+
+    void saveIfDue() const;
+
+    /**
+     * Replaces the whole machine state (including memory size, extend mode and sense switches)
+     * with a snapshot written by saveSnapshot.
+     * @throws SnapshotError if the file is missing or malformed, leaving the machine unchanged
+     */
+    void restoreSnapshot(const std::string &filename);
+
+    // micro-op handlers (PDPMicroOp.cpp); the ones with instrumentation hooks are templates over the policy
+
+    template <class Policy> bool opAdd(const PDPMicroOp &op);
+    template <class Policy> bool opSub(const PDPMicroOp &op);
+    template <class Policy> bool opMul(const PDPMicroOp &op);
+    template <class Policy> bool opDiv(const PDPMicroOp &op);
+    template <class Policy> bool opIdx(const PDPMicroOp &op);
+    template <class Policy> bool opIsp(const PDPMicroOp &op);
+    template <class Policy> bool opAnd(const PDPMicroOp &op);
+    template <class Policy> bool opXor(const PDPMicroOp &op);
+    template <class Policy> bool opIor(const PDPMicroOp &op);
+    template <class Policy> bool opLac(const PDPMicroOp &op);
+    template <class Policy> bool opDac(const PDPMicroOp &op);
+    template <class Policy> bool opDap(const PDPMicroOp &op);
+    template <class Policy> bool opDip(const PDPMicroOp &op);
+    template <class Policy> bool opLio(const PDPMicroOp &op);
+    template <class Policy> bool opDio(const PDPMicroOp &op);
+    template <class Policy> bool opDzm(const PDPMicroOp &op);
+    template <class Policy> bool opXct(const PDPMicroOp &op);
+    bool opJmp(const PDPMicroOp &op);
+    bool opDismiss(const PDPMicroOp &op);
+    bool opJsp(const PDPMicroOp &op);
+    template <class Policy> bool opJda(const PDPMicroOp &op);
+    template <class Policy> bool opCal(const PDPMicroOp &op);
+    template <class Policy> bool opSad(const PDPMicroOp &op);
+    template <class Policy> bool opSas(const PDPMicroOp &op);
+    bool opLaw(const PDPMicroOp &op);
+
+    bool opRar(const PDPMicroOp &op);
+    bool opRal(const PDPMicroOp &op);
+    bool opSar(const PDPMicroOp &op);
+    bool opSal(const PDPMicroOp &op);
+    bool opRir(const PDPMicroOp &op);
+    bool opRil(const PDPMicroOp &op);
+    bool opSir(const PDPMicroOp &op);
+    bool opSil(const PDPMicroOp &op);
+    bool opRcr(const PDPMicroOp &op);
+    bool opRcl(const PDPMicroOp &op);
+    bool opScr(const PDPMicroOp &op);
+    bool opScl(const PDPMicroOp &op);
+
+    template <class Policy> bool opSkip(const PDPMicroOp &op);
+    bool skipCondition(const PDPMicroOp &op) const;
+
+    bool opCli(const PDPMicroOp &op);
+    bool opLap(const PDPMicroOp &op);
+    bool opCma(const PDPMicroOp &op);
+    bool opHlt(const PDPMicroOp &op);
+    bool opCla(const PDPMicroOp &op);
+    bool opNop(const PDPMicroOp &op);
+    bool opFlag(const PDPMicroOp &op);
+
+    bool opIot(const PDPMicroOp &op);
+
+    bool opIllegal(const PDPMicroOp &op);
+
 public:
 
+    /**
+     * Loads the tape, or restores the snapshot if settings.restoreFile is set.
+     * @throws TapeFormatError, SnapshotError
+     */
     PDPProcessor(const PDPSettings &settings);
 
+    /**
+     * Starts from a tape image that has already been loaded, e.g. one shared by several processors.
+     * @param settings: simulator settings (tapeFile is only used in error messages)
+     * @param image: words to place at address 0 onwards
+     * @throws TapeFormatError if the image does not fit in memory
+     */
+    PDPProcessor(const PDPSettings &settings, const std::vector<WORD> &image);
+
     void printState() const;
 
     bool isDebug() const { return settings.debug; }
 
-    bool step();
+    /**
+     * Executes one instruction (with the JIT, one translated block).
+     * @return false once the machine has stopped
+     */
+    bool step() { return (this->*stepVariant)(); }
+
+    /**
+     * Checks the instruction budget and the time limit (see PDPSettings), stopping the machine with
+     * halt reason BUDGET or TIMEOUT once either is reached.
+     * @param start: when the run started, which the time limit counts from
+     * @return true if a limit was reached
+     */
+    bool limitReached(std::chrono::steady_clock::time_point start);
+
+    /**
+     * Runs without printing until the machine halts, the instruction budget is spent, the
+     * time limit passes, or a breakpoint or watchpoint fires, whichever comes first (see PDPSettings).
+     * With settings.realTime, sleeps every REALTIME_CHUNK instructions so machine time keeps pace
+     * with the host clock.
+     */
+    void run();
+
+    /**
+     * Runs until exactly target instructions have retired or the machine stops, with the same
+     * engine and fast-forwarding as run() but without its budget, time limit or pacing.
+     */
+    void runTo(uint64_t target);
+
+    PDPHaltReason haltReason() const { return state.halt; }
+
+    // the architectural state, for comparing engines (PDPCosim)
+    const PDPState &machineState() const { return state; }
+
+    /**
+     * @return true if the last step() or run() stopped on a breakpoint or watchpoint (see breakHit())
+     */
+    bool stopped() const { return hit.kind != 0; }
+
+    const PDPBreakHit &breakHit() const { return hit; }
+
+    unsigned int memorySize() const { return state.cm.size(); }
+
+    WORD memory(unsigned int addr) const { return state.cm[addr]; }
+
+    /**
+     * Sets or removes breakpoints and watchpoints (see PDPBreakpoints). The processor checks them
+     * only while at least one is armed.
+     */
+    void setBreakpoint(unsigned int addr, const PDPBreakCondition &condition);
+    void setWatchpoint(unsigned int addr, uint8_t mask);
+    void clearBreakpoints(unsigned int addr);
+    void clearAllBreakpoints();
+
+    void listBreakpoints(std::ostream &os) const { breakpoints.list(os); }
+
+    /**
+     * 64-bit FNV-1a digest of core memory.
+     */
+    uint64_t memoryDigest() const;
+
+    /**
+     * Writes a one-line JSON summary of the run: instructions retired, halt reason,
+     * final registers and the memory digest.
+     */
+    void writeSummary(std::ostream &os) const;
+
+    /**
+     * Writes the fields of the writeSummary object, without the surrounding braces, so callers can
+     * add fields of their own.
+     */
+    void writeSummaryFields(std::ostream &os) const;
+
+    bool isProfiling() const { return profile != nullptr; }
+
+    /**
+     * Writes the profiler's hot-spot report (see PDPProfile::writeReport). Only valid with --profile.
+     */
+    void writeProfile(std::ostream &os) const;
+
+    bool isTracing() const { return trace != nullptr; }
+
+    /**
+     * Writes the complete machine state (registers, flags, sense switches, instruction count
+     * and core memory) to a snapshot file (PDPSnapshot.cpp).
+     * @throws SnapshotError if the file cannot be written
+     */
+    void saveSnapshot(const std::string &filename) const;
 
 };
 
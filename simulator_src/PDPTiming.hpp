@@ -0,0 +1,53 @@
+//
+// PDP-1 Simulator
+// Instruction Timing
+//
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+// length of one core memory cycle, the PDP-1's unit of time
+#define CYCLE_NS 5000
+
+/**
+ * Memory cycles taken by each instruction, indexed by the 6-bit opcode (indirect bit clear),
+ * after the PDP-1 Handbook: instructions that touch an operand in memory take a fetch and an
+ * execute cycle, everything else (jumps, law, skips, shifts, operates) only the fetch. mul and
+ * div get their typical Type 10 times. Indirection and xct are not in the table: each level of
+ * indirection adds a cycle (counted by resolveChain, once per instruction), and xct adds
+ * the cycles of the instruction it executes.
+ */
+constexpr std::array<uint8_t, 64> makeCycleTable() {
+    std::array<uint8_t, 64> table{};
+    for (uint8_t &cycles : table) cycles = 1;
+
+    for (unsigned int opcode : {002, 004, 006, 016, 020, 022, 024, 026, 030, 032, 034, 040, 042, 044, 046, 050, 052}) {
+        table[opcode] = 2;
+    }
+    table[054] = 3;     // mul, ~14 us
+    table[056] = 5;     // div, ~25 us
+    return table;
+}
+
+inline constexpr std::array<uint8_t, 64> CYCLE_TABLE = makeCycleTable();
+
+/**
+ * @return the memory cycles taken by instr, not counting indirection or an xct target
+ */
+constexpr unsigned int instructionCycles(unsigned long instr) {
+    return CYCLE_TABLE[(instr >> 12) & 076];
+}
+
+/**
+ * @return the most cycles any instruction takes, not counting indirection or an xct target
+ */
+constexpr unsigned int maxInstructionCycles() {
+    unsigned int most = 0;
+    for (uint8_t cycles : CYCLE_TABLE) most = cycles > most ? cycles : most;
+    return most;
+}
+
+static_assert(instructionCycles(0200100) == 2, "lac takes a fetch and an execute cycle");
+static_assert(instructionCycles(0600100) == 1, "jmp takes only the fetch cycle");
@@ -0,0 +1,173 @@
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "PDPTrace.hpp"
+
+static void putWord(std::vector<uint8_t> &out, uint32_t v) {
+    for (int i = 0; i < 4; ++i) out.push_back((v >> (8 * i)) & 0xFF);
+}
+
+static void putVarint(std::vector<uint8_t> &out, uint32_t v) {
+    while (v >= 0x80) {
+        out.push_back((v & 0x7F) | 0x80);
+        v >>= 7;
+    }
+    out.push_back(v);
+}
+
+PDPTraceWriter::PDPTraceWriter(const std::string &filename_in)
+        : ring(TRACE_RING_SIZE), filename{filename_in}, os(filename_in, std::ios::binary | std::ios::trunc) {
+    if (!os) throw TraceError{filename + ": could not create trace file"};
+
+    std::vector<uint8_t> header(TRACE_MAGIC, TRACE_MAGIC + TRACE_MAGIC_SIZE);
+    putWord(header, TRACE_VERSION);
+    putWord(header, 0);
+    os.write(reinterpret_cast<const char *>(header.data()), header.size());
+
+    drainer = std::thread(&PDPTraceWriter::drain, this);
+}
+
+PDPTraceWriter::~PDPTraceWriter() {
+    closing.store(true, std::memory_order_release);
+    drainer.join();
+    if (failed()) std::cerr << filename << ": " << failure << ", trace is incomplete" << std::endl;
+}
+
+void PDPTraceWriter::drain() {
+    PDPTraceRecord last {0xFFFF, TRACE_NO_ADDRESS, 0, 0, 0};
+    std::vector<uint32_t> lastInstr(1 << 16, UINT32_MAX);
+
+    std::vector<uint8_t> encoded;
+    uint32_t records = 0;
+
+    auto fail = [&](const char *what) {
+        failure = std::string(what) + (errno ? std::string(": ") + std::strerror(errno) : "");
+        writeFailed.store(true, std::memory_order_release);
+    };
+
+    auto flush = [&]() {
+        std::vector<uint8_t> frame;
+        putWord(frame, encoded.size());
+        putWord(frame, records);
+        errno = 0;
+        os.write(reinterpret_cast<const char *>(frame.data()), frame.size());
+        os.write(reinterpret_cast<const char *>(encoded.data()), encoded.size());
+        if (!os) fail("could not write trace");
+        encoded.clear();
+        records = 0;
+    };
+
+    while (true) {
+        // read closing first: once it is set, head no longer moves
+        bool finishing = closing.load(std::memory_order_acquire);
+        uint64_t t = tail.load(std::memory_order_relaxed);
+        uint64_t h = head.load(std::memory_order_acquire);
+
+        if (t == h) {
+            if (finishing) break;
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            continue;
+        }
+
+        // after a failed write, only keep the ring moving
+        if (failed()) t = h;
+
+        for (; t < h; ++t) {
+            const PDPTraceRecord &r = ring[t & (TRACE_RING_SIZE - 1)];
+
+            uint8_t flags = 0;
+            if (static_cast<uint16_t>(last.pc + 1) == r.pc) flags |= TRACE_SEQUENTIAL;
+            if (lastInstr[r.pc] == r.instr) flags |= TRACE_SAME_INSTR;
+            if (r.addr != TRACE_NO_ADDRESS) {
+                flags |= TRACE_ADDRESS;
+                if (r.addr == (r.instr & 07777)) flags |= TRACE_DIRECT;
+            }
+            if (r.ac == last.ac) flags |= TRACE_SAME_AC;
+            if (r.io == last.io) flags |= TRACE_SAME_IO;
+
+            encoded.push_back(flags);
+            if (!(flags & TRACE_SEQUENTIAL)) putVarint(encoded, r.pc);
+            if (!(flags & TRACE_SAME_INSTR)) putVarint(encoded, r.instr);
+            if ((flags & TRACE_ADDRESS) && !(flags & TRACE_DIRECT)) putVarint(encoded, r.addr);
+            if (!(flags & TRACE_SAME_AC)) putVarint(encoded, r.ac ^ last.ac);
+            if (!(flags & TRACE_SAME_IO)) putVarint(encoded, r.io ^ last.io);
+
+            lastInstr[r.pc] = r.instr;
+            last = r;
+            if (++records == TRACE_BLOCK) flush();
+        }
+        tail.store(t, std::memory_order_release);
+    }
+
+    if (failed()) return;
+    if (records) flush();
+    if (failed()) return;
+    errno = 0;
+    os.close();
+    if (!os) fail("could not write trace");
+}
+
+PDPTraceReader::PDPTraceReader(const std::string &filename_in) : is(filename_in, std::ios::binary), filename(filename_in), lastInstr(1 << 16, UINT32_MAX) {
+    if (!is) throw TraceError{filename + ": could not open trace file"};
+
+    uint8_t header[TRACE_HEADER_SIZE];
+    if (!is.read(reinterpret_cast<char *>(header), sizeof(header)) || std::memcmp(header, TRACE_MAGIC, TRACE_MAGIC_SIZE) != 0) {
+        throw TraceError{filename + ": not a trace file"};
+    }
+    uint32_t version = header[8] | (header[9] << 8) | (header[10] << 16) | (static_cast<uint32_t>(header[11]) << 24);
+    if (version != TRACE_VERSION) throw TraceError{filename + ": unsupported trace version " + std::to_string(version)};
+}
+
+uint32_t PDPTraceReader::varint() {
+    uint32_t v = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        if (at >= block.size()) throw TraceError{filename + ": malformed trace block"};
+        uint8_t b = block[at++];
+        v |= static_cast<uint32_t>(b & 0x7F) << shift;
+        if (!(b & 0x80)) return v;
+    }
+    throw TraceError{filename + ": malformed trace block"};
+}
+
+bool PDPTraceReader::next(PDPTraceRecord &record) {
+    if (!left) {
+        uint8_t frame[8];
+        if (!is.read(reinterpret_cast<char *>(frame), sizeof(frame))) {
+            if (is.gcount() == 0) return false;
+            throw TraceError{filename + ": truncated trace"};
+        }
+        uint32_t size = frame[0] | (frame[1] << 8) | (frame[2] << 16) | (static_cast<uint32_t>(frame[3]) << 24);
+        left = frame[4] | (frame[5] << 8) | (frame[6] << 16) | (static_cast<uint32_t>(frame[7]) << 24);
+
+        block.resize(size);
+        if (!is.read(reinterpret_cast<char *>(block.data()), size)) throw TraceError{filename + ": truncated trace"};
+        at = 0;
+        if (!left) return next(record);
+    }
+
+    if (at >= block.size()) throw TraceError{filename + ": malformed trace block"};
+    uint8_t flags = block[at++];
+
+    PDPTraceRecord r;
+    r.pc = (flags & TRACE_SEQUENTIAL) ? static_cast<uint16_t>(last.pc + 1) : static_cast<uint16_t>(varint());
+    r.instr = (flags & TRACE_SAME_INSTR) ? lastInstr[r.pc] : varint();
+    r.addr = TRACE_NO_ADDRESS;
+    if (flags & TRACE_ADDRESS) r.addr = (flags & TRACE_DIRECT) ? (r.instr & 07777) : static_cast<uint16_t>(varint());
+    r.ac = (flags & TRACE_SAME_AC) ? last.ac : (last.ac ^ varint());
+    r.io = (flags & TRACE_SAME_IO) ? last.io : (last.io ^ varint());
+
+    lastInstr[r.pc] = r.instr;
+    last = r;
+    --left;
+    record = r;
+    return true;
+}
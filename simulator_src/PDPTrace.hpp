@@ -0,0 +1,143 @@
+//
+// PDP-1 Simulator
+// Binary Execution Trace
+//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Trace files are a 16-byte header (magic, version, reserved) followed by blocks of up to
+// TRACE_BLOCK records: uint32 LE encoded size, uint32 LE record count, then the records.
+// Each record is a flag byte followed by the fields that differ from what the flags predict
+// (see the TRACE_* flag bits), as LEB128 varints. The prediction state carries over from
+// block to block, so traces decode front to back.
+
+#define TRACE_MAGIC         "PDP1TRCE"
+#define TRACE_MAGIC_SIZE    8
+#define TRACE_VERSION       1
+#define TRACE_HEADER_SIZE   16
+
+// records per block, and records the ring buffer holds before the simulator waits for the drain thread
+#define TRACE_BLOCK         4096
+#define TRACE_RING_SIZE     (1 << 16)
+
+// PDPTraceRecord::addr for instructions that do not reference memory
+#define TRACE_NO_ADDRESS    0xFFFF
+
+#define TRACE_SEQUENTIAL    0x01    // pc is the previous record's pc + 1
+#define TRACE_SAME_INSTR    0x02    // instr is the one last traced at this pc
+#define TRACE_ADDRESS       0x04    // the instruction referenced memory
+#define TRACE_DIRECT        0x08    // ... at the address in its own operand field
+#define TRACE_SAME_AC       0x10    // ac is unchanged (otherwise the XOR with the old ac follows)
+#define TRACE_SAME_IO       0x20    // io is unchanged (likewise)
+
+/**
+ * One executed instruction, with the registers as the instruction left them.
+ */
+struct PDPTraceRecord {
+    uint16_t    pc;
+    uint16_t    addr;       // effective address of the memory operand, or TRACE_NO_ADDRESS
+    uint32_t    instr;
+    uint32_t    ac;
+    uint32_t    io;
+};
+
+struct TraceError {
+    std::string                error;
+};
+
+/**
+ * Writes a trace file from a background thread. The simulator pushes records into a
+ * single-producer single-consumer ring buffer; the drain thread encodes them in blocks and
+ * writes them out. push() only waits if the ring is full.
+ */
+class PDPTraceWriter {
+
+private:
+
+    std::vector<PDPTraceRecord> ring;
+    alignas(64) std::atomic<uint64_t> head {0};     // next slot to fill, written by push()
+    alignas(64) std::atomic<uint64_t> tail {0};     // next slot to drain, written by the drain thread
+    std::atomic<bool> closing {false};
+
+    std::string filename;
+    std::ofstream os;
+    std::thread drainer;
+
+    // set by the drain thread when a write fails, after it has filled in failure; the drain thread
+    // then discards records rather than stall push()
+    std::atomic<bool> writeFailed {false};
+    std::string failure;
+
+    void drain();
+
+public:
+
+    /**
+     * Creates the trace file and starts the drain thread.
+     * @throws TraceError if the file cannot be created
+     */
+    PDPTraceWriter(const std::string &filename);
+
+    /**
+     * Writes out everything still in the ring and closes the file, reporting on stderr if any
+     * write failed (the trace then ends early).
+     */
+    ~PDPTraceWriter();
+
+    PDPTraceWriter(const PDPTraceWriter &) = delete;
+    PDPTraceWriter &operator=(const PDPTraceWriter &) = delete;
+
+    /**
+     * @return whether a write to the trace file has failed
+     */
+    bool failed() const { return writeFailed.load(std::memory_order_acquire); }
+
+    void push(const PDPTraceRecord &record) {
+        uint64_t h = head.load(std::memory_order_relaxed);
+        while (h - tail.load(std::memory_order_acquire) == TRACE_RING_SIZE) std::this_thread::yield();
+        ring[h & (TRACE_RING_SIZE - 1)] = record;
+        head.store(h + 1, std::memory_order_release);
+    }
+
+};
+
+/**
+ * Reads a trace file written by PDPTraceWriter, one record at a time.
+ */
+class PDPTraceReader {
+
+private:
+
+    std::ifstream is;
+    std::string filename;
+
+    std::vector<uint8_t> block;
+    size_t at = 0;
+    uint32_t left = 0;          // records left in the current block
+
+    PDPTraceRecord last {0xFFFF, TRACE_NO_ADDRESS, 0, 0, 0};
+    std::vector<uint32_t> lastInstr;
+
+    uint32_t varint();
+
+public:
+
+    /**
+     * @throws TraceError if the file is missing or not a trace
+     */
+    PDPTraceReader(const std::string &filename);
+
+    /**
+     * @return false at the end of the trace
+     * @throws TraceError if the trace is truncated or malformed
+     */
+    bool next(PDPTraceRecord &record);
+
+};
@@ -0,0 +1,222 @@
+//
+// PDP-1 Simulator
+// Machine Word Types
+//
+
+#pragma once
+
+#include <cstdint>
+#include <iostream>
+
+#define MINUS_ZERO 0777777
+
+/**
+ * A fixed-width PDP-1 register of N bits, packed into a native uint32_t.
+ * Bit numbering follows std::bitset (bit 0 is the least significant bit), and values are
+ * always kept masked to N bits, so plain integer operations never leak into higher bits.
+ */
+template <unsigned int N>
+struct PDPRegister {
+    static constexpr uint32_t MASK = (uint32_t{1} << N) - 1;
+
+    uint32_t value = 0;
+
+    constexpr PDPRegister(unsigned long v = 0) : value(static_cast<uint32_t>(v & MASK)) {}
+
+    constexpr bool operator[](unsigned int i) const { return (value >> i) & 1; }
+
+    constexpr void set(unsigned int i, bool b) {
+        value = b ? (value | (uint32_t{1} << i)) : (value & ~(uint32_t{1} << i));
+        value &= MASK;
+    }
+
+    constexpr bool none() const { return value == 0; }
+    constexpr bool all() const { return value == MASK; }
+
+    constexpr bool negative() const { return (value >> (N - 1)) & 1; }
+
+    constexpr PDPRegister rotateLeft(unsigned int n) const {
+        return (value << n) | (value >> (N - n));
+    }
+
+    constexpr PDPRegister rotateRight(unsigned int n) const {
+        return (value >> n) | (value << (N - n));
+    }
+
+    constexpr PDPRegister operator~() const { return ~value; }
+    constexpr PDPRegister operator&(PDPRegister o) const { return value & o.value; }
+    constexpr PDPRegister operator|(PDPRegister o) const { return value | o.value; }
+    constexpr PDPRegister operator^(PDPRegister o) const { return value ^ o.value; }
+    constexpr PDPRegister operator<<(unsigned int n) const { return value << n; }
+    constexpr PDPRegister operator>>(unsigned int n) const { return value >> n; }
+
+    constexpr PDPRegister &operator&=(PDPRegister o) { value &= o.value; return *this; }
+    constexpr PDPRegister &operator|=(PDPRegister o) { value |= o.value; return *this; }
+    constexpr PDPRegister &operator^=(PDPRegister o) { value ^= o.value; return *this; }
+    constexpr PDPRegister &operator<<=(unsigned int n) { value = (value << n) & MASK; return *this; }
+    constexpr PDPRegister &operator>>=(unsigned int n) { value >>= n; return *this; }
+
+    constexpr bool operator==(PDPRegister o) const { return value == o.value; }
+    constexpr bool operator!=(PDPRegister o) const { return value != o.value; }
+};
+
+/**
+ * Prints the register as N binary digits, most significant first (same format as std::bitset).
+ */
+template <unsigned int N>
+std::ostream &operator<<(std::ostream &os, PDPRegister<N> r) {
+    char buf[N + 1];
+    for (unsigned int i = 0; i < N; ++i) buf[i] = r[N - 1 - i] ? '1' : '0';
+    buf[N] = '\0';
+    return os << buf;
+}
+
+using PDPWord = PDPRegister<18>;
+
+#define WORD PDPWord
+
+// one's complement helpers
+
+constexpr int onesComplementToInt(WORD oc) {
+    if (oc.negative()) {
+        return -((~static_cast<int>(oc.value)) & 0377777);
+    } else {
+        return static_cast<int>(oc.value);
+    }
+}
+
+constexpr WORD intToOnesComplement(int val) {
+    if (val < 0) {
+        return {static_cast<unsigned long>(((~-val) & 0377777) | 0400000)};
+    } else {
+        return {static_cast<unsigned long>(val & 0377777)};
+    }
+}
+
+/**
+ * One's complement addition with end-around carry, as performed by add. A -0 result is folded to +0.
+ */
+constexpr WORD onesAdd(WORD a, WORD b) {
+    uint32_t sum = a.value + b.value;
+    if (sum & 01000000) sum = (sum & 0777777) + 1;
+    if (sum == MINUS_ZERO) sum = 0;
+    return sum;
+}
+
+/**
+ * One's complement subtraction a - b with end-around borrow, as performed by sub. A -0 result is
+ * folded to +0, even for -0 - +0.
+ */
+constexpr WORD onesSub(WORD a, WORD b) {
+    uint32_t diff = (a.value | 01000000) - b.value;
+    if (!(diff & 01000000)) diff -= 1;
+    else diff &= 0777777;
+    if (diff == MINUS_ZERO) diff = 0;
+    return diff;
+}
+
+/**
+ * Whether add of a and b (producing sum) overflowed: same-signed operands, different-signed result.
+ */
+constexpr bool addOverflows(WORD a, WORD b, WORD sum) {
+    return a.negative() == b.negative() && sum.negative() != a.negative();
+}
+
+/**
+ * The AC and IO pair that mul and div leave their results in.
+ */
+struct WordPair {
+    WORD ac;
+    WORD io;
+};
+
+// the 17-bit magnitude of a one's complement word
+constexpr uint32_t onesMagnitude(WORD w) {
+    return (w.negative() ? ~w.value : w.value) & 0377777;
+}
+
+// a 17-bit magnitude with the given sign, +0 for a zero magnitude
+constexpr WORD signedWord(uint32_t magnitude, bool negative) {
+    return negative && magnitude ? WORD{~magnitude} : WORD{magnitude};
+}
+
+/**
+ * One's complement multiplication a * b, as performed by mul (Type 10 multiply/divide): the 34-bit
+ * product's magnitude goes high half to AC and low half to IO bits 17-1, both complemented if the
+ * product is negative (a zero product is +0).
+ */
+constexpr WordPair onesMul(WORD a, WORD b) {
+    uint64_t product = uint64_t{onesMagnitude(a)} * onesMagnitude(b);
+    bool negative = a.negative() != b.negative() && product != 0;
+    WORD high {static_cast<unsigned long>(product >> 17)};
+    WORD low {static_cast<unsigned long>((product & 0377777) << 1)};
+    return negative ? WordPair{~high, ~low} : WordPair{high, low};
+}
+
+/**
+ * One's complement division of the AC:IO pair (a 34-bit dividend laid out as onesMul leaves a
+ * product) by d, as performed by div: the quotient goes to IO and the remainder, with the
+ * dividend's sign, to AC. The division fails (and div does not skip) when the quotient would not
+ * fit in 17 bits, including division by zero.
+ * @param result: the new AC and IO, if the division succeeds
+ * @return whether the division succeeded
+ */
+constexpr bool onesDiv(WordPair dividend, WORD d, WordPair &result) {
+    bool negative = dividend.ac.negative();
+    WORD high = negative ? ~dividend.ac : dividend.ac;
+    WORD low = negative ? ~dividend.io : dividend.io;
+    uint32_t divisor = onesMagnitude(d);
+    if (high.value >= divisor) return false;
+
+    uint64_t magnitude = (uint64_t{high.value} << 17) | (low.value >> 1);
+    result.io = signedWord(static_cast<uint32_t>(magnitude / divisor), negative != d.negative());
+    result.ac = signedWord(static_cast<uint32_t>(magnitude % divisor), negative);
+    return true;
+}
+
+static_assert(onesAdd(WORD{1}, intToOnesComplement(-1)) == WORD{0}, "1 + -1 must be +0");
+static_assert(onesSub(WORD{5}, WORD{7}) == intToOnesComplement(-2), "5 - 7 must be -2");
+static_assert(onesSub(WORD{MINUS_ZERO}, WORD{0}) == WORD{0}, "-0 - +0 must be +0");
+static_assert(onesSub(WORD{0}, WORD{MINUS_ZERO}) == WORD{0}, "+0 - -0 must be +0");
+static_assert(onesComplementToInt(intToOnesComplement(-370)) == -370, "round trip");
+
+// mul and div, checked against hand-worked results; cosim only shows that the engines agree
+
+constexpr bool mulGives(WORD a, WORD b, WORD ac, WORD io) {
+    WordPair product = onesMul(a, b);
+    return product.ac == ac && product.io == io;
+}
+
+constexpr bool divGives(WordPair dividend, WORD d, WORD quotient, WORD remainder) {
+    WordPair result {};
+    return onesDiv(dividend, d, result) && result.io == quotient && result.ac == remainder;
+}
+
+constexpr bool divFails(WordPair dividend, WORD d) {
+    WordPair result {};
+    return !onesDiv(dividend, d, result);
+}
+
+static_assert(mulGives(WORD{3}, intToOnesComplement(-5), WORD{MINUS_ZERO}, intToOnesComplement(-30)), "3 * -5 must be -15, shifted into IO, with AC -0");
+static_assert(mulGives(intToOnesComplement(-3), intToOnesComplement(-5), WORD{0}, WORD{30}), "-3 * -5 must be +15");
+static_assert(mulGives(WORD{0400}, WORD{01000}, WORD{1}, WORD{0}), "2^8 * 2^9 carries into AC");
+static_assert(mulGives(WORD{0377777}, WORD{0377777}, WORD{0377776}, WORD{2}), "the largest magnitudes fill all 34 bits");
+static_assert(mulGives(WORD{MINUS_ZERO}, WORD{5}, WORD{0}, WORD{0}), "-0 * 5 must be +0");
+static_assert(mulGives(WORD{5}, WORD{MINUS_ZERO}, WORD{0}, WORD{0}), "5 * -0 must be +0");
+static_assert(mulGives(WORD{MINUS_ZERO}, WORD{MINUS_ZERO}, WORD{0}, WORD{0}), "-0 * -0 must be +0");
+
+static_assert(divGives({WORD{0}, WORD{35 << 1}}, WORD{6}, WORD{5}, WORD{5}), "35 / 6 must be 5 remainder 5");
+static_assert(divGives({WORD{MINUS_ZERO}, ~WORD{35 << 1}}, WORD{6}, intToOnesComplement(-5), intToOnesComplement(-5)), "-35 / 6 must be -5 remainder -5");
+static_assert(divGives({WORD{0}, WORD{35 << 1}}, intToOnesComplement(-6), intToOnesComplement(-5), WORD{5}), "35 / -6 must be -5 remainder +5");
+static_assert(divGives({WORD{MINUS_ZERO}, ~WORD{35 << 1}}, intToOnesComplement(-6), WORD{5}, intToOnesComplement(-5)), "-35 / -6 must be +5 remainder -5");
+static_assert(divGives({WORD{MINUS_ZERO}, ~WORD{36 << 1}}, WORD{6}, intToOnesComplement(-6), WORD{0}), "-36 / 6 must leave a +0 remainder");
+static_assert(divGives({WORD{5}, WORD{0}}, WORD{6}, WORD{(5 << 17) / 6}, WORD{(5 << 17) % 6}), "a high half just below the divisor fits");
+static_assert(divGives({WORD{0}, WORD{0}}, WORD{5}, WORD{0}, WORD{0}), "+0 / 5 must be +0 remainder +0");
+static_assert(divGives({WORD{MINUS_ZERO}, WORD{MINUS_ZERO}}, WORD{5}, WORD{0}, WORD{0}), "-0 / 5 must be +0 remainder +0");
+static_assert(divGives({WORD{MINUS_ZERO}, WORD{MINUS_ZERO}}, intToOnesComplement(-5), WORD{0}, WORD{0}), "-0 / -5 must be +0 remainder +0");
+static_assert(divGives(onesMul(intToOnesComplement(-1234), WORD{567}), WORD{567}, intToOnesComplement(-1234), WORD{0}), "div must undo mul");
+static_assert(divFails({WORD{6}, WORD{0}}, WORD{6}), "a quotient of 2^17 overflows");
+static_assert(divFails({intToOnesComplement(-7), WORD{0}}, WORD{6}), "a negative dividend overflows by magnitude");
+static_assert(divFails({WORD{0}, WORD{1 << 1}}, WORD{0}), "division by +0 fails");
+static_assert(divFails({WORD{0}, WORD{1 << 1}}, WORD{MINUS_ZERO}), "division by -0 fails");
+static_assert(divFails({WORD{0}, WORD{0}}, WORD{0}), "0 / 0 fails");
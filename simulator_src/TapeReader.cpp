@@ -1,36 +1,355 @@
 
-#include <array>
-#include <bitset>
-#include <fstream>
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
 #include <iostream>
 #include <optional>
 #include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
 
 #include "TapeReader.hpp"
 
-TapeReader::TapeReader(const std::string &filename) : is{filename} {
-    std::string garbage;
-    std::getline(is, garbage);
+#include "../common_src/TapeFormat.hpp"
+
+// Tape records, as written by TapeWriter:
+//
+//   8 O O O
+//   7
+//   6 . . .        row i holds bits i-1, i+5 and i+11 in columns 2, 4 and 6
+//   5 . . .
+//   4 . . .
+//   ------- <annotation>
+//   3 . . .
+//   2 . . .
+//   1 . . .
+//
+// with row 7 punched ("7 O    ") in a run record, whose bits are a count of zero words.
+
+#define TAPE_RECORD_LINES 9
+
+// tapes that cannot be mapped (pipes, FIFOs) are read this many bytes at a time, at least
+#define TAPE_READ_BLOCK (64 * 1024)
+
+static const char FEED_ROW_8[] = "8 O O O";
+static const char FEED_ROW_7[] = "7      ";
+static const char RUN_ROW_7[]  = "7 O    ";
+
+/**
+ * Finds the line starting at pos and moves pos past it, with the same semantics as std::getline:
+ * the final line need not end in a newline, and only reading at the very end of the buffer fails.
+ */
+static bool nextLine(const char *data, size_t length, size_t &pos, const char *&line, size_t &lineLength) {
+    if (pos >= length) return false;
+    line = data + pos;
+    const char *newline = static_cast<const char *>(std::memchr(line, '\n', length - pos));
+    lineLength = newline ? static_cast<size_t>(newline - line) : length - pos;
+    pos += lineLength + (newline ? 1 : 0);
+    return true;
+}
+
+static bool lineIs(const char *line, size_t lineLength, const char *expected, size_t expectedLength) {
+    return lineLength == expectedLength && std::memcmp(line, expected, expectedLength) == 0;
+}
+
+static bool punched(const char *line, size_t lineLength, size_t column) {
+    return column < lineLength && line[column] == 'O';
 }
 
-std::optional<std::bitset<18>> TapeReader::readWord() {
-    std::array<std::string, 8> lines;
-    for (int i = 0; i < 8; ++i) {
-        if (!std::getline(is, lines[i])) return {};
-        if (i == 5) if (!std::getline(is, lines[i])) return {};
+static bool isRow7(const char *line, size_t lineLength, bool &run) {
+    run = lineIs(line, lineLength, RUN_ROW_7, sizeof(RUN_ROW_7) - 1);
+    return run || lineIs(line, lineLength, FEED_ROW_7, sizeof(FEED_ROW_7) - 1);
+}
+
+TapeReader::TapeReader(const char *data_in, size_t length_in) : data{data_in}, length{length_in}, pos{0} {
+    const char *line;
+    size_t lineLength;
+    nextLine(data, length, pos, line, lineLength);
+}
+
+TapeStop TapeReader::decodeRecord(size_t &at, WORD &word, bool &run) const {
+    const char *lines[TAPE_RECORD_LINES];
+    size_t lengths[TAPE_RECORD_LINES];
+    for (int i = 0; i < TAPE_RECORD_LINES; ++i) {
+        if (!nextLine(data, length, at, lines[i], lengths[i])) return i == 0 ? TapeStop::END : TapeStop::TRUNCATED;
     }
 
-    if (lines[0] != "8 O O O") return {};
-    if (lines[1] != "7      ") return {};
+    if (!lineIs(lines[0], lengths[0], FEED_ROW_8, sizeof(FEED_ROW_8) - 1)) return TapeStop::BAD_RECORD;
+    if (!isRow7(lines[1], lengths[1], run)) return TapeStop::BAD_RECORD;
 
-    std::bitset<18> word;
+    uint32_t value = 0;
     for (int i = 6; i >= 1; --i) {
-        std::string line = lines[8 - i];
-        if (line[2] == 'O') word.set(i-1);
-        if (line[4] == 'O') word.set(i+5);
-        if (line[6] == 'O') word.set(i+11);
+        // rows 6-4 are lines 2-4, the annotation is line 5, rows 3-1 are lines 6-8
+        int l = i >= 4 ? 8 - i : 9 - i;
+        if (punched(lines[l], lengths[l], 2)) value |= uint32_t{1} << (i-1);
+        if (punched(lines[l], lengths[l], 4)) value |= uint32_t{1} << (i+5);
+        if (punched(lines[l], lengths[l], 6)) value |= uint32_t{1} << (i+11);
+    }
+
+    word = WORD{value};
+    return TapeStop::NONE;
+}
+
+std::optional<WORD> TapeReader::readWord() {
+    while (pendingZeros == 0) {
+        if (stop != TapeStop::NONE) return {};
+
+        size_t at = pos;
+        WORD word;
+        bool run;
+        stop = decodeRecord(at, word, run);
+        if (stop != TapeStop::NONE) return {};
+
+        pos = at;
+        if (!run) return word;
+        pendingZeros = word.value;
+    }
+    --pendingZeros;
+    return WORD{0};
+}
+
+size_t TapeReader::syncPoint(size_t from) const {
+    size_t at = from;
+    if (at > 0 && data[at - 1] != '\n') {
+        const char *newline = static_cast<const char *>(std::memchr(data + at, '\n', length - at));
+        if (!newline) return length;
+        at = static_cast<size_t>(newline - data) + 1;
     }
 
-    return word;
+    const char *line;
+    size_t lineLength;
+    while (at < length) {
+        size_t next = at;
+        nextLine(data, length, next, line, lineLength);
+        if (lineIs(line, lineLength, FEED_ROW_8, sizeof(FEED_ROW_8) - 1)) {
+            size_t after = next;
+            bool run;
+            if (nextLine(data, length, after, line, lineLength) && isRow7(line, lineLength, run)) return at;
+        }
+        at = next;
+    }
+    return length;
+}
+
+void TapeReader::decodeChunk(Chunk &chunk) const {
+    size_t at = chunk.start;
+    WORD word;
+    bool run;
+    while (at < chunk.end) {
+        size_t record = at;
+        TapeStop result = decodeRecord(at, word, run);
+        if (result != TapeStop::NONE) {
+            chunk.next = record;
+            chunk.stop = result;
+            return;
+        }
+        if (run) chunk.runs.emplace_back(chunk.words.size(), word.value);
+        else chunk.words.push_back(word);
+    }
+    chunk.next = at;
+    chunk.stop = TapeStop::NONE;
 }
 
+std::optional<size_t> TapeReader::readAll(WORD *cm, size_t size, unsigned int threads) {
+    // the rest of a run readWord stopped partway through
+    size_t words = pendingZeros;
+    if (words > size) return {};
+    std::fill(cm, cm + words, WORD{0});
+    pendingZeros = 0;
+
+    if (stop != TapeStop::NONE) return words;
+
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    size_t remaining = length - pos;
+    size_t count = std::max<size_t>(1, std::min<size_t>(threads, remaining / TAPE_CHUNK_MIN));
+
+    std::vector<Chunk> chunks(count);
+    for (size_t i = 0; i < count; ++i) {
+        chunks[i].end = i + 1 == count ? length : pos + remaining / count * (i + 1);
+    }
+    chunks[0].start = pos;
+
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < count; ++i) {
+        workers.emplace_back([this, &chunks, i]() {
+            Chunk &chunk = chunks[i];
+            chunk.start = syncPoint(chunks[i - 1].end);
+            chunk.words.reserve((chunk.end - std::min(chunk.start, chunk.end)) / 64);
+            decodeChunk(chunk);
+        });
+    }
+    decodeChunk(chunks[0]);
+    for (std::thread &worker : workers) worker.join();
+
+    // stitch the chunks together along the real record boundaries
+    for (Chunk &chunk : chunks) {
+        if (chunk.start != pos) {
+            chunk.start = pos;
+            chunk.words.clear();
+            chunk.runs.clear();
+            decodeChunk(chunk);
+        }
+
+        size_t from = 0;
+        for (const auto &[index, zeros] : chunk.runs) {
+            if (index - from > size - words) return {};
+            std::copy(chunk.words.begin() + from, chunk.words.begin() + index, cm + words);
+            words += index - from;
+            if (zeros > size - words) return {};
+            std::fill(cm + words, cm + words + zeros, WORD{0});
+            words += zeros;
+            from = index;
+        }
+        if (chunk.words.size() - from > size - words) return {};
+        std::copy(chunk.words.begin() + from, chunk.words.end(), cm + words);
+        words += chunk.words.size() - from;
+
+        pos = chunk.next;
+        if (chunk.stop != TapeStop::NONE) {
+            stop = chunk.stop;
+            return words;
+        }
+    }
+
+    stop = TapeStop::END;
+    return words;
+}
+
+static uint32_t readLittleEndian(const uint8_t *bytes) {
+    return uint32_t{bytes[0]} | (uint32_t{bytes[1]} << 8) | (uint32_t{bytes[2]} << 16) | (uint32_t{bytes[3]} << 24);
+}
+
+static std::string tooLarge(const std::string &filename, size_t size) {
+    return filename + ": tape does not fit in " + std::to_string(size) + " words of memory";
+}
+
+/**
+ * Validates a mapped binary tape and copies its words into cm, filling in runs of zeros.
+ * @return an error message, or an empty string on success
+ */
+static std::string loadBinaryImage(const std::string &filename, const uint8_t *data, size_t length, WORD *cm, size_t size, size_t &words) {
+    uint32_t version = readLittleEndian(data + TAPE_BINARY_MAGIC_SIZE);
+    uint32_t reserved = readLittleEndian(data + TAPE_BINARY_MAGIC_SIZE + 4);
+    if (version != 1 && version != TAPE_BINARY_VERSION) return filename + ": unsupported binary tape version " + std::to_string(version);
+    if (reserved != 0) return filename + ": malformed binary tape header";
+
+    size_t payload = length - TAPE_BINARY_HEADER_SIZE;
+    if (payload % sizeof(uint32_t)) return filename + ": truncated binary tape";
+    size_t entries = payload / sizeof(uint32_t);
+    const uint8_t *image = data + TAPE_BINARY_HEADER_SIZE;
+
+    // copy each stretch of plain words as one block, then fill the run after it
+    words = 0;
+    size_t from = 0;
+    while (from < entries) {
+        size_t to = from;
+        while (to < entries && !(version > 1 && (image[to * sizeof(uint32_t) + 3] & 0x80))) ++to;
+
+        if (to - from > size - words) return tooLarge(filename, size);
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        // the file layout is the in-memory WORD layout
+        std::memcpy(static_cast<void *>(cm + words), image + from * sizeof(uint32_t), (to - from) * sizeof(uint32_t));
+#else
+        for (size_t i = from; i < to; ++i) cm[words + i - from].value = readLittleEndian(image + i * sizeof(uint32_t));
+#endif
+        uint32_t stray = 0;
+        for (size_t i = words; i < words + (to - from); ++i) stray |= cm[i].value;
+        if (stray & ~WORD::MASK) return filename + ": binary tape word wider than 18 bits";
+        words += to - from;
+
+        if (to == entries) break;
+        size_t zeros = readLittleEndian(image + to * sizeof(uint32_t)) & TAPE_BINARY_RUN_COUNT;
+        if (zeros > size - words) return tooLarge(filename, size);
+        std::fill(cm + words, cm + words + zeros, WORD{0});
+        words += zeros;
+        from = to + 1;
+    }
+
+    return "";
+}
+
+/**
+ * Loads a tape held in memory, binary or ASCII art depending on its first bytes.
+ * @return the number of words loaded
+ * @throws TapeFormatError as loadTape does
+ */
+static size_t loadTapeData(const std::string &filename, const char *data, size_t length, WORD *cm, size_t size) {
+    size_t words = 0;
+    std::string error;
+
+    if (length >= TAPE_BINARY_HEADER_SIZE && std::memcmp(data, TAPE_BINARY_MAGIC, TAPE_BINARY_MAGIC_SIZE) == 0) {
+        error = loadBinaryImage(filename, reinterpret_cast<const uint8_t *>(data), length, cm, size, words);
+    } else {
+        TapeReader tr(data, length);
+        std::optional<size_t> decoded = tr.readAll(cm, size, TAPE_THREADS);
+        if (!decoded) error = tooLarge(filename, size);
+        else words = decoded.value();
+
+        if (decoded && tr.stopReason() != TapeStop::END) {
+            std::cerr << filename << ": ignoring " << (tr.stopReason() == TapeStop::TRUNCATED ? "truncated" : "malformed")
+                      << " record at byte " << tr.stopOffset() << std::endl;
+        }
+    }
+
+    if (!error.empty()) throw TapeFormatError{error};
+    return words;
+}
+
+size_t loadTape(const std::string &filename, WORD *cm, size_t size) {
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) throw TapeFormatError{filename + ": " + std::strerror(errno)};
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        int err = errno;
+        close(fd);
+        throw TapeFormatError{filename + ": " + std::strerror(err)};
+    }
+
+    // pipes, FIFOs and devices have no size to map: read them to the end instead
+    if (!S_ISREG(st.st_mode)) {
+        std::vector<char> buffer;
+        size_t length = 0;
+        while (true) {
+            if (buffer.size() - length < TAPE_READ_BLOCK) buffer.resize(std::max<size_t>(2 * buffer.size(), TAPE_READ_BLOCK));
+            ssize_t got = read(fd, buffer.data() + length, buffer.size() - length);
+            if (got < 0 && errno == EINTR) continue;
+            if (got < 0) {
+                int err = errno;
+                close(fd);
+                throw TapeFormatError{filename + ": " + std::strerror(err)};
+            }
+            if (got == 0) break;
+            length += static_cast<size_t>(got);
+        }
+        close(fd);
+        if (length == 0) throw TapeFormatError{filename + ": empty tape"};
+        return loadTapeData(filename, buffer.data(), length, cm, size);
+    }
+
+    size_t length = static_cast<size_t>(st.st_size);
+    if (length == 0) {
+        close(fd);
+        throw TapeFormatError{filename + ": empty tape"};
+    }
+
+    void *mapped = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) throw TapeFormatError{filename + ": " + std::strerror(errno)};
+    madvise(mapped, length, MADV_SEQUENTIAL);
+
+    size_t words;
+    try {
+        words = loadTapeData(filename, static_cast<const char *>(mapped), length, cm, size);
+    } catch (const TapeFormatError &) {
+        munmap(mapped, length);
+        throw;
+    }
+    munmap(mapped, length);
+    return words;
+}
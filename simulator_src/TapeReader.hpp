@@ -1,26 +1,121 @@
-
 //
 // PDP-1 Simulator
 // Punched Tape Reader
 //
 
-#include <bitset>
-#include <fstream>
-#include <iostream>
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
 #include <optional>
 #include <string>
+#include <utility>
+#include <vector>
+
+#include "PDPWord.hpp"
+
+// ASCII tapes smaller than this many bytes per thread are decoded on a single thread, and the most
+// threads loadTape decodes one on (0 for one per hardware thread). Both can be set on the command line
+// (see checks/chunks.sh).
+#ifndef TAPE_CHUNK_MIN
+#define TAPE_CHUNK_MIN (256 * 1024)
+#endif
+#ifndef TAPE_THREADS
+#define TAPE_THREADS 0
+#endif
 
+enum class TapeStop {
+    NONE,           // still reading
+    END,            // clean end of tape
+    TRUNCATED,      // the tape ended partway through a record
+    BAD_RECORD      // a record did not start with the "8 O O O" / "7" feed rows
+};
+
+/**
+ * Decodes ASCII art tapes (as written by the assembler's TapeWriter) from a buffer in memory.
+ * A run record (for .space) stands for that many zero words.
+ * Like the original line-by-line reader, decoding stops quietly at the first record that is
+ * truncated or malformed; stopReason() and stopOffset() say where and why.
+ */
 class TapeReader {
 
 private:
 
-    std::ifstream is;
+    struct Chunk {
+        size_t              start;
+        size_t              end;        // decode records that start before this offset
+        size_t              next;       // offset of the first record not decoded
+        TapeStop            stop;
+        std::vector<WORD>   words;
+        std::vector<std::pair<size_t, size_t>> runs;    // (index in words, count) of each run of zeros, in order
+    };
+
+    const char *data;
+    size_t length;
+    size_t pos;
+
+    TapeStop stop = TapeStop::NONE;
+    uint32_t pendingZeros = 0;      // left of a run record readWord is partway through
+
+    TapeStop decodeRecord(size_t &at, WORD &word, bool &run) const;
+
+    size_t syncPoint(size_t from) const;
+
+    void decodeChunk(Chunk &chunk) const;
 
 public:
 
-    TapeReader(const std::string &filename);
+    /**
+     * Skips the tape's header line. The buffer must outlive the reader.
+     * @param data: tape contents
+     * @param length: number of bytes in data
+     */
+    TapeReader(const char *data, size_t length);
+
+    /**
+     * @return the next word, or nothing once the tape ends or a record is rejected
+     */
+    std::optional<WORD> readWord();
 
-    std::optional<std::bitset<18>> readWord();
+    /**
+     * Decodes the rest of the tape into cm, splitting it into chunks decoded in parallel, and
+     * zero-fills runs as blocks. Chunks
+     * resynchronize on the next "8 O O O" / "7" record start and are then checked against the
+     * record boundaries found by their predecessor, falling back to sequential decoding whenever
+     * they disagree, so the result is always the same as calling readWord() until it fails.
+     * @param cm: destination for the decoded words
+     * @param size: number of words in cm
+     * @param threads: maximum number of threads to use (0 for one per hardware thread)
+     * @return the number of words decoded, or nothing if they do not fit in cm
+     */
+    std::optional<size_t> readAll(WORD *cm, size_t size, unsigned int threads = 0);
+
+    /**
+     * @return why decoding stopped (TapeStop::NONE while words remain)
+     */
+    TapeStop stopReason() const { return stop; }
+
+    /**
+     * @return byte offset of the next record, i.e. of the rejected record once decoding has stopped
+     */
+    size_t stopOffset() const { return pos; }
+
+};
 
+struct TapeFormatError {
+    std::string                error;
 };
 
+/**
+ * Loads a tape into core memory, detecting its format from the first bytes of the file.
+ * Binary tapes (see common_src/TapeFormat.hpp) are copied into core a block at a time, with runs of
+ * zeros filled in bulk; anything else is decoded as ASCII art with TapeReader. Either way a regular
+ * file is read through mmap; anything else (a pipe, a FIFO) is read into a buffer first.
+ * @param filename: tape file
+ * @param cm: core memory to fill, starting at address 0
+ * @param size: number of words in cm
+ * @return the number of words loaded
+ * @throws TapeFormatError if the file cannot be read, is empty, is a malformed binary tape or does not
+ * fit in cm
+ */
+size_t loadTape(const std::string &filename, WORD *cm, size_t size);
@@ -0,0 +1,124 @@
+
+//
+// PDP-1 Simulator
+// Multi-Core Batch Runner
+//
+// Batch CLI
+// ./batch [FLAGS] JOBLIST
+//
+// Runs every job in JOBLIST ("-" for stdin) headless, spread over a pool of worker threads, and
+// prints one JSON result row per job to stdout, in job order.
+//
+// Job list format: one job per line, as whitespace-separated fields
+//   TAPE [SWITCHES [MEMORY [BUDGET]]]
+//   TAPE:     tape file (ASCII art or binary, loaded once however many jobs use it)
+//   SWITCHES: sense switch mask, bit 0 = sense switch 1 (decimal, 0x hex or 0 octal; default 0)
+//   MEMORY:   memory size, as for the simulator's --mem (default 4K)
+//   BUDGET:   instruction budget (default: run until the machine halts)
+// Blank lines and lines starting with '#' are ignored.
+//
+// Result rows:
+//   {"job": N, "tape": ..., "switches": ..., "memory": ..., "budget": ..., "instructions": ...,
+//    "halt": ..., "pc": ..., "ac": ..., "io": ..., "pf": ..., "overflow": ..., "memory_digest": ...}
+// or, if the job's tape could not be loaded, {"job": N, ..., "error": "..."}
+//
+// Flags:
+//   -j / --jobs <N>: number of worker threads (default: one per hardware thread)
+//   -E / --engine <E>: execution engine for every job, as for the simulator (default "cached")
+//   -e / --extend: enables Extended Mode for every job
+//   -t / --time-limit <S>: per-job wall-clock limit in seconds (halt reason "timeout")
+//   -L / --lanes <N>: runs jobs that share a tape, memory size and budget in lockstep, up to N at a
+//     time, on the SIMD ensemble engine (AVX2 kernels over structure-of-arrays state, with a scalar
+//     fallback on other hosts or with --engine interp). The time limit then applies per ensemble.
+//
+// The batch runner exits with status 1 if any job failed to load or stopped on an illegal instruction or
+// an indirect chain loop.
+//
+
+#include <fstream>
+#include <getopt.h>
+#include <iostream>
+#include <string>
+
+#include "PDPBatch.hpp"
+#include "PDPSettings.hpp"
+
+void usage() {
+    std::cout << "Usage:\n"
+              << "./batch [--jobs N] [--engine E] [--extend] [--time-limit S] [--lanes N] JOBLIST\n";
+    exit(1);
+}
+
+int main(int argc, char** argv) {
+    PDPSettings base;
+    base.batch = true;
+    unsigned int threads = 0;
+    unsigned int lanes = 0;
+
+    option long_options[] = {
+        {"jobs", required_argument, nullptr, 'j'},
+        {"engine", required_argument, nullptr, 'E'},
+        {"extend", no_argument, nullptr, 'e'},
+        {"time-limit", required_argument, nullptr, 't'},
+        {"lanes", required_argument, nullptr, 'L'},
+        {nullptr, 0, nullptr, 0}
+    };
+
+    int c;
+    while ((c = getopt_long(argc, argv, "j:E:et:L:", long_options, nullptr)) != -1) {
+        switch (c) {
+        case 'j':
+            threads = numberOption("jobs", optarg, 0, UINT16_MAX);
+            break;
+        case 'E':
+            {
+                std::string arg = optarg;
+                if (arg == "interp") {
+                    base.engine = PDPEngine::INTERPRETER;
+                }
+                else if (arg == "cached") {
+                    base.engine = PDPEngine::DECODED;
+                }
+                else if (arg == "jit") {
+                    base.engine = PDPEngine::JIT;
+                }
+                else {
+                    usage();
+                }
+                break;
+            }
+        case 'e':
+            base.extend = true;
+            break;
+        case 't':
+            base.timeLimit = secondsOption("time-limit", optarg);
+            break;
+        case 'L':
+            lanes = numberOption("lanes", optarg, 0, UINT16_MAX);
+            break;
+        default:
+            usage();
+        }
+    }
+    if (optind != argc - 1) usage();
+
+    std::string listFile = argv[optind];
+    std::ifstream file;
+    if (listFile != "-") {
+        file.open(listFile);
+        if (!file) {
+            std::cerr << listFile << ": cannot open job list" << std::endl;
+            return 1;
+        }
+    }
+
+    std::vector<PDPJob> jobs;
+    try {
+        jobs = parseJobList(listFile == "-" ? std::cin : file);
+    } catch (const JobListError &e) {
+        std::cerr << listFile << ": " << e.error << std::endl;
+        return 1;
+    }
+
+    return runBatch(jobs, base, threads, lanes, std::cout) ? 1 : 0;
+}
@@ -0,0 +1,190 @@
+//
+// PDP-1 Simulator
+// Engine Co-Simulation
+//
+// Co-simulation CLI
+// ./cosim [FLAGS] [TAPE...]
+//
+// Runs every TAPE, and any number of random programs, on the reference interpreter and a candidate
+// engine side by side, comparing their architectural state every N instructions. Prints one line
+// per tape, "ok" with its instruction count and halt reason or "DIVERGED" followed by the first
+// instruction after which the two machines' states differ, then a total. Random programs only get
+// a line of their own if they diverge (or with --verbose); rerun one with its seed and --random 1.
+//
+// A typical check before trusting an engine change:
+//   ./cosim --engine jit --random 1000 examples/*.tape
+//   ./cosim --engine jit --clock 100000 examples/break_extend.tape
+// The second run takes sequence breaks, whose handler turns extend mode on as it dismisses them.
+//
+// Flags:
+//   -E / --engine <E>: candidate engine, as for the simulator (default "cached")
+//   -c / --every <N>: instructions between state comparisons (default 4096)
+//   -n / --max-instructions <N>: instruction budget per program (default 1000000)
+//   -r / --random <N>: also runs N random programs (default 0)
+//   -S / --seed <S>: seed of the first random program, which program k adds k to (default 1)
+//   -m / --mem <M>: memory size, as for the simulator (default 4K)
+//   -e / --extend: enables Extended Mode
+//   -k / --clock <US>: requests a sequence break every US microseconds of machine time
+//   -F / --no-fast-forward: the candidate steps through idle loops too
+//   -L / --lanes <N>: also runs every program as the N lanes of a batch ensemble, lane k with sense
+//                     switches 011 * k, and each lane on its own PDPProcessor with the candidate engine,
+//                     as batch --lanes N and --lanes 1 would, and checks that their summaries match
+//   -v / --verbose: prints a line for every random program
+//
+// The co-simulator exits with status 1 if any program diverged or any tape could not be loaded.
+//
+
+#include <getopt.h>
+#include <iostream>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "PDPCosim.hpp"
+#include "PDPSettings.hpp"
+#include "TapeReader.hpp"
+
+// default instruction budget per program
+#define COSIM_BUDGET 1000000
+
+void usage() {
+    std::cout << "Usage:\n"
+              << "./cosim [--engine E] [--every N] [--max-instructions N] [--random N] [--seed S] [--mem M] [--extend] [--clock US] [--no-fast-forward] [--lanes N] [--verbose] [TAPE...]\n";
+    exit(1);
+}
+
+/**
+ * Prints the outcome of one program.
+ * @param lanes: the result of compareLanes, if it ran
+ * @return true if it diverged or its lanes differed
+ */
+static bool report(const std::string &name, const PDPCosimResult &result, const std::string &lanes, bool verbose) {
+    if (result.diverged) {
+        std::cout << name << ": DIVERGED " << result.report;
+    } else if (!lanes.empty()) {
+        std::cout << name << ": LANES DIFFER in " << lanes;
+    } else if (verbose) {
+        std::cout << name << ": ok, " << result.instructions << " instructions, " << haltReasonName(result.halt) << "\n";
+    }
+    return result.diverged || !lanes.empty();
+}
+
+int main(int argc, char** argv) {
+    PDPSettings settings;
+    settings.batch = true;
+    settings.maxInstructions = COSIM_BUDGET;
+    uint64_t every = COSIM_EVERY;
+    uint64_t randomCount = 0;
+    uint64_t seed = 1;
+    unsigned int lanes = 0;
+    bool verbose = false;
+
+    option long_options[] = {
+        {"engine", required_argument, nullptr, 'E'},
+        {"every", required_argument, nullptr, 'c'},
+        {"max-instructions", required_argument, nullptr, 'n'},
+        {"random", required_argument, nullptr, 'r'},
+        {"seed", required_argument, nullptr, 'S'},
+        {"mem", required_argument, nullptr, 'm'},
+        {"extend", no_argument, nullptr, 'e'},
+        {"clock", required_argument, nullptr, 'k'},
+        {"no-fast-forward", no_argument, nullptr, 'F'},
+        {"lanes", required_argument, nullptr, 'L'},
+        {"verbose", no_argument, nullptr, 'v'},
+        {nullptr, 0, nullptr, 0}
+    };
+
+    int c;
+    while ((c = getopt_long(argc, argv, "E:c:n:r:S:m:ek:FL:v", long_options, nullptr)) != -1) {
+        switch (c) {
+        case 'E':
+            {
+                std::string arg = optarg;
+                if (arg == "interp") {
+                    settings.engine = PDPEngine::INTERPRETER;
+                }
+                else if (arg == "cached") {
+                    settings.engine = PDPEngine::DECODED;
+                }
+                else if (arg == "jit") {
+                    settings.engine = PDPEngine::JIT;
+                }
+                else {
+                    usage();
+                }
+                break;
+            }
+        case 'c':
+            every = numberOption("every", optarg, 1);
+            break;
+        case 'n':
+            settings.maxInstructions = numberOption("max-instructions", optarg);
+            break;
+        case 'r':
+            randomCount = numberOption("random", optarg);
+            break;
+        case 'S':
+            seed = numberOption("seed", optarg);
+            break;
+        case 'm':
+            {
+                std::optional<unsigned int> size = parseMemorySize(optarg);
+                if (!size) usage();
+                settings.memory_size = size.value();
+                break;
+            }
+        case 'e':
+            settings.extend = true;
+            break;
+        case 'k':
+            settings.clockPeriod = numberOption("clock", optarg, 0, UINT32_MAX);
+            break;
+        case 'F':
+            settings.fastForward = false;
+            break;
+        case 'L':
+            lanes = numberOption("lanes", optarg, 1, UINT16_MAX);
+            break;
+        case 'v':
+            verbose = true;
+            break;
+        default:
+            usage();
+        }
+    }
+    if (optind == argc && randomCount == 0) usage();
+
+    uint64_t programs = 0;
+    uint64_t failures = 0;
+    uint64_t instructions = 0;
+
+    for (int i = optind; i < argc; ++i) {
+        std::string tape = argv[i];
+        ++programs;
+        try {
+            std::vector<WORD> image(settings.memory_size);
+            image.resize(loadTape(tape, image.data(), image.size()));
+            settings.tapeFile = tape;
+            PDPCosimResult result = cosimulate(settings, image, every);
+            instructions += result.instructions;
+            if (report(tape, result, lanes ? compareLanes(settings, image, lanes) : "", true)) ++failures;
+        } catch (const TapeFormatError &e) {
+            std::cout << tape << ": " << e.error << "\n";
+            ++failures;
+        }
+    }
+
+    settings.tapeFile = "random program";
+    for (uint64_t k = 0; k < randomCount; ++k) {
+        std::mt19937_64 rng(seed + k);
+        ++programs;
+        std::vector<WORD> image = randomProgram(rng);
+        PDPCosimResult result = cosimulate(settings, image, every);
+        instructions += result.instructions;
+        if (report("random seed " + std::to_string(seed + k), result, lanes ? compareLanes(settings, image, lanes) : "", verbose)) ++failures;
+    }
+
+    std::cout << programs << " programs, " << instructions << " instructions, " << failures << " failed\n";
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,139 @@
+//
+// PDP-1 Simulator
+// Simulator throughput benchmark
+//
+// Benchmark CLI
+// ./simbench [--instructions N] [--repeat R] [--engine E]... [--print] TAPEFILE
+//
+// Runs TAPEFILE for N instructions on each engine, R times, and prints each engine's best run time and
+// throughput in instructions per second. Every run starts from the same loaded image, headless, with no
+// fast-forwarding, so each engine executes exactly the same instructions; a program that halts sooner
+// is timed up to its halt. examples/bench.pdp1 is a program written for this: it never halts, and mixes
+// memory reference, skip, shift and operate instructions with a subroutine call and indirect operands.
+// "make bench" runs it with the defaults.
+//
+// Flags:
+//   -n / --instructions <N>: instructions per run (default 30000000)
+//   -r / --repeat <R>: runs to time per engine (default 3)
+//   -E / --engine <E>: engine to time, as for the simulator; may be given more than once
+//     (default: interp, cached and jit)
+//   -p / --print: prints the machine state after every step, as the simulator does outside --batch, to
+//     /dev/null, so the time includes formatting the state. Use a smaller N with this.
+//
+
+#include <chrono>
+#include <fstream>
+#include <getopt.h>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "PDPSettings.hpp"
+#include "PDPState.hpp"
+#include "TapeReader.hpp"
+
+// default instructions per run, and runs to time
+#define SIMBENCH_INSTRUCTIONS   30000000
+#define SIMBENCH_REPEAT         3
+
+void usage() {
+    std::cout << "Usage:\n"
+              << "./simbench [--instructions N] [--repeat R] [--engine E]... [--print] TAPEFILE\n";
+    exit(1);
+}
+
+int main(int argc, char** argv) {
+    PDPSettings settings;
+    settings.batch = true;
+    settings.fastForward = false;
+    settings.maxInstructions = SIMBENCH_INSTRUCTIONS;
+    unsigned int repeat = SIMBENCH_REPEAT;
+    bool print = false;
+    std::vector<std::pair<std::string, PDPEngine>> engines;
+
+    option long_options[] = {
+        {"instructions", required_argument, nullptr, 'n'},
+        {"repeat", required_argument, nullptr, 'r'},
+        {"engine", required_argument, nullptr, 'E'},
+        {"print", no_argument, nullptr, 'p'},
+        {nullptr, 0, nullptr, 0}
+    };
+
+    int c;
+    while ((c = getopt_long(argc, argv, "n:r:E:p", long_options, nullptr)) != -1) {
+        switch (c) {
+        case 'n':
+            settings.maxInstructions = numberOption("instructions", optarg, 1);
+            break;
+        case 'r':
+            repeat = numberOption("repeat", optarg, 1, UINT32_MAX);
+            break;
+        case 'E':
+            {
+                std::string arg = optarg;
+                if (arg == "interp") {
+                    engines.emplace_back(arg, PDPEngine::INTERPRETER);
+                }
+                else if (arg == "cached") {
+                    engines.emplace_back(arg, PDPEngine::DECODED);
+                }
+                else if (arg == "jit") {
+                    engines.emplace_back(arg, PDPEngine::JIT);
+                }
+                else {
+                    usage();
+                }
+                break;
+            }
+        case 'p':
+            print = true;
+            break;
+        default:
+            usage();
+        }
+    }
+    if (optind != argc - 1) usage();
+    if (engines.empty()) {
+        engines = {{"interp", PDPEngine::INTERPRETER}, {"cached", PDPEngine::DECODED}, {"jit", PDPEngine::JIT}};
+    }
+
+    settings.tapeFile = argv[optind];
+    std::vector<WORD> image(settings.memory_size);
+    try {
+        image.resize(loadTape(settings.tapeFile, image.data(), image.size()));
+    } catch (const TapeFormatError &e) {
+        std::cerr << e.error << std::endl;
+        return 1;
+    }
+
+    // printState writes to std::cout
+    std::ofstream null("/dev/null");
+    std::streambuf *out = std::cout.rdbuf();
+
+    for (auto &[name, engine] : engines) {
+        settings.engine = engine;
+        double best = 0;
+        uint64_t retired = 0;
+        for (unsigned int r = 0; r < repeat; ++r) {
+            PDPProcessor proc(settings, image);
+            if (print) std::cout.rdbuf(null.rdbuf());
+            auto start = std::chrono::steady_clock::now();
+            if (print) {
+                while (!proc.limitReached(start)) {
+                    proc.printState();
+                    if (!proc.step()) break;
+                }
+            } else {
+                proc.run();
+            }
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            std::cout.rdbuf(out);
+            if (r == 0 || elapsed.count() < best) best = elapsed.count();
+            retired = proc.machineState().retired;
+        }
+
+        std::cout << name << ": " << retired << " instructions, best of " << repeat << " runs " << best * 1e3
+                  << " ms, " << static_cast<uint64_t>(retired / best) << " instructions/s\n";
+    }
+}
@@ -5,8 +5,10 @@
 //
 // Simulator CLI
 // ./simulator [--debug] [FLAGS] TAPEFILE
+// ./simulator [--debug] [FLAGS] --restore SNAPSHOT
 //
-// Reads in punched tape in ASCII art format (as created by the assembler).
+// Reads in punched tape as created by the assembler, either in ASCII art format or as a binary image
+// (assembler --binary). The format is detected automatically.
 //
 // Flags:
 //   -d / --debug: enables Debugging Mode
@@ -18,22 +20,209 @@
 //       "2x" / "8K" / "8192":    8192 words
 //       "4x" / "16K" / "16384":  16384 words
 //       "8x" / "32K" / "32768":  32768 words
+//   -E / --engine <E>: selects the execution engine
+//     Available settings:
+//       "interp": the reference interpreter
+//       "cached": predecoded micro-op cache (default). Each core memory word is decoded once;
+//                 writes to a word drop its decoded entry, so self-modifying code still works.
+//       "jit":    translates straight-line code to x86-64 and chains the translated blocks together,
+//                 interpreting xct, jda/cal, indirect references and other rare instructions. Stores
+//                 into translated code drop the affected blocks. With the JIT, each step runs a whole
+//                 translated block. Falls back to "cached" on hosts without x86-64 support.
+//   -b / --batch: runs headless, printing only the final state
+//   -n / --max-instructions <N>: stops after N instructions (halt reason "budget")
+//   -t / --time-limit <S>: stops after S seconds of wall-clock time (halt reason "timeout")
+//     Both limits apply outside --batch too, where the machine state is printed after every step. There
+//     the JIT steps instruction by instruction near the end of the budget, so the run stops at exactly N.
+//   -s / --summary <FILE>: writes a one-line JSON summary to FILE ("-" for stdout):
+//     {"instructions": N, "halt": "hlt" | "illegal" | "budget" | "timeout" | "indirect", "pc": ..., "ac": ...,
+//      "io": ..., "pf": ..., "overflow": ..., "memory_digest": "<FNV-1a 64 of core memory>"}
+//   -R / --real-time: paces a --batch run so the machine runs no faster than a real PDP-1, taking 5 us per
+//     memory cycle (see PDPTiming.hpp). The simulator sleeps every few thousand cycles rather than after
+//     each instruction, so timing is exact over tens of milliseconds, not per instruction.
+//   -F / --no-fast-forward: in --batch runs the simulator spots idle loops (a jmp to itself, an isp/jmp
+//     loop counting up to zero, a skip/jmp loop polling a condition that cannot change) and skips ahead
+//     to where the loop ends or the run stops, with the same final state as running every instruction.
+//     This flag turns that off.
+//   -I / --max-indirection <N>: stops the machine (halt reason "indirect") on an indirect address chain
+//     longer than N hops, such as a word pointing at itself, instead of following it forever. Chains can
+//     only name 4096 distinct words, so the default of 4096 only ever stops genuine loops. The same
+//     limit applies to an xct of an xct, so an xct executing itself stops the machine too.
+//   -a / --save-at <N>: writes a snapshot of the whole machine once N instructions have been executed,
+//     then keeps running
+//   -f / --snapshot-file <FILE>: where --save-at writes its snapshot (default "pdp1.snap")
+//   -r / --restore <FILE>: starts from a snapshot instead of a tape. The snapshot sets memory size,
+//     extend mode and sense switches (unless sense switches are also given on the command line), and
+//     the instruction count carries on from the snapshot, so --max-instructions and --save-at still
+//     count from the start of the original run.
+//   -p / --profile <FILE>: counts, for every core memory address, the instructions executed there, the
+//     operand reads and writes that land there, the indirect-chain hops and the skips taken by the
+//     instruction there, and writes a hot-spot report to FILE ("-" for stdout) when the run ends, most
+//     executed addresses first, along with the memory cycles spent at each address. Profiling uses the "cached" engine in place of "jit".
+//   -y / --symbols <FILE>: labels the profile's addresses with a symbol map written by assembler --symbols
+//   -T / --trace <FILE>: records every executed instruction (address, instruction word, effective address
+//     of its memory operand, and the AC and IO it left behind) to a compact binary trace file. A background
+//     thread compresses and writes the records while the machine runs. Decode the trace with
+//     ./tracedump FILE. Like --profile, tracing uses "cached" in place of "jit" and steps through idle loops.
+//   -B / --break <SPEC>: sets a breakpoint, as for the break command below (e.g. -B 100 or -B "100 if ac == 7")
+//   -W / --watch <SPEC>: sets a watchpoint, as for the watch command below (e.g. -W "200 w")
+//   -C / --commands <FILE>: starts in command mode before the first instruction, reading commands from FILE
+//     ("-" for stdin) at every stop. Once FILE runs out, stops are reported and the run carries on.
+//   -k / --clock <US>: attaches an interval clock that requests a sequence break every US microseconds of
+//     machine time (on whole multiples of the period, counted from cycle 0)
+//   -i / --reader <FILE>: loads FILE into the paper tape reader, one byte per tape line ("-" for stdin)
+//   -o / --punch <FILE>: punches paper tape into FILE, one byte per line ("-" for stdout)
+//   -Y / --typewriter <FILE>: sends typewriter output to FILE ("-" for stdout)
+//   -K / --keys <FILE>: strikes typewriter keys from FILE ("-" for stdin)
+//   -D / --display <FILE>: attaches a Type 30 display and renders it to FILE: one binary PPM per frame if FILE
+//     holds a frame number as %d or %0Nd, such as "frame%05d.ppm" (%% for a literal %), raw RGB24 frames if it ends in ".rgb", otherwise a stream
+//     of concatenated PPM frames ("-" for stdout; ffmpeg -f image2pipe -i FILE reads it)
+//   -H / --display-rate <FPS>: display frames per second of machine time (default 30)
+//   -Z / --display-size <N>: renders the display at N by N pixels, up to 1024 (default 512)
+//
+// Multiply and Divide:
+//   mul (540000) and div (560000) behave as the Type 10 multiply/divide option, on every engine. mul Y
+//   multiplies AC by C(Y): the 34-bit product's magnitude goes high half to AC and low half to IO bits
+//   17-1, both complemented if the product is negative (a zero product is +0). div Y divides AC:IO, laid
+//   out as mul leaves a product, by C(Y): the quotient goes to IO, the remainder (with the dividend's
+//   sign) to AC, and the next instruction is skipped. If the quotient would not fit in 17 bits, division
+//   by zero included, div leaves AC and IO alone and does not skip. They take 3 and 5 memory cycles.
+//
+// Sequence Breaks:
+//   The single-channel sequence break system is turned on by esm (720055) and off by lsm (720054); cbs
+//   (720056) drops a pending request. When a device requests a break while the system is on and no break
+//   is in progress, the machine stores AC in location 0, the PC (with overflow and extend mode in bits 0
+//   and 1) in location 1 and IO in location 2, and continues at location 3. "jmp i 1" returns from the
+//   break. Devices post their events on a queue ordered by machine cycle (PDPScheduler.hpp), and the
+//   engines compare the cycle count with a single "next event due" value between instructions, so runs
+//   without devices pay nothing for them.
+//
+// In-Out Devices:
+//     rpa (730001): reads one tape line into IO
+//     rpb (730002): reads three binary lines (those punched in the eighth hole) into IO as one word
+//     rrb (720030): loads IO from the reader buffer and clears program flag 2
+//     ppa (730005): punches the low 8 bits of IO as one line
+//     ppb (730006): punches IO as three binary lines, 6 bits each, high bits first
+//     tyo (730003): types the low 7 bits of IO (as ASCII rather than FIO-DEC)
+//     tyi (720004): loads IO with the last key struck and clears program flag 1
+//     dpy (730007): plots a point on the display at X = the top 10 bits of AC, Y = the top 10 bits of IO
+//   The devices run at their real speeds (reader 400 lines/s, punch 63 lines/s, typewriter 10 characters/s).
+//   With the i bit set (730000), as in the mnemonics above, the processor waits for the device; without it
+//   (720001 for rpa, and so on) the program carries on, and when the device is done it raises its program
+//   flag (reader 2 with the data in the reader buffer, punch 3, typewriter 4) and requests a sequence
+//   break. A struck key raises flag 1 and requests a break too; keys from a file arrive one per character
+//   time, while keys from a terminal or pipe arrive whenever the host delivers them, so pair those with
+//   --real-time. The reader reads blank tape past the end of its file. Host files are read and written by
+//   background threads through ring buffers, so the machine only waits on the host when a ring runs
+//   empty (input) or full (output). An IOT for a device that is not attached, or that does not exist,
+//   stops the machine as illegal. Snapshots do not record device state.
+//
+//   The display takes 50 us per point. Points are collected into one batch per frame period, and a
+//   background thread renders each batch: the long-persistence phosphor fades (halving every 50 ms of
+//   machine time), the new points light up at their intensity (bits 6-8 of the dpy, -4 to +3), and the
+//   frame is written out. When the run ends, the frame in progress is rendered too.
+//
+// Command Mode:
+//   With any of --break, --watch or --commands, the simulator runs silently (as with --batch) until a
+//   breakpoint or watchpoint fires, prints why and the machine state, then reads commands, from stdin
+//   unless --commands names a script. Addresses and values are octal.
+//     break ADDR [if ac|io|pf ==|!= VALUE]: stops before executing the instruction at ADDR (when the
+//       condition holds)
+//     watch ADDR [r|w|rw]: stops after an instruction reads / writes / touches ADDR (after indirection)
+//     delete [ADDR]: removes the breakpoints and watchpoints at ADDR, or all of them
+//     info: lists breakpoints and watchpoints
+//     step [N]: executes N instructions (default 1), stopping early at breakpoints, and prints the state
+//     continue: runs until the next stop or the end of the run
+//     print: prints the machine state
+//     x ADDR [N]: prints N words (default 1) from ADDR, disassembled
+//     quit: ends the run where it is
+//   Breakpoints are tracked in a flag table with one byte per address, so while none are set the
+//   simulator runs at full speed, and while some are, checking costs a load per instruction and memory
+//   access. Breakpoints move "jit" runs to "cached" and turn off fast-forwarding.
+//
+// The simulator exits with status 1 if it stopped on an illegal instruction or an indirect chain loop.
 //
 // Debugging Mode:
+//   Prints the tape as it is loaded, then steps through the program on the reference interpreter,
+//   printing each instruction's working (operands read, registers before and after, skips taken)
+//   and the machine state after every instruction. The logging is compiled into the same binary
+//   as an instrumented variant of the interpreter (PDPPolicy.hpp), so runs without --debug pay
+//   nothing for it. ./simulator_debug (make debug) prints the tape and the working on every run.
 //
 
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <optional>
+
 #include "TapeReader.hpp"
+#include "PDPMonitor.hpp"
 #include "PDPSettings.hpp"
 #include "PDPState.hpp"
 
 int main(int argc, char** argv) {
     PDPSettings settings = parseSettings(argc, argv);
 
-    PDPProcessor proc(settings);
-    do {
-        proc.printState();
-    } while (proc.step());
+    std::optional<PDPProcessor> loaded;
+    try {
+        loaded.emplace(settings);
+    } catch (const TapeFormatError &e) {
+        std::cerr << e.error << std::endl;
+        return 1;
+    } catch (const SnapshotError &e) {
+        std::cerr << e.error << std::endl;
+        return 1;
+    } catch (const TraceError &e) {
+        std::cerr << e.error << std::endl;
+        return 1;
+    } catch (const DeviceError &e) {
+        std::cerr << e.error << std::endl;
+        return 1;
+    }
+    PDPProcessor &proc = loaded.value();
+
+    bool monitored = !settings.breakSpecs.empty() || !settings.watchSpecs.empty() || !settings.commandFile.empty();
+
+    try {
+        if (monitored) {
+            PDPMonitor monitor(proc, settings);
+            monitor.run();
+        } else if (settings.batch) {
+            proc.run();
+        } else {
+            auto start = std::chrono::steady_clock::now();
+            while (!proc.limitReached(start)) {
+                proc.printState();
+                if (!proc.step()) break;
+            }
+        }
+    } catch (const SnapshotError &e) {
+        std::cerr << e.error << std::endl;
+        return 1;
+    } catch (const MonitorError &e) {
+        std::cerr << e.error << std::endl;
+        return 1;
+    }
     proc.printState();
-    return 0;
+
+    if (settings.summaryFile == "-") {
+        proc.writeSummary(std::cout);
+    } else if (!settings.summaryFile.empty()) {
+        std::ofstream os(settings.summaryFile);
+        proc.writeSummary(os);
+    }
+
+    if (settings.profileFile == "-") {
+        proc.writeProfile(std::cout);
+    } else if (!settings.profileFile.empty()) {
+        std::ofstream os(settings.profileFile);
+        proc.writeProfile(os);
+    }
+
+    if (proc.haltReason() == PDPHaltReason::INDIRECT) {
+        std::cerr << "stopped on an indirect address chain longer than " << settings.maxIndirection << " hops" << std::endl;
+    }
+
+    return proc.haltReason() == PDPHaltReason::ILLEGAL || proc.haltReason() == PDPHaltReason::INDIRECT ? 1 : 0;
 }
 
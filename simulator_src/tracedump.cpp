@@ -0,0 +1,82 @@
+//
+// PDP-1 Simulator
+// Trace Decoder
+//
+// Trace decoder CLI
+// ./tracedump [FLAGS] TRACEFILE
+//
+// Decodes a trace written by the simulator's --trace flag, printing one line per executed
+// instruction, in order:
+//   ADDR  WORD  DISASSEMBLY  ea EFFECTIVE-ADDRESS  ac AC  io IO
+// All numbers are octal. ADDR is where the instruction was fetched from, WORD the instruction as it
+// was then (self-modified code shows its new words), "ea" is left blank for instructions that do not
+// reference memory, and AC and IO are the registers as the instruction left them.
+//
+// Flags:
+//   -n / --count <N>: stops after the first N instructions
+//   -q / --quiet: prints only the number of instructions in the trace
+//
+
+#include <cstdio>
+#include <getopt.h>
+#include <iostream>
+#include <string>
+
+#include "PDPDisassembler.hpp"
+#include "PDPSettings.hpp"
+#include "PDPTrace.hpp"
+
+void usage() {
+    std::cout << "Usage:\n"
+              << "./tracedump [--count N] [--quiet] TRACEFILE\n";
+    exit(1);
+}
+
+int main(int argc, char** argv) {
+    uint64_t count = UINT64_MAX;
+    bool quiet = false;
+
+    option long_options[] = {
+        {"count", required_argument, nullptr, 'n'},
+        {"quiet", no_argument, nullptr, 'q'},
+        {nullptr, 0, nullptr, 0}
+    };
+
+    int c;
+    while ((c = getopt_long(argc, argv, "n:q", long_options, nullptr)) != -1) {
+        switch (c) {
+        case 'n':
+            count = numberOption("count", optarg);
+            break;
+        case 'q':
+            quiet = true;
+            break;
+        default:
+            usage();
+        }
+    }
+    if (optind != argc - 1) usage();
+
+    uint64_t records = 0;
+    try {
+        PDPTraceReader reader(argv[optind]);
+        PDPTraceRecord r;
+        char line[128];
+        while (records < count && reader.next(r)) {
+            ++records;
+            if (quiet) continue;
+
+            char ea[8] = "";
+            if (r.addr != TRACE_NO_ADDRESS) std::snprintf(ea, sizeof(ea), "%06o", r.addr);
+            std::snprintf(line, sizeof(line), "  %06o  %06o  %-20s ea %-6s  ac %06o  io %06o\n",
+                          r.pc, r.instr, disassemble(r.instr).c_str(), ea, r.ac, r.io);
+            std::cout << line;
+        }
+    } catch (const TraceError &e) {
+        std::cerr << e.error << std::endl;
+        return 1;
+    }
+
+    if (quiet) std::cout << records << " instructions\n";
+    return 0;
+}